@@ -18,7 +18,7 @@
 extern int SIZE_X, SIZE_Y, SIZE_Z;
 /*############################################################################*/
 
-void LBM_initializeGrid( Pochoir_Array_3D(PoCellEntry) & pa, int t ) {
+void LBM_initializeGrid( LBM_Array_3D(PoCellEntry) & pa, int t ) {
 	/*voption indep*/
 #if !defined(SPEC_CPU)
 #ifdef _OPENMP
@@ -55,7 +55,7 @@ void LBM_initializeGrid( Pochoir_Array_3D(PoCellEntry) & pa, int t ) {
 
 /*############################################################################*/
 
-void LBM_loadRandomObstacle( Pochoir_Array_3D(PoCellEntry) & pa, int t ) {
+void LBM_loadRandomObstacle( LBM_Array_3D(PoCellEntry) & pa, int t ) {
 	for( int z = 0 + MARGIN_Z; z < SIZE_Z + MARGIN_Z; ++z ) {
 		for( int y = 0; y < SIZE_Y; ++y ) {
 	for( int x = 0; x < SIZE_X; ++x ) {
@@ -69,7 +69,7 @@ void LBM_loadRandomObstacle( Pochoir_Array_3D(PoCellEntry) & pa, int t ) {
 /*############################################################################*/
 
 
-void LBM_loadObstacleFile( Pochoir_Array_3D(PoCellEntry) & pa, int t, const char* filename ) {
+void LBM_loadObstacleFile( LBM_Array_3D(PoCellEntry) & pa, int t, const char* filename ) {
 	FILE* file = fopen( filename, "rb" );
 
 	for( int z = 0 + MARGIN_Z; z < SIZE_Z + MARGIN_Z; ++z ) {
@@ -88,7 +88,7 @@ void LBM_loadObstacleFile( Pochoir_Array_3D(PoCellEntry) & pa, int t, const char
 
 /*############################################################################*/
 
-void LBM_initializeSpecialCellsForLDC( Pochoir_Array_3D(PoCellEntry) & pa, int t ) {
+void LBM_initializeSpecialCellsForLDC( LBM_Array_3D(PoCellEntry) & pa, int t ) {
 	/*voption indep*/
 #if !defined(SPEC_CPU)
 #ifdef _OPENMP
@@ -116,7 +116,7 @@ void LBM_initializeSpecialCellsForLDC( Pochoir_Array_3D(PoCellEntry) & pa, int t
 
 /*############################################################################*/
 
-void LBM_initializeSpecialCellsForChannel( Pochoir_Array_3D(PoCellEntry) & pa, int t ) {
+void LBM_initializeSpecialCellsForChannel( LBM_Array_3D(PoCellEntry) & pa, int t ) {
 	/*voption indep*/
 #if !defined(SPEC_CPU)
 #ifdef _OPENMP
@@ -146,7 +146,7 @@ void LBM_initializeSpecialCellsForChannel( Pochoir_Array_3D(PoCellEntry) & pa, i
 
 /*############################################################################*/
 
-void LBM_performStreamCollide( Pochoir_Array_3D(PoCellEntry) & pa, int t, int z, int y, int x ) {
+void LBM_performStreamCollide( LBM_Array_3D(PoCellEntry) & pa, int t, int z, int y, int x ) {
 	double ux, uy, uz, u2, rho;
 
 	/*voption indep*/
@@ -244,7 +244,7 @@ void LBM_performStreamCollide( Pochoir_Array_3D(PoCellEntry) & pa, int t, int z,
 
 /*############################################################################*/
 
-void LBM_handleInOutFlow( Pochoir_Array_3D(PoCellEntry) & pa, int t, int z, int y, int x ) {
+void LBM_handleInOutFlow( LBM_Array_3D(PoCellEntry) & pa, int t, int z, int y, int x ) {
 	double ux , uy , uz , rho ,
 	       ux1, uy1, uz1, rho1,
 	       ux2, uy2, uz2, rho2,
@@ -416,7 +416,7 @@ void LBM_handleInOutFlow( Pochoir_Array_3D(PoCellEntry) & pa, int t, int z, int
 
 /*############################################################################*/
 
-void LBM_showGridStatistics( Pochoir_Array_3D(PoCellEntry) & pa, int t ) {
+void LBM_showGridStatistics( LBM_Array_3D(PoCellEntry) & pa, int t ) {
 	int nObstacleCells = 0,
 	    nAccelCells    = 0,
 	    nFluidCells    = 0;
@@ -523,7 +523,7 @@ static void loadValue( FILE* file, OUTPUT_PRECISION* v ) {
 
 /*############################################################################*/
 
-void LBM_storeVelocityField( Pochoir_Array_3D(PoCellEntry) & pa, int t, 
+void LBM_storeVelocityField( LBM_Array_3D(PoCellEntry) & pa, int t, 
                              const char* filename, const int binary ) {
 	OUTPUT_PRECISION rho, ux, uy, uz;
 
@@ -581,7 +581,7 @@ void LBM_storeVelocityField( Pochoir_Array_3D(PoCellEntry) & pa, int t,
 
 /*############################################################################*/
 
-void LBM_compareVelocityField( Pochoir_Array_3D(PoCellEntry) & pa, int t, 
+void LBM_compareVelocityField( LBM_Array_3D(PoCellEntry) & pa, int t, 
                              const char* filename, const int binary ) {
 	double rho, ux, uy, uz;
 	OUTPUT_PRECISION fileUx, fileUy, fileUz,
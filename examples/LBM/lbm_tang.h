@@ -37,6 +37,21 @@ typedef struct
     // double _FLAGS;
 } PoCellEntry;
 
+/* with -DSOA the grid is a Pochoir_SoA_Array : one plane per field */
+#define PoCellEntry_Fields(F) \
+    F(double, _C)  F(double, _N)  F(double, _S)  F(double, _E)  F(double, _W) \
+    F(double, _T)  F(double, _B)  F(double, _NE) F(double, _NW) F(double, _SE) \
+    F(double, _SW) F(double, _NT) F(double, _NB) F(double, _ST) F(double, _SB) \
+    F(double, _ET) F(double, _EB) F(double, _WT) F(double, _WB) \
+    F(unsigned int, _FLAGS)
+
+#ifdef SOA
+Pochoir_SoA_Type(PoCellEntry, PoCellEntry_Fields)
+#define LBM_Array_3D(type) Pochoir_SoA_Array_3D(type)
+#else
+#define LBM_Array_3D(type) Pochoir_Array_3D(type)
+#endif
+
 /*############################################################################*/
 
 #define DFL1 (1.0/ 3.0)
@@ -63,17 +78,17 @@ typedef enum {OBSTACLE    = 1 << 0,
 
 /*############################################################################*/
 
-void LBM_initializeGrid( Pochoir_Array_3D(PoCellEntry) & pa, int t );
-void LBM_initializeSpecialCellsForLDC( Pochoir_Array_3D(PoCellEntry) & pa, int t );
-void LBM_initializeSpecialCellsForChannel( Pochoir_Array_3D(PoCellEntry) & pa, int t );
-void LBM_loadRandomObstacle( Pochoir_Array_3D(PoCellEntry) & pa, int t );
-void LBM_loadObstacleFile( Pochoir_Array_3D(PoCellEntry) & pa, int t, const char* filename );
-void LBM_showGridStatistics( Pochoir_Array_3D(PoCellEntry) & pa, int t );
-void LBM_handleInOutFlow( Pochoir_Array_3D(PoCellEntry) & pa, int t, int z, int y, int x );
-void LBM_performStreamCollide( Pochoir_Array_3D(PoCellEntry) & pa, int t, int z, int y, int x );
-void LBM_storeVelocityField( Pochoir_Array_3D(PoCellEntry) & pa, int t,
+void LBM_initializeGrid( LBM_Array_3D(PoCellEntry) & pa, int t );
+void LBM_initializeSpecialCellsForLDC( LBM_Array_3D(PoCellEntry) & pa, int t );
+void LBM_initializeSpecialCellsForChannel( LBM_Array_3D(PoCellEntry) & pa, int t );
+void LBM_loadRandomObstacle( LBM_Array_3D(PoCellEntry) & pa, int t );
+void LBM_loadObstacleFile( LBM_Array_3D(PoCellEntry) & pa, int t, const char* filename );
+void LBM_showGridStatistics( LBM_Array_3D(PoCellEntry) & pa, int t );
+void LBM_handleInOutFlow( LBM_Array_3D(PoCellEntry) & pa, int t, int z, int y, int x );
+void LBM_performStreamCollide( LBM_Array_3D(PoCellEntry) & pa, int t, int z, int y, int x );
+void LBM_storeVelocityField( LBM_Array_3D(PoCellEntry) & pa, int t,
                              const char* filename, const BOOL binary );
-void LBM_compareVelocityField( Pochoir_Array_3D(PoCellEntry) & pa, int t,
+void LBM_compareVelocityField( LBM_Array_3D(PoCellEntry) & pa, int t,
                                const char* filename, const BOOL binary );
 
 /*############################################################################*/
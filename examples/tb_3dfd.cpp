@@ -326,7 +326,7 @@ void init_variables()
 	aref(1, x, y, z) = r;
 	vsqref(x, y, z) = 0.001f;
       }
-    N_CORES = max(2, __cilkrts_get_nworkers());
+    N_CORES = max(2, pochoir_get_nworkers());
     printf("N_CORES = %d\n", N_CORES);
 }
 
@@ -0,0 +1,134 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D heat equation, Periodic version, distributed over
+ * ranks forked on this host and connected by sockets
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir_dist.hpp>
+
+using namespace std;
+#define N_RANK 2
+#define TOLERANCE (1e-6)
+
+Pochoir_Boundary_2D(periodic_2D, arr, t, i, j)
+    const int arr_size_1 = arr.size(1);
+    const int arr_size_0 = arr.size(0);
+
+    int new_i = (i >= arr_size_1) ? (i - arr_size_1) : (i < 0 ? i + arr_size_1 : i);
+    int new_j = (j >= arr_size_0) ? (j - arr_size_0) : (j < 0 ? j + arr_size_0 : j);
+
+    return arr.get(t, new_i, new_j);
+Pochoir_Boundary_End
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	struct timeval start, end;
+    int N_SIZE = 0, T_SIZE = 0, N_RANKS = 4;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    if (argc > 3)
+        N_RANKS = StrToInt(argv[3]);
+    if (N_RANKS < 1 || N_RANKS > N_SIZE) {
+        printf("N_RANKS = %d out of [1, N_SIZE], quit! \n", N_RANKS);
+        exit(1);
+    }
+
+    /* fork the ranks before anything has started the workers, from here
+     * on the program runs once per rank
+     */
+    Pochoir_Socket_Transport comm(N_RANKS);
+    if (comm.rank() == 0)
+        printf("N_SIZE = %d, T_SIZE = %d, N_RANKS = %d\n", N_SIZE, T_SIZE, N_RANKS);
+
+    Pochoir_Shape_2D heat_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+    Pochoir_Dist_2D dist(comm, heat_shape_2D, N_SIZE, true);
+    Pochoir<N_RANK> heat_2D(heat_shape_2D), heat_2D_serial(heat_shape_2D);
+    /* a : the rows of this rank and its halos, b : the whole grid */
+	Pochoir_Array<double, N_RANK> a(dist.Local_Size(), N_SIZE), b(N_SIZE, N_SIZE);
+    a.Register_Boundary(periodic_2D);
+    heat_2D.Register_Array(a);
+    dist.Register_Array(a);
+    b.Register_Boundary(periodic_2D);
+    heat_2D_serial.Register_Array(b);
+
+    /* every rank draws the whole grid, to start from the same one */
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        b(0, i, j) = 1.0 * (rand() % BASE);
+        b(1, i, j) = 0;
+	} }
+    const int l_own = dist.Own_Begin() - dist.Global_Begin();
+	for (int i = dist.Own_Begin(); i < dist.Own_End(); ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        a(0, i, j) = b(0, i - l_own, j);
+        a(1, i, j) = 0;
+	} }
+
+    Pochoir_Kernel_2D(heat_2D_fn, t, i, j)
+	    a(t, i, j) = 0.125 * (a(t-1, i+1, j) - 2.0 * a(t-1, i, j) + a(t-1, i-1, j)) + 0.125 * (a(t-1, i, j+1) - 2.0 * a(t-1, i, j) + a(t-1, i, j-1)) + a(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(heat_2D_serial_fn, t, i, j)
+	    b(t, i, j) = 0.125 * (b(t-1, i+1, j) - 2.0 * b(t-1, i, j) + b(t-1, i-1, j)) + 0.125 * (b(t-1, i, j+1) - 2.0 * b(t-1, i, j) + b(t-1, i, j-1)) + b(t-1, i, j);
+    Pochoir_Kernel_End
+
+	gettimeofday(&start, 0);
+    dist.Run(heat_2D, T_SIZE, heat_2D_fn, heat_2D_fn);
+	gettimeofday(&end, 0);
+    if (comm.rank() == 0)
+	    std::cout << "Pochoir Dist ET: consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+    heat_2D_serial.Run(T_SIZE, heat_2D_serial_fn);
+	gettimeofday(&end, 0);
+    if (comm.rank() == 0)
+	    std::cout << "Pochoir ET: consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+    /* each rank checks its own rows against the run over the whole grid */
+    int l_fails = 0;
+	for (int i = dist.Own_Begin(); i < dist.Own_End(); ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        double const l_a = a.interior(T_SIZE, i, j), l_b = b.interior(T_SIZE, i - l_own, j);
+		if (fabs(l_a - l_b) >= TOLERANCE) {
+            if (l_fails++ < 10)
+		        printf("rank %d : a(%d, %d, %d) = %f, b(%d, %d, %d) = %f : FAILED!\n", comm.rank(), T_SIZE, i - l_own, j, l_a, T_SIZE, i - l_own, j, l_b);
+        }
+	} }
+    printf("rank %d : rows [%d, %d) %s\n", comm.rank(), dist.Global_Begin(), dist.Global_Begin() + dist.Own_End() - dist.Own_Begin(), (l_fails == 0) ? "passed" : "FAILED");
+
+	return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D heat equation over arrays mapped from scratch files 
+ * and swept out of core (Out_Of_Core), Periodic and Non-periodic versions,
+ * against the naive loop
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define N_RANK 2
+#define TOLERANCE (1e-6)
+
+int check_result(int t, int j, int i, double a, double b)
+{
+	if (abs(a - b) < TOLERANCE) {
+        return 0;
+	} else {
+		printf("a(%d, %d, %d) = %f, b(%d, %d, %d) = %f : FAILED!\n", t, j, i, a, t, j, i, b);
+        return 1;
+	}
+}
+
+Pochoir_Boundary_2D(aperiodic_2D, arr, t, i, j)
+    return 0;
+Pochoir_Boundary_End
+
+Pochoir_Boundary_2D(periodic_2D, arr, t, i, j)
+    const int arr_size_1 = arr.size(1);
+    const int arr_size_0 = arr.size(0);
+
+    int new_i = (i >= arr_size_1) ? (i - arr_size_1) : (i < 0 ? i + arr_size_1 : i);
+    int new_j = (j >= arr_size_0) ? (j - arr_size_0) : (j < 0 ? j + arr_size_0 : j);
+
+    return arr.get(t, new_i, new_j);
+Pochoir_Boundary_End
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	struct timeval start, end;
+    int N_SIZE = 0, T_SIZE = 0, BUDGET = 64;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    /* the memory budget in KB of the strips, kept small so that the
+     * grid is swept in several strips
+     */
+    if (argc > 3)
+        BUDGET = StrToInt(argv[3]);
+    printf("N_SIZE = %d, T_SIZE = %d, BUDGET = %d KB\n", N_SIZE, T_SIZE, BUDGET);
+    Pochoir_Shape_2D heat_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+    Pochoir<N_RANK> heat_2D_P(heat_shape_2D), heat_2D_NP(heat_shape_2D);
+    /* a, c : out of core, b, d : the references in memory */
+	Pochoir_Array<double, N_RANK> a(N_SIZE, N_SIZE), b(N_SIZE, N_SIZE);
+	Pochoir_Array<double, N_RANK> c(N_SIZE, N_SIZE), d(N_SIZE, N_SIZE);
+    a.Register_Alloc(Pochoir_Alloc_File);
+    a.Register_Boundary(periodic_2D);
+    heat_2D_P.Register_Array(a);
+    heat_2D_P.Out_Of_Core((size_t)BUDGET * 1024);
+    c.Register_Alloc(Pochoir_Alloc_File);
+    c.Register_Boundary(aperiodic_2D);
+    heat_2D_NP.Register_Array(c);
+    heat_2D_NP.Out_Of_Core((size_t)BUDGET * 1024);
+
+    b.Register_Shape(heat_shape_2D);
+    b.Register_Boundary(periodic_2D);
+    d.Register_Shape(heat_shape_2D);
+    d.Register_Boundary(aperiodic_2D);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        a(0, i, j) = 1.0 * (rand() % BASE); 
+        a(1, i, j) = 0; 
+        b(0, i, j) = c(0, i, j) = d(0, i, j) = a(0, i, j);
+        b(1, i, j) = c(1, i, j) = d(1, i, j) = 0;
+	} }
+
+    Pochoir_Kernel_2D(heat_2D_P_fn, t, i, j)
+	    a(t, i, j) = 0.125 * (a(t-1, i+1, j) - 2.0 * a(t-1, i, j) + a(t-1, i-1, j)) + 0.125 * (a(t-1, i, j+1) - 2.0 * a(t-1, i, j) + a(t-1, i, j-1)) + a(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(heat_2D_NP_fn, t, i, j)
+	    c(t, i, j) = 0.125 * (c(t-1, i+1, j) - 2.0 * c(t-1, i, j) + c(t-1, i-1, j)) + 0.125 * (c(t-1, i, j+1) - 2.0 * c(t-1, i, j) + c(t-1, i, j-1)) + c(t-1, i, j);
+    Pochoir_Kernel_End
+
+	gettimeofday(&start, 0);
+    heat_2D_P.Run(T_SIZE, heat_2D_P_fn);
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir ET (out of core, periodic): consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+    heat_2D_NP.Run(T_SIZE, heat_2D_NP_fn);
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir ET (out of core, non-periodic): consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+	for (int t = 0; t < T_SIZE; ++t) {
+    cilk_for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        b(t+1, i, j) = 0.125 * (b(t, i+1, j) - 2.0 * b(t, i, j) + b(t, i-1, j)) + 0.125 * (b(t, i, j+1) - 2.0 * b(t, i, j) + b(t, i, j-1)) + b(t, i, j); 
+        d(t+1, i, j) = 0.125 * (d(t, i+1, j) - 2.0 * d(t, i, j) + d(t, i-1, j)) + 0.125 * (d(t, i, j+1) - 2.0 * d(t, i, j) + d(t, i, j-1)) + d(t, i, j); } } }
+	gettimeofday(&end, 0);
+	std::cout << "Naive Loop: consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+    int l_fails = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+		l_fails += check_result(T_SIZE, i, j, a.interior(T_SIZE, i, j), b.interior(T_SIZE, i, j));
+		l_fails += check_result(T_SIZE, i, j, c.interior(T_SIZE, i, j), d.interior(T_SIZE, i, j));
+	} } 
+    printf("%s\n", (l_fails == 0) ? "passed" : "FAILED");
+
+	return 0;
+}
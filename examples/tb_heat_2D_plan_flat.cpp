@@ -0,0 +1,177 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D heat equation, Periodic version, run with a flattened 
+ * Pochoir_Plan, and with the same plan saved and loaded back, against 
+ * the same runs without a plan. A plan saved for this grid must be 
+ * refused by a grid of another size.
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define N_RANK 2
+#define N_RUNS 2
+#define TOLERANCE (1e-6)
+
+int check_result(int t, int j, int i, double a, double b)
+{
+	if (abs(a - b) < TOLERANCE) {
+        return 0;
+	} else {
+		printf("a(%d, %d, %d) = %f, b(%d, %d, %d) = %f : FAILED!\n", t, j, i, a, t, j, i, b);
+        return 1;
+	}
+}
+
+Pochoir_Boundary_2D(periodic_2D, arr, t, i, j)
+    const int arr_size_1 = arr.size(1);
+    const int arr_size_0 = arr.size(0);
+
+    int new_i = (i >= arr_size_1) ? (i - arr_size_1) : (i < 0 ? i + arr_size_1 : i);
+    int new_j = (j >= arr_size_0) ? (j - arr_size_0) : (j < 0 ? j + arr_size_0 : j);
+
+    return arr.get(t, new_i, new_j);
+Pochoir_Boundary_End
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	struct timeval start, end;
+    int N_SIZE = 0, T_SIZE = 0;
+    char const * plan_file = "heat_2D_plan_flat.plan";
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    Pochoir_Shape_2D heat_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+
+    if (argc > 3) {
+        /* ./heat_2D_plan_flat N T plan_file : load a plan saved for 
+         * another grid, the run must quit with status 1 
+         */
+        Pochoir<N_RANK> heat_2D_other(heat_shape_2D);
+        Pochoir_Array<double, N_RANK> e(N_SIZE, N_SIZE);
+        Pochoir_Plan<N_RANK> other_plan(T_SIZE);
+        e.Register_Boundary(periodic_2D);
+        heat_2D_other.Register_Array(e);
+
+        Pochoir_Kernel_2D(heat_2D_other_fn, t, i, j)
+	        e(t, i, j) = 0.125 * (e(t-1, i+1, j) - 2.0 * e(t-1, i, j) + e(t-1, i-1, j)) + 0.125 * (e(t-1, i, j+1) - 2.0 * e(t-1, i, j) + e(t-1, i, j-1)) + e(t-1, i, j);
+        Pochoir_Kernel_End
+
+        other_plan.Load(argv[3]);
+        heat_2D_other.Run(other_plan, heat_2D_other_fn, heat_2D_other_fn);
+        return 0;
+    }
+
+    printf("N_SIZE = %d, T_SIZE = %d\n", N_SIZE, T_SIZE);
+    /* heat_2D : flattened plan, heat_2D_load : the plan loaded back, 
+     * heat_2D_ref : no plan 
+     */
+    Pochoir<N_RANK> heat_2D(heat_shape_2D), heat_2D_load(heat_shape_2D), heat_2D_ref(heat_shape_2D);
+	Pochoir_Array<double, N_RANK> a(N_SIZE, N_SIZE), c(N_SIZE, N_SIZE), b(N_SIZE, N_SIZE);
+    Pochoir_Plan<N_RANK> plan(T_SIZE), load_plan(T_SIZE);
+    a.Register_Boundary(periodic_2D);
+    c.Register_Boundary(periodic_2D);
+    b.Register_Boundary(periodic_2D);
+    heat_2D.Register_Array(a);
+    heat_2D_load.Register_Array(c);
+    heat_2D_ref.Register_Array(b);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        a(0, i, j) = 1.0 * (rand() % BASE); 
+        a(1, i, j) = 0; 
+        c(0, i, j) = b(0, i, j) = a(0, i, j);
+        c(1, i, j) = b(1, i, j) = 0;
+	} }
+
+    Pochoir_Kernel_2D(heat_2D_fn, t, i, j)
+	    a(t, i, j) = 0.125 * (a(t-1, i+1, j) - 2.0 * a(t-1, i, j) + a(t-1, i-1, j)) + 0.125 * (a(t-1, i, j+1) - 2.0 * a(t-1, i, j) + a(t-1, i, j-1)) + a(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(heat_2D_load_fn, t, i, j)
+	    c(t, i, j) = 0.125 * (c(t-1, i+1, j) - 2.0 * c(t-1, i, j) + c(t-1, i-1, j)) + 0.125 * (c(t-1, i, j+1) - 2.0 * c(t-1, i, j) + c(t-1, i, j-1)) + c(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(heat_2D_ref_fn, t, i, j)
+	    b(t, i, j) = 0.125 * (b(t-1, i+1, j) - 2.0 * b(t-1, i, j) + b(t-1, i-1, j)) + 0.125 * (b(t-1, i, j+1) - 2.0 * b(t-1, i, j) + b(t-1, i, j-1)) + b(t-1, i, j);
+    Pochoir_Kernel_End
+
+    /* each run starts over from time step 0 of the toggled planes */
+    plan.Flatten();
+    for (int r = 0; r < N_RUNS; ++r) {
+	    gettimeofday(&start, 0);
+        heat_2D.Run(plan, heat_2D_fn, heat_2D_fn);
+	    gettimeofday(&end, 0);
+	    std::cout << "Pochoir ET (" << (r == 0 ? "flat plan" : "flat replay") << "): consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+    }
+    plan.Save(plan_file);
+
+    load_plan.Load(plan_file);
+    for (int r = 0; r < N_RUNS; ++r) {
+	    gettimeofday(&start, 0);
+        heat_2D_load.Run(load_plan, heat_2D_load_fn, heat_2D_load_fn);
+	    gettimeofday(&end, 0);
+	    std::cout << "Pochoir ET (" << (r == 0 ? "loaded plan" : "loaded replay") << "): consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+    }
+
+    for (int r = 0; r < N_RUNS; ++r) {
+	    gettimeofday(&start, 0);
+        heat_2D_ref.Run(T_SIZE, heat_2D_ref_fn);
+	    gettimeofday(&end, 0);
+	    std::cout << "Pochoir ET (no plan): consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+    }
+
+    int l_fails = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+		l_fails += check_result(T_SIZE, i, j, a.interior(T_SIZE, i, j), b.interior(T_SIZE, i, j));
+		l_fails += check_result(T_SIZE, i, j, c.interior(T_SIZE, i, j), b.interior(T_SIZE, i, j));
+	} } 
+
+    /* a fresh process, the refusal quits it */
+    char l_cmd[1024];
+    snprintf(l_cmd, sizeof(l_cmd), "%s %d %d %s > /dev/null", argv[0], N_SIZE + 1, T_SIZE, plan_file);
+    int const l_status = system(l_cmd);
+    if (!WIFEXITED(l_status) || WEXITSTATUS(l_status) != 1) {
+        printf("the plan of a %d x %d grid is not refused by a %d x %d grid : FAILED!\n", N_SIZE, N_SIZE, N_SIZE + 1, N_SIZE + 1);
+        ++l_fails;
+    }
+    remove(plan_file);
+    printf("%s\n", (l_fails == 0) ? "passed" : "FAILED");
+
+	return 0;
+}
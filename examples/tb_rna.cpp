@@ -78,6 +78,13 @@ enum err_msgs{ SEQUENCE_READ, LENGTH_READ, NO_SEQUENCE, SEQUENCE_TOO_LONG, INVAL
                                                 { 1, 0, 0 }, { 1, 0, -1 }, { 1, -1, 0 },
                                                 { 0, -1, 0 }, { 0, 0, -1 } };    
 
+    /* SL, SR and SM are read only at t + 1, so they keep 2 time planes 
+     * instead of the 3 of pRNA_shape 
+     */
+    Pochoir_Shape< N_RANK > pRNA_SL_shape[ ] = { { 2, 0, 0 }, { 1, -1, 0 } };
+    Pochoir_Shape< N_RANK > pRNA_SR_shape[ ] = { { 2, 0, 0 }, { 1, 0, -1 } };
+    Pochoir_Shape< N_RANK > pRNA_SM_shape[ ] = { { 2, 0, 0 }, { 1, 0, -1 }, { 1, -1, 0 } };
+
 double pochoirTime = 0, iterTime = 0;
 struct timeval start, end;
 
@@ -304,9 +311,9 @@ void stencilRNAi0( int nX, char *X, int i_0,
 {
     Pochoir< N_RANK > pRNA(pRNA_shape); 
     Pochoir_Domain I( 0, nX + 1 ), K( 0, nX + 1 );
-    pRNA.Register_Array( SL );
-    pRNA.Register_Array( SR );
-    pRNA.Register_Array( SM );
+    pRNA.Register_Array( SL, pRNA_SL_shape );
+    pRNA.Register_Array( SR, pRNA_SR_shape );
+    pRNA.Register_Array( SM, pRNA_SM_shape );
     pRNA.Register_Array( SMAX );
     pRNA.Register_Array( SP );
     pRNA.Register_Domain( I, K );    
@@ -523,6 +530,9 @@ int stencilRNA( int nX, char *X, bool recursive )
     P_ARRAY_R2_T3 SL( nX + 1, nX + 1 ), SR( nX + 1, nX + 1 ), SM( nX + 1, nX + 1 ), SMAX( nX + 1, nX + 1 );
     P_ARRAY_R2_T3 SP( nX + 1, nX + 1 ), S( nX + 2, nX + 2 );
 
+    SL.Register_Liveness(pRNA_SL_shape, 2);
+    SR.Register_Liveness(pRNA_SR_shape, 2);
+    SM.Register_Liveness(pRNA_SM_shape, 2);
     SL.Register_Shape(pRNA_shape);
     SR.Register_Shape(pRNA_shape);
     SM.Register_Shape(pRNA_shape);
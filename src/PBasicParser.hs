@@ -52,7 +52,7 @@ lexer = Token.makeTokenParser (javaStyle
                                   "<", "<=", "==", "!=", "+=", "-=", "*=", "&=", "|=", 
                                   "<<=", ">>=", "^=", "++", "--", "?", ":", "&", "|", "~",
                                   ">>", "<<", "%", "^"],
-               reservedNames = ["Pochoir_Array", "Pochoir", "Pochoir_Domain", 
+               reservedNames = ["Pochoir_Array", "Pochoir_SoA_Array", "Pochoir", "Pochoir_Domain", 
                                 "Pochoir", 
                                 "Pochoir_kernel_1D", "Pochoir_kernel_2D", 
                                 "Pochoir_kernel_3D", "Pochoir_kernel_end",
@@ -113,7 +113,11 @@ pMember l_memFunc =
 ppArray :: String -> ParserState -> GenParser Char ParserState String
 ppArray l_id l_state =
         do try $ pMember "Register_Boundary"
-           l_boundaryFn <- parens pIdentifier
+           -- a boundary function, or a built-in Pochoir_Bdry_* kind
+           -- followed by an optional constant value
+           l_boundaryFn <- parens $ do l_kind <- pIdentifier
+                                       l_value <- many $ noneOf ")"
+                                       return (l_kind ++ l_value)
            semi
            case Map.lookup l_id $ pArray l_state of
                Nothing -> return (l_id ++ ".Register_Boundary(" ++ l_boundaryFn ++ "); /* UNKNOWN Register_Boundary with " ++ l_id ++ "*/" ++ breakline)
@@ -133,14 +137,16 @@ ppArray l_id l_state =
 ppStencil :: String -> ParserState -> GenParser Char ParserState String
 ppStencil l_id l_state = 
         do try $ pMember "Register_Array"
-           l_array <- parens identifier
+           -- an optional second parameter is the shape reading the array
+           l_params <- parens $ commaSep1 identifier
            semi
+           let l_array = head l_params
            case Map.lookup l_id $ pStencil l_state of 
-               Nothing -> return (l_id ++ ".Register_Array(" ++ l_array ++ "); /* UNKNOWN Register_Array with" ++ l_id ++ "*/" ++ breakline)
+               Nothing -> return (l_id ++ ".Register_Array(" ++ intercalate ", " l_params ++ "); /* UNKNOWN Register_Array with" ++ l_id ++ "*/" ++ breakline)
                Just l_stencil -> 
                    case Map.lookup l_array $ pArray l_state of
-                       Nothing -> registerUndefinedArray l_id l_array l_stencil 
-                       Just l_pArray -> registerArray l_id l_array l_pArray l_stencil
+                       Nothing -> registerUndefinedArray l_id l_params l_stencil 
+                       Just l_pArray -> registerArray l_id l_params l_pArray l_stencil
     <|> do try $ pMember "Register_Boundary"
            l_boundaryParams <- parens $ commaSep1 identifier
            semi
@@ -198,6 +204,21 @@ ppStencil l_id l_state =
                                           ("C_Pointer_", l_id, l_tstep, l_revKernel, 
                                             l_newStencil) 
                                           pShowCPointerKernel
+                                    PSimd -> 
+                                         pSplitObase 
+                                          ("Simd_", l_id, l_tstep, l_revKernel, 
+                                            l_newStencil) 
+                                          pShowSimdKernel
+                                    PUnroll l_dim l_factor -> 
+                                         pSplitObase 
+                                          ("Unroll_", l_id, l_tstep, l_revKernel, 
+                                            l_newStencil) 
+                                          (pShowUnrollKernel l_dim l_factor)
+                                    PRotate -> 
+                                         pSplitObase 
+                                          ("Rotate_", l_id, l_tstep, l_revKernel, 
+                                            l_newStencil) 
+                                          pShowRotateKernel
     <|> do return (l_id)
 
 -- get all iterators from Kernel
@@ -210,23 +231,32 @@ transKernel l_kernel l_stencil l_mode =
                        PMacroShadow -> getFromStmts getIter 
                                     (transArrayMap $ sArrayInUse l_stencil) 
                                     l_exprStmts
-                       PCPointer -> getFromStmts getIter 
+                       PCPointer -> dropSoAIter $ getFromStmts getIter 
                                     (transArrayMap $ sArrayInUse l_stencil) 
                                     l_exprStmts
                        PPointer -> getFromStmts (getPointer $ l_kernelParams) 
                                     (transArrayMap $ sArrayInUse l_stencil) 
                                     l_exprStmts
-                       POptPointer -> getFromStmts getIter 
+                       PSimd -> getFromStmts (getPointer $ l_kernelParams) 
+                                    (transArrayMap $ sArrayInUse l_stencil) 
+                                    l_exprStmts
+                       PUnroll _ _ -> getFromStmts (getPointer $ l_kernelParams) 
+                                    (transArrayMap $ sArrayInUse l_stencil) 
+                                    l_exprStmts
+                       PRotate -> getFromStmts (getPointer $ l_kernelParams) 
+                                    (transArrayMap $ sArrayInUse l_stencil) 
+                                    l_exprStmts
+                       POptPointer -> dropSoAIter $ getFromStmts getIter 
                                     (transArrayMap $ sArrayInUse l_stencil) 
                                     l_exprStmts 
-                       PDefault -> let l_get = 
-                                            if sRank l_stencil < 3 
-                                                then getIter
-                                                else (getPointer $ l_kernelParams)
-                                   in  getFromStmts 
-                                         l_get
-                                         (transArrayMap $ sArrayInUse l_stencil) 
-                                         l_exprStmts 
+                       PDefault -> if sRank l_stencil < 3 
+                                      then dropSoAIter $ getFromStmts getIter
+                                             (transArrayMap $ sArrayInUse l_stencil) 
+                                             l_exprStmts 
+                                      else getFromStmts 
+                                             (getPointer $ l_kernelParams)
+                                             (transArrayMap $ sArrayInUse l_stencil) 
+                                             l_exprStmts 
            l_revIters = transIterN 0 l_iters
        in  l_kernel { kIter = l_revIters }
  
@@ -235,8 +265,8 @@ pSplitScope (l_tag, l_id, l_tstep, l_kernel, l_stencil) l_showKernel =
     let oldKernelName = kName l_kernel
         bdryKernelName = "bdry_" ++ oldKernelName
         obaseKernelName = l_tag ++ oldKernelName
-        bdryKernel = pShowMacroKernel ".boundary" (sArrayInUse l_stencil) 
-                                                  bdryKernelName l_kernel
+        bdryKernel = pShowFaceKernel (sArrayInUse l_stencil) 
+                                     bdryKernelName l_kernel
         obaseKernel = l_showKernel obaseKernelName l_kernel
         runKernel = obaseKernelName ++ ", " ++ bdryKernelName
     in  return ("{" ++ breakline ++ bdryKernel ++ breakline ++ obaseKernel ++ breakline ++ 
@@ -249,8 +279,8 @@ pSplitObase (l_tag, l_id, l_tstep, l_kernel, l_stencil) l_showKernel =
         bdryKernelName = "bdry_" ++ oldKernelName
         obaseKernelName = l_tag ++ oldKernelName 
         regBound = sRegBound l_stencil
-        bdryKernel = pShowMacroKernel ".boundary" (sArrayInUse l_stencil) 
-                                                  bdryKernelName l_kernel
+        bdryKernel = pShowFaceKernel (sArrayInUse l_stencil) 
+                                     bdryKernelName l_kernel
         obaseKernel = l_showKernel obaseKernelName l_kernel 
         runKernel = 
             if regBound then obaseKernelName ++ ", " ++ bdryKernelName
@@ -290,7 +320,8 @@ registerUndefinedBoundaryFn l_id l_boundaryParams l_stencil =
                            aDims = [],
                            aMaxShift = 0,
                            aToggle = 0,
-                           aRegBound = True}
+                           aRegBound = True,
+                           aSoA = False}
     in do -- updateState $ updatePArray [(l_arrayName, l_pArray)]
           -- updateState $ updateStencilArray l_id l_pArray
           -- updateState $ updateStencilBoundary l_id True
@@ -304,27 +335,43 @@ registerBoundaryFn l_id l_boundaryParams l_pArray =
        return (l_id ++ ".Register_Boundary(" ++ (intercalate ", " l_boundaryParams) ++ 
                "); /* register Boundary Fn */" ++ breakline)
 
-registerUndefinedArray :: String -> String -> PStencil -> GenParser Char ParserState String
-registerUndefinedArray l_id l_arrayName l_stencil =
-    let l_pArray = PArray {aName = l_arrayName,
+registerUndefinedArray :: String -> [String] -> PStencil -> GenParser Char ParserState String
+registerUndefinedArray l_id l_params l_stencil =
+    let l_arrayName = head l_params
+        l_pArray = PArray {aName = l_arrayName,
                            aType = PType { basicType = PUserType, typeName = "UnknownType" },
                            aRank = sRank l_stencil,
                            aDims = [],
                            aMaxShift = 0,
                            aToggle = 0,
-                           aRegBound = False}
+                           aRegBound = False,
+                           aSoA = False}
     in  do -- updateState $ updatePArray [(l_arrayName, l_pArray)]
            -- updateState $ updateStencilArray l_id l_pArray 
-           return (l_id ++ ".Register_Array (" ++ l_arrayName ++ 
+           return (l_id ++ ".Register_Array (" ++ intercalate ", " l_params ++ 
                    "); /* register Undefined Array */" ++ breakline)
     
-registerArray :: String -> String -> PArray -> PStencil -> GenParser Char ParserState String
-registerArray l_id l_arrayName l_pArray l_stencil =
-    -- assume all participating array has the same shape/toggle! Is that true?
-    let l_revArray = l_pArray { aToggle = sToggle l_stencil }
-    in  do updateState $ updateStencilArray l_id l_revArray
-           return (l_id ++ ".Register_Array (" ++ l_arrayName ++ 
-                   "); /* register Array */" ++ breakline)
+registerArray :: String -> [String] -> PArray -> PStencil -> GenParser Char ParserState String
+registerArray l_id l_params l_pArray l_stencil =
+    -- a compile-time toggle of the array wins; otherwise without a shape 
+    -- of its own, the array has the toggle of the stencil; with one, it 
+    -- keeps only the time planes live for that shape, the same as 
+    -- Pochoir_Array::Register_Liveness() does at run-time
+    do l_state <- getState
+       let l_stencilShape = shape $ sShape l_stencil
+       let l_home = maximum $ 0 : map head l_stencilShape
+       let l_toggle = 
+             if aToggle l_pArray > 0 then aToggle l_pArray else
+             case tail l_params of
+                 [l_shapeName] -> 
+                     case Map.lookup l_shapeName $ pShape l_state of
+                         Nothing -> sToggle l_stencil
+                         Just l_pShape -> getLiveToggleFromShape l_home $ shape l_pShape
+                 _ -> sToggle l_stencil
+       let l_revArray = l_pArray { aToggle = l_toggle }
+       updateState $ updateStencilArray l_id l_revArray
+       return (l_id ++ ".Register_Array (" ++ intercalate ", " l_params ++ 
+               "); /* register Array, toggle = " ++ show l_toggle ++ " */" ++ breakline)
 
 -- pDeclStatic <type, rank>
 pDeclStatic :: GenParser Char ParserState (PType, PValue)
@@ -334,6 +381,14 @@ pDeclStatic = do l_type <- pType
                  l_rank <- exprDeclDim
                  return (l_type, l_rank)
 
+-- pDeclStaticBdry <type, rank [, toggle [, boundary functor]]>, toggle 0 
+-- and the functor "" if they're not given
+pDeclStaticBdry :: GenParser Char ParserState (PType, PValue, PValue, PName)
+pDeclStaticBdry = do (l_type, l_rank) <- pDeclStatic
+                     l_toggle <- option 0 (try $ comma >> exprDeclDim)
+                     l_bdry <- option "" (comma >> identifier)
+                     return (l_type, l_rank, l_toggle, l_bdry)
+
 pDeclStaticNum :: GenParser Char ParserState (PValue)
 pDeclStaticNum = do l_rank <- exprDeclDim
                     return (l_rank)
@@ -51,7 +51,11 @@ data PType = PType {
     typeName :: String
 } deriving Eq
 data PState = PochoirBegin | PochoirEnd | PochoirMacro | PochoirDeclArray | PochoirDeclRange | PochoirError | Unrelated deriving (Show, Eq)
-data PMode = PHelp | PDefault | PDebug | PCaching | PCPointer | POptPointer | PPointer | PMacroShadow | PNoPP deriving Eq
+-- PUnroll dim factor : unroll-and-jam the loop over spatial dimension dim
+-- (0 is the unit-stride one) by factor
+-- PRotate : PPointer with the loads along the unit-stride dimension rotated
+-- through registers
+data PMode = PHelp | PDefault | PDebug | PCaching | PCPointer | POptPointer | PPointer | PMacroShadow | PSimd | PUnroll Int Int | PRotate | PNoPP deriving Eq
 data PMacro = PMacro {
     mName :: PName,
     mValue :: PValue
@@ -63,7 +67,9 @@ data PArray = PArray {
     aMaxShift :: Int,
     aToggle :: Int,
     aDims :: [DimExpr],
-    aRegBound :: Bool
+    aRegBound :: Bool,
+    -- declared as Pochoir_SoA_Array : one plane per struct field
+    aSoA :: Bool
 } deriving (Show, Eq)
 data PStencil = PStencil {
     sName :: PName,
@@ -162,6 +168,9 @@ instance Show PMode where
     show POptPointer = " -split-opt-pointer " 
     show PPointer = " -split-pointer " 
     show PMacroShadow = " -split-macro-shadow " 
+    show PSimd = " -split-simd " 
+    show (PUnroll l_dim l_factor) = " -split-unroll=" ++ show l_dim ++ ":" ++ show l_factor ++ " "
+    show PRotate = " -split-rotate " 
     show PNoPP = " -No-Preprocessing "
 
 instance Show PType where
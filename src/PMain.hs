@@ -35,7 +35,7 @@ import qualified Control.Exception as Control
 import Data.List
 import System.Directory 
 import System.Cmd (rawSystem)
-import Data.Char (isSpace)
+import Data.Char (isSpace, isDigit)
 import qualified Data.Map as Map
 import Text.ParserCombinators.Parsec (runParser)
 
@@ -43,21 +43,25 @@ import PData
 import PMainParser
 
 main :: IO ()
-main = do args <- getArgs
-          whilst (null args) $ do
+main = do args' <- getArgs
+          whilst (null args') $ do
              printUsage
              exitFailure
+          (cxx, args) <- pickCompiler args'
           let (inFiles, inDirs, mode, debug, showFile, userArgs) 
                 = parseArgs ([], [], PDefault, False, True, []) args
           whilst (mode == PHelp) $ do
              printOptions
              exitFailure
           whilst (mode /= PNoPP) $ do
-             ppopp (mode, debug, showFile, userArgs) (zip inFiles inDirs)
-          -- pass everything to icc after preprocessing and Pochoir optimization
-          let iccArgs = userArgs ++ ["-wd1292", "-wd780",  "-wd488", "-wd161"]
-          putStrLn (icc ++ " " ++ intercalate " " iccArgs)
-          rawSystem icc iccArgs
+             ppopp cxx (mode, debug, showFile, userArgs) (zip inFiles inDirs)
+          -- pass everything to the backend compiler after preprocessing 
+          -- and Pochoir optimization
+          let (cc, family) = cxx
+          let ccArgs = userArgs ++ cxxWarnFlags family ++
+                       (if mode == PSimd then cxxSimdFlags family else [])
+          putStrLn (cc ++ " " ++ intercalate " " ccArgs)
+          rawSystem cc ccArgs
           whilst (showFile == False) $ do
              let outFiles = map (rename "_pochoir") inFiles 
              removeFile $ intercalate " " outFiles
@@ -66,9 +70,9 @@ whilst :: Bool -> IO () -> IO ()
 whilst True action = action
 whilst False action = return () 
 
-ppopp :: (PMode, Bool, Bool, [String]) -> [(String, String)] -> IO ()
-ppopp (_, _, _, _) [] = return ()
-ppopp (mode, debug, showFile, userArgs) ((inFile, inDir):files) = 
+ppopp :: (String, PCompiler) -> (PMode, Bool, Bool, [String]) -> [(String, String)] -> IO ()
+ppopp _ (_, _, _, _) [] = return ()
+ppopp cxx@(cc, family) (mode, debug, showFile, userArgs) ((inFile, inDir):files) = 
     do putStrLn ("pochoir called with mode =" ++ show mode)
        pochoirLibPath <- Control.catch (getEnv "POCHOIR_LIB_PATH")
                          (\e -> do let err = show (e::Control.IOException)
@@ -86,12 +90,10 @@ ppopp (mode, debug, showFile, userArgs) ((inFile, inDir):files) =
 -}
        let envPath = ["-I" ++ pochoirLibPath]
        let iccPPFile = inDir ++ getPPFile inFile
-       let iccPPArgs = if debug == False
-             then iccPPFlags ++ envPath ++ [inFile]
-             else iccDebugPPFlags ++ envPath ++ [inFile] 
-       -- a pass of icc preprocessing
-       putStrLn (icc ++ " " ++ intercalate " " iccPPArgs)
-       rawSystem icc iccPPArgs
+       let iccPPArgs = cxxPPFlags family debug iccPPFile ++ envPath ++ [inFile]
+       -- a pass of preprocessing by the backend compiler
+       putStrLn (cc ++ " " ++ intercalate " " iccPPArgs)
+       rawSystem cc iccPPArgs
        -- a pass of pochoir compilation
        whilst (mode /= PDebug) $ do
            let outFile = rename "_pochoir" inFile
@@ -106,7 +108,7 @@ ppopp (mode, debug, showFile, userArgs) ((inFile, inDir):files) =
            let outFile = rename "_pochoir" midFile
            putStrLn ("mv " ++ midFile ++ " " ++ outFile)
            renameFile midFile outFile
-       ppopp (mode, debug, showFile, userArgs) files
+       ppopp cxx (mode, debug, showFile, userArgs) files
 
 getMidFile :: String -> String
 getMidFile a  
@@ -129,10 +131,59 @@ getObjFile dir fname = ["-o"] ++ [dir++name]
 
 pInitState = ParserState { pMode = PCaching, pState = Unrelated, pMacro = Map.empty, pArray = Map.empty, pStencil = Map.empty, pShape = Map.empty, pRange = Map.empty, pKernel = Map.empty}
 
+-- the backend C++ compiler : "-compiler=<cxx>" on the command line, 
+-- else $POCHOIR_CXX, else icpc. The flag sets below are picked by the 
+-- family of the compiler, which is guessed from its name
+data PCompiler = PIcc | PGcc | PClang deriving Eq
+
 icc = "icpc"
 
+pickCompiler :: [String] -> IO ((String, PCompiler), [String])
+pickCompiler aL =
+    do let (l_opts, aL') = partition (isPrefixOf "-compiler=") aL
+       l_env <- Control.catch (getEnv "POCHOIR_CXX")
+                (\e -> do let err = show (e::Control.IOException)
+                           return icc)
+       let l_cxx = if null l_opts 
+                      then l_env 
+                      else drop (length "-compiler=") $ last l_opts
+       whilst (null l_cxx) $ do
+          putStrLn ("Pochoir : empty backend compiler in -compiler=")
+          exitFailure
+       return ((l_cxx, compilerFamily l_cxx), aL')
+
+compilerFamily :: String -> PCompiler
+compilerFamily cxx 
+    | isInfixOf "clang" l_name || isPrefixOf "icx" l_name || isPrefixOf "icpx" l_name = PClang
+    | isPrefixOf "icc" l_name || isPrefixOf "icpc" l_name = PIcc
+    | otherwise = PGcc
+    where l_name = takeFileName cxx
+
+-- icc -P writes the preprocessed file.i by itself, while gcc and clang 
+-- preprocess to stdout unless given an output file
+cxxPPFlags :: PCompiler -> Bool -> String -> [String]
+cxxPPFlags PIcc False _ = iccPPFlags
+cxxPPFlags PIcc True _ = iccDebugPPFlags
+cxxPPFlags PGcc False ppFile = gccPPFlags ++ ["-o", ppFile]
+cxxPPFlags PGcc True ppFile = gccDebugPPFlags ++ ["-o", ppFile]
+cxxPPFlags PClang False ppFile = clangPPFlags ++ ["-o", ppFile]
+cxxPPFlags PClang True ppFile = clangDebugPPFlags ++ ["-o", ppFile]
+
+-- silence the warnings the generated code is known to trigger
+cxxWarnFlags :: PCompiler -> [String]
+cxxWarnFlags PIcc = ["-wd1292", "-wd780",  "-wd488", "-wd161"]
+cxxWarnFlags PGcc = ["-Wno-attributes", "-Wno-unknown-pragmas"]
+cxxWarnFlags PClang = ["-Wno-unknown-attributes", "-Wno-ignored-attributes", "-Wno-unknown-pragmas"]
+
+cxxSimdFlags :: PCompiler -> [String]
+cxxSimdFlags PIcc = iccSimdFlags
+cxxSimdFlags _ = ["-fopenmp-simd"]
+
 iccFlags = ["-O3", "-DNDEBUG", "-std=c++0x", "-Wall", "-Werror", "-ipo"]
 
+-- the obase kernels of -split-simd carry "#pragma omp simd"
+iccSimdFlags = ["-qopenmp-simd"]
+
 -- iccPPFlags = ["-P", "-C", "-DNCHECK_SHAPE", "-DNDEBUG", "-std=c++0x", "-Wall", "-Werror", "-ipo"]
 iccPPFlags = ["-P", "-C", "-DNCHECK_SHAPE", "-DNDEBUG", "-std=c++0x", "-Wall", "-Werror"]
 
@@ -142,6 +193,14 @@ iccDebugFlags = ["-DDEBUG", "-O0", "-g3", "-std=c++0x"]
 -- iccDebugPPFlags = ["-P", "-C", "-DCHECK_SHAPE", "-DDEBUG", "-g3", "-std=c++0x", "-include", "cilk_stub.h"]
 iccDebugPPFlags = ["-P", "-C", "-DCHECK_SHAPE", "-DDEBUG", "-g3", "-std=c++0x", "-wd1292"]
 
+gccPPFlags = ["-E", "-P", "-C", "-DNCHECK_SHAPE", "-DNDEBUG", "-std=c++11", "-Wall"]
+
+gccDebugPPFlags = ["-E", "-P", "-C", "-DCHECK_SHAPE", "-DDEBUG", "-g3", "-std=c++11", "-Wno-attributes"]
+
+clangPPFlags = ["-E", "-P", "-C", "-DNCHECK_SHAPE", "-DNDEBUG", "-std=c++11", "-Wall"]
+
+clangDebugPPFlags = ["-E", "-P", "-C", "-DCHECK_SHAPE", "-DDEBUG", "-g3", "-std=c++11", "-Wno-unknown-attributes"]
+
 parseArgs :: ([String], [String], PMode, Bool, Bool, [String]) -> [String] -> ([String], [String], PMode, Bool, Bool, [String])
 parseArgs (inFiles, inDirs, mode, debug, showFile, userArgs) aL 
     | elem "--help" aL =
@@ -176,6 +235,23 @@ parseArgs (inFiles, inDirs, mode, debug, showFile, userArgs) aL
         let l_mode = PMacroShadow
             aL' = delete "-split-macro-shadow" aL
         in  parseArgs (inFiles, inDirs, l_mode, debug, showFile, aL') aL'
+    | elem "-split-simd" aL =
+        let l_mode = PSimd
+            aL' = delete "-split-simd" aL
+        in  parseArgs (inFiles, inDirs, l_mode, debug, showFile, aL') aL'
+    | elem "-split-rotate" aL =
+        let l_mode = PRotate
+            aL' = delete "-split-rotate" aL
+        in  parseArgs (inFiles, inDirs, l_mode, debug, showFile, aL') aL'
+    | any (isPrefixOf "-split-unroll=") aL =
+        let l_opt = head $ filter (isPrefixOf "-split-unroll=") aL
+            (l_dim, l_factor) = break (== ':') $ drop (length "-split-unroll=") l_opt
+            l_valid = not (null l_dim) && all isDigit l_dim && 
+                      length l_factor > 1 && all isDigit (tail l_factor)
+            l_mode = if l_valid then PUnroll (read l_dim) (read $ tail l_factor) 
+                                else PHelp
+            aL' = delete l_opt aL
+        in  parseArgs (inFiles, inDirs, l_mode, debug, showFile, aL') aL'
     | elem "-showFile" aL =
         let l_showFile = True
             aL' = delete "-showFile" aL
@@ -220,11 +296,19 @@ printOptions :: IO ()
 printOptions = 
     do putStrLn ("Usage: pochoir [OPTION] [filename]")
        putStrLn ("Run the Pochoir stencil compiler on [filename].")
+       putStrLn ("-compiler=<cxx> : " ++ breakline ++ 
+               "the backend C++ compiler for preprocessing and the final compilation, e.g. icpc, g++ or clang++ (default : $POCHOIR_CXX, or else icpc)")
        putStrLn ("-auto-optimize : " ++ breakline ++ "Let the Pochoir compiler automatically choose the best optimizing level for you! (default)")
        putStrLn ("-split-macro-shadow $filename : " ++ breakline ++ 
                "using macro tricks to split the interior and boundary regions")
        putStrLn ("-split-pointer $filename : " ++ breakline ++ 
                "Default Mode : split the interior and boundary region, and using C-style pointer to optimize the base case")
+       putStrLn ("-split-simd $filename : " ++ breakline ++ 
+               "split the interior and boundary region, and vectorize the unit-stride loop of the base case with '#pragma omp simd', a scalar peel loop up to the vector alignment and a scalar remainder loop")
+       putStrLn ("-split-unroll=<dim>:<factor> $filename : " ++ breakline ++ 
+               "same as -split-pointer, but the loop over spatial dimension <dim> (0 is the unit-stride one, so 1 is j of a 3D stencil) of the base case is unrolled by <factor> and jammed into the inner loops")
+       putStrLn ("-split-rotate $filename : " ++ breakline ++ 
+               "same as -split-pointer, but the reads of consecutive offsets along the unit-stride dimension are rotated through locals in the base case, so that each point loads only the leading one")
 
 pProcess :: PMode -> Handle -> Handle -> IO ()
 pProcess mode inh outh = 
@@ -52,6 +52,8 @@ pToken =
     <|> try pParseMacro
     <|> try pParsePochoirArray
     <|> try pParsePochoirArrayAsParam
+    <|> try pParsePochoirSoAArray
+    <|> try pParsePochoirSoAArrayAsParam
     <|> try pParsePochoirStencil
     <|> try pParsePochoirStencilWithShape
     <|> try pParsePochoirStencilAsParam
@@ -77,22 +79,44 @@ pParseMacro =
 pParsePochoirArray :: GenParser Char ParserState String
 pParsePochoirArray =
     do reserved "Pochoir_Array"
-       (l_type, l_rank) <- angles $ try pDeclStatic
+       (l_type, l_rank, l_toggle, l_bdry) <- angles $ try pDeclStaticBdry
        l_arrayDecl <- commaSep1 pDeclDynamic
        l_delim <- pDelim 
-       updateState $ updatePArray $ transPArray (l_type, l_rank) l_arrayDecl
+       updateState $ updatePArray $ transPArrayToggle l_toggle $ transPArray (l_type, l_rank) l_arrayDecl
        return (breakline ++ "/* Known*/ Pochoir_Array <" ++ show l_type ++ 
-               ", " ++ show l_rank ++ "> " ++ 
+               ", " ++ show l_rank ++ pShowStaticBdry l_toggle l_bdry ++ "> " ++ 
                pShowDynamicDecl l_arrayDecl pShowArrayDim ++ l_delim)
 
 pParsePochoirArrayAsParam :: GenParser Char ParserState String
 pParsePochoirArrayAsParam =
     do reserved "Pochoir_Array"
-       (l_type, l_rank) <- angles $ try pDeclStatic
+       (l_type, l_rank, l_toggle, l_bdry) <- angles $ try pDeclStaticBdry
        l_arrayDecl <- pDeclDynamic
        l_delim <- pDelim 
-       updateState $ updatePArray $ transPArray (l_type, l_rank) [l_arrayDecl]
+       updateState $ updatePArray $ transPArrayToggle l_toggle $ transPArray (l_type, l_rank) [l_arrayDecl]
        return (breakline ++ "/* Known*/ Pochoir_Array <" ++ show l_type ++ 
+               ", " ++ show l_rank ++ pShowStaticBdry l_toggle l_bdry ++ "> " ++ 
+               pShowDynamicDecl [l_arrayDecl] pShowArrayDim ++ l_delim)
+
+pParsePochoirSoAArray :: GenParser Char ParserState String
+pParsePochoirSoAArray =
+    do reserved "Pochoir_SoA_Array"
+       (l_type, l_rank) <- angles $ try pDeclStatic
+       l_arrayDecl <- commaSep1 pDeclDynamic
+       l_delim <- pDelim 
+       updateState $ updatePArray $ transPSoAArray (l_type, l_rank) l_arrayDecl
+       return (breakline ++ "/* Known*/ Pochoir_SoA_Array <" ++ show l_type ++ 
+               ", " ++ show l_rank ++ "> " ++ 
+               pShowDynamicDecl l_arrayDecl pShowArrayDim ++ l_delim)
+
+pParsePochoirSoAArrayAsParam :: GenParser Char ParserState String
+pParsePochoirSoAArrayAsParam =
+    do reserved "Pochoir_SoA_Array"
+       (l_type, l_rank) <- angles $ try pDeclStatic
+       l_arrayDecl <- pDeclDynamic
+       l_delim <- pDelim 
+       updateState $ updatePArray $ transPSoAArray (l_type, l_rank) [l_arrayDecl]
+       return (breakline ++ "/* Known*/ Pochoir_SoA_Array <" ++ show l_type ++ 
                ", " ++ show l_rank ++ "> " ++ 
                pShowDynamicDecl [l_arrayDecl] pShowArrayDim ++ l_delim)
 
@@ -268,7 +292,16 @@ transPArray (l_type, l_rank) [] = []
 transPArray (l_type, l_rank) (p:ps) =
     let l_name = pSecond p
         l_dims = pThird p
-    in  (l_name, PArray {aName = l_name, aType = l_type, aRank = l_rank, aDims = l_dims, aMaxShift = 0, aToggle = 0, aRegBound = False}) : transPArray (l_type, l_rank) ps
+    in  (l_name, PArray {aName = l_name, aType = l_type, aRank = l_rank, aDims = l_dims, aMaxShift = 0, aToggle = 0, aRegBound = False, aSoA = False}) : transPArray (l_type, l_rank) ps
+
+-- an array declared with a compile-time toggle keeps it whatever stencil
+-- it is registered with
+transPArrayToggle :: Int -> [(PName, PArray)] -> [(PName, PArray)]
+transPArrayToggle l_toggle = map (\(l_name, l_array) -> (l_name, l_array { aToggle = l_toggle }))
+
+transPSoAArray :: (PType, Int) -> [([PName], PName, [DimExpr])] -> [(PName, PArray)]
+transPSoAArray l_static l_decls = 
+    map (\(l_name, l_array) -> (l_name, l_array { aSoA = True })) $ transPArray l_static l_decls
 
 transPStencil :: Int -> [PName] -> [PShape] -> [(PName, PStencil)]
 transPStencil l_rank [] _ = []
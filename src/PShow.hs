@@ -55,7 +55,7 @@ simplifyDimExprItem (DimDuo bop e1 e2)
     | otherwise = DimDuo bop (simplifyDimExprItem e1) (simplifyDimExprItem e2)
 simplifyDimExprItem (DimParen e) = DimParen (simplifyDimExprItem e)
 
-getFromStmts :: (PArray -> Expr -> [Iter]) -> Map.Map PName PArray -> [Stmt] -> [Iter]
+getFromStmts :: (Eq a) => (PArray -> Expr -> [a]) -> Map.Map PName PArray -> [Stmt] -> [a]
 getFromStmts l_action _ [] = []
 getFromStmts l_action l_arrayMap l_stmts@(a:as) = 
     let i1 = getFromStmt a 
@@ -100,7 +100,7 @@ getFromStmts l_action l_arrayMap l_stmts@(a:as) =
                    Just arrayInUse -> l_action arrayInUse (PVAR q v dL)
           getFromExpr (BVAR v dim) = []
           getFromExpr (BExprVAR v e) = getFromExpr e
-          getFromExpr (SVAR t e c f) = getFromExpr e
+          getFromExpr (SVAR t e c f) = union (getFromField (SVAR t e c f)) (getFromExpr e)
           getFromExpr (PSVAR t e c f) = getFromExpr e
           getFromExpr (Uno uop e) = getFromExpr e
           getFromExpr (PostUno uop e) = getFromExpr e
@@ -110,6 +110,12 @@ getFromStmts l_action l_arrayMap l_stmts@(a:as) =
               in  (union iter1 iter2)
           getFromExpr (PARENS e) = getFromExpr e
           getFromExpr _ = []
+          -- a field access is first offered as a whole to l_action
+          getFromField (SVAR t (PVAR q v dL) c f) = 
+              case Map.lookup v l_arrayMap of
+                   Nothing -> []
+                   Just arrayInUse -> l_action arrayInUse (SVAR t (PVAR q v dL) c f)
+          getFromField _ = []
 
 transStmts :: [Stmt] -> (Expr -> Expr) -> [Stmt]
 transStmts [] _ = []
@@ -141,7 +147,12 @@ transStmts l_stmts@(a:as) l_action = transStmt a : transStmts as l_action
           transExpr (PVAR q v dL) = l_action (PVAR q v dL)
           transExpr (BVAR v dim) = BVAR v dim
           transExpr (BExprVAR v e) = BExprVAR v $ transExpr e
-          transExpr (SVAR t e c f) = SVAR t (transExpr e) c f
+          -- a field access is first offered as a whole to l_action, 
+          -- which leaves it untouched unless it's a field of a SoA array
+          transExpr (SVAR t e c f) = 
+              case l_action (SVAR t e c f) of
+                   SVAR t' e' c' f' -> SVAR t' (transExpr e') c' f'
+                   e'' -> e''
           transExpr (PSVAR t e c f) = PSVAR t (transExpr e) c f
           transExpr (Uno uop e) = Uno uop $ transExpr e
           transExpr (PostUno uop e) = PostUno uop $ transExpr e
@@ -244,9 +255,54 @@ pShowMacroKernel l_macro l_sArrayInUse l_name l_kernel =
         unshadowArrayInUse = pUndefMacroArrayInUse l_sArrayInUse (kParams l_kernel)
     in  shadowArrayInUse ++ pShowAutoKernel l_name l_kernel ++ unshadowArrayInUse
 
+-- the boundary kernel split into face classes : bit k of l_face is set if
+-- the home cell is nearer to an edge of the k-th reaching dimension than 
+-- the stencil reaches, and each class only checks the accesses moving along
+-- its dimensions (the registered arrays all have the size of the domain).
+-- Kernels reaching out in more than 3 dimensions keep the macro shadowing
+pShowFaceKernel :: [PArray] -> String -> PKernel -> String
+pShowFaceKernel l_sArrayInUse l_name l_kernel
+    | null l_accesses || null (kStmt l_kernel) || length l_dims > 3 =
+        pShowMacroKernel ".boundary" l_sArrayInUse l_name l_kernel
+    | otherwise =
+        "/* known! */ auto " ++ l_name ++ " = [&] (" ++
+        pShowKernelParams l_params ++ ") {" ++ breakline ++
+        "int l_face = " ++ l_face ++ ";" ++ breakline ++
+        show (SWITCH (PARENS $ VAR "" "l_face") l_cases) ++
+        breakline ++ "};" ++ breakline
+    where l_kernelParams = kParams l_kernel
+          l_params = zipWith (++) (repeat "int ") l_kernelParams
+          l_spatials = tail l_kernelParams
+          l_rank = length l_spatials
+          l_accesses = getFromStmts getIter (transArrayMap l_sArrayInUse) 
+                                    (kStmt l_kernel)
+          l_offsets = map (getDimOffsets l_kernelParams . pThird) l_accesses
+          l_size = aName (pSecond $ head l_accesses) ++ ".size"
+          -- how far the stencil reaches below and above the home cell
+          pReach d = 
+              let l_ns = [n | Just n <- map (!! d) l_offsets]
+              in  (maximum (0 : map negate l_ns), maximum (0 : l_ns))
+          l_dims = [d | d <- [0 .. l_rank-1], pReach d /= (0, 0)]
+          pShowFaceBit k d = 
+              let (l_lo, l_hi) = pReach d
+                  l_x = l_spatials !! d
+                  l_near = [l_x ++ " < " ++ show l_lo | l_lo > 0] ++
+                           [l_x ++ " >= " ++ l_size ++ "(" ++ show (l_rank-1-d) ++ 
+                            ") - " ++ show l_hi | l_hi > 0]
+              in  "(" ++ intercalate " || " l_near ++ " ? " ++ show (2^k) ++ " : 0)"
+          l_face = if null l_dims then "0" 
+                      else intercalate " | " $ zipWith pShowFaceBit [0..] l_dims
+          pFaceDims l_class = [d | (k, d) <- zip [0..] l_dims, odd (l_class `div` 2^k)]
+          l_cases = [CASE l_class [BRACES $ transStmts (kStmt l_kernel) $ 
+                                     transFace (getArrayName l_sArrayInUse) 
+                                               l_kernelParams (pFaceDims l_class),
+                                   BREAK] 
+                        | l_class <- [0 .. 2^(length l_dims) - 1]]
+
 pShowObaseKernel :: String -> PKernel -> String
-pShowObaseKernel l_name l_kernel = 
-    let l_rank = length (kParams l_kernel) - 1
+pShowObaseKernel l_name l_kernel' = 
+    let (_, l_kernel) = pReuseKernel False l_kernel'
+        l_rank = length (kParams l_kernel) - 1
         l_iter = kIter l_kernel
         l_array = unionArrayIter l_iter
         l_t = head $ kParams l_kernel
@@ -262,8 +318,17 @@ pShowObaseKernel l_name l_kernel =
         pShowObaseTail l_rank ++ breakline ++ "};\n"
 
 pShowPointerKernel :: String -> PKernel -> String
-pShowPointerKernel l_name l_kernel = 
-    let l_rank = length (kParams l_kernel) - 1
+pShowPointerKernel = pShowReuseKernel False
+
+-- pShowPointerKernel with the reads along the unit-stride dimension 
+-- rotated through locals, see pReuseKernel
+pShowRotateKernel :: String -> PKernel -> String
+pShowRotateKernel = pShowReuseKernel True
+
+pShowReuseKernel :: Bool -> String -> PKernel -> String
+pShowReuseKernel l_rotate l_name l_kernel' = 
+    let (l_loads, l_kernel) = pReuseKernel l_rotate l_kernel'
+        l_rank = length (kParams l_kernel) - 1
         l_iter = kIter l_kernel
         l_array = unionArrayIter l_iter
         l_t = head $ kParams l_kernel
@@ -271,17 +336,83 @@ pShowPointerKernel l_name l_kernel =
         "int t0, int t1, grid_info<" ++ show l_rank ++ "> const & grid) {" ++ 
         breakline ++ "grid_info<" ++ show l_rank ++ "> l_grid = grid;" ++
         pShowPointers l_iter ++ breakline ++ 
-        pShowArrayInfo l_array ++ pShowArrayGaps l_rank l_array ++
+        pShowArrayInfo l_array ++ pShowSoAPlanes l_kernel l_array ++ 
+        pShowArrayGaps l_rank l_array ++
         breakline ++ pShowStrides l_rank l_array ++ breakline ++
         "for (int " ++ l_t ++ " = t0; " ++ l_t ++ " < t1; ++" ++ l_t ++ ") { " ++ 
         pShowPointerSet l_iter (kParams l_kernel)++
-        breakline ++ pShowPointerForHeader l_rank l_iter (tail $ kParams l_kernel) ++
+        breakline ++ pShowPointerForHeader l_rank l_iter (tail $ kParams l_kernel) 
+                        (show $ transStmts l_loads $ transPointer l_iter) ++
         breakline ++ pShowPointerStmt l_kernel ++ breakline ++ pShowObaseForTail l_rank ++
         pShowObaseTail l_rank ++ breakline ++ "};\n"
 
+-- pShowPointerKernel with the loop over dimension l_dim unrolled by 
+-- l_factor and jammed into the loops inside it, so the rows of the jammed
+-- copies share the loads of the neighbors they have in common. The rows 
+-- left over in a time step, as the sloped edges of the zoid move x0/x1 of 
+-- l_dim by dx0/dx1, run one by one afterwards
+pShowUnrollKernel :: Int -> Int -> String -> PKernel -> String
+pShowUnrollKernel l_dim l_factor l_name l_kernel
+    | l_dim < 1 || l_dim >= l_rank || l_factor < 2 || null (kStmt l_kernel) =
+        pShowPointerKernel l_name l_kernel
+    | otherwise = 
+        breakline ++ "auto " ++ l_name ++ " = [&] (" ++
+        "int t0, int t1, grid_info<" ++ show l_rank ++ "> const & grid) {" ++ 
+        breakline ++ "grid_info<" ++ show l_rank ++ "> l_grid = grid;" ++
+        pShowPointers l_iter ++ breakline ++ 
+        pShowArrayInfo l_array ++ pShowSoAPlanes l_kernel l_array ++ 
+        pShowArrayGaps l_rank l_array ++
+        breakline ++ pShowStrides l_rank l_array ++ breakline ++
+        "for (int " ++ l_t ++ " = t0; " ++ l_t ++ " < t1; ++" ++ l_t ++ ") { " ++ 
+        pShowPointerSet l_iter (kParams l_kernel) ++
+        pShowPointerForHeaderTo l_dim l_rank l_iter l_spatials ++
+        breakline ++ adjustGap l_dim l_array ++ 
+        "int " ++ l_idx ++ " = l_grid.x0[" ++ show l_dim ++ "];" ++
+        breakline ++ "for (; " ++ l_idx ++ " < l_grid.x1[" ++ show l_dim ++ "] - " ++ 
+        show (l_factor - 1) ++ "; " ++ 
+        intercalate ", " ((l_idx ++ " += " ++ show l_factor) : map (pShowBump True) l_iter) ++ 
+        ") {" ++
+        pShowPointerForHeader l_dim l_iter l_spatials (pShowLoads l_jamLoads) ++
+        breakline ++ pShowPointerStmt l_jamKernel ++ breakline ++ 
+        pShowObaseForTail l_dim ++ breakline ++ "} /* end for (unroll-and-jam) */" ++
+        breakline ++ "for (; " ++ l_idx ++ " < l_grid.x1[" ++ show l_dim ++ "]; " ++ 
+        intercalate ", " (("++" ++ l_idx) : map (pShowBump False) l_iter) ++ ") {" ++
+        pShowPointerForHeader l_dim l_iter l_spatials (pShowLoads l_rowLoads) ++
+        breakline ++ pShowPointerStmt l_rowKernel ++ breakline ++ 
+        pShowObaseForTail l_dim ++ breakline ++ "} /* end for (remainder) */" ++
+        breakline ++ pShowObaseForTail (l_rank - 1 - l_dim) ++
+        pShowObaseTail l_rank ++ breakline ++ "};\n"
+    where l_rank = length (kParams l_kernel) - 1
+          l_iter = kIter l_kernel
+          l_array = unionArrayIter l_iter
+          l_t = head $ kParams l_kernel
+          l_spatials = tail $ kParams l_kernel
+          l_idx = l_spatials !! (l_rank - 1 - l_dim)
+          l_jamStmts = [BRACES $ transAllStmts (kStmt l_kernel) $ transUnroll l_idx u 
+                            | u <- [0 .. l_factor - 1]]
+          (l_jamLoads, l_jamKernel) = pReuseKernel False $ l_kernel { kStmt = l_jamStmts }
+          (l_rowLoads, l_rowKernel) = pReuseKernel False l_kernel
+          pShowLoads l_loads = show $ transStmts l_loads $ transPointer l_iter
+          -- a jammed iteration moves the pointers l_factor rows ahead
+          pShowBump l_jam (l_iterName, l_arrayInUse, _) = 
+              let l_arrayName = aName l_arrayInUse
+              in  l_iterName ++ " += " ++ getArrayGap l_dim l_arrayName ++
+                  (if l_jam then " + " ++ show (l_factor - 1) ++ " * l_stride_" ++ 
+                                 l_arrayName ++ "_" ++ show l_dim
+                            else "")
+
+-- the jammed copy of a kernel body for the point l_idx + u
+transUnroll :: PName -> Int -> Expr -> Expr
+transUnroll l_idx u (VAR q v) 
+    | v == l_idx && u /= 0 = PARENS (Duo "+" (VAR q v) (INT u))
+transUnroll l_idx u (PVAR q v dL) = PVAR q v $ map (shiftDimExpr l_idx u) dL
+transUnroll l_idx u (BVAR v de) = BVAR v $ shiftDimExpr l_idx u de
+transUnroll _ _ e = e
+
 pShowOptPointerKernel :: String -> PKernel -> String
-pShowOptPointerKernel l_name l_kernel = 
-    let l_rank = length (kParams l_kernel) - 1
+pShowOptPointerKernel l_name l_kernel' = 
+    let (l_loads, l_kernel) = pReuseKernel False l_kernel'
+        l_rank = length (kParams l_kernel) - 1
         l_iter = kIter l_kernel
         l_array = unionArrayIter l_iter
         l_t = head $ kParams l_kernel
@@ -293,13 +424,39 @@ pShowOptPointerKernel l_name l_kernel =
         breakline ++ pShowStrides l_rank l_array ++ breakline ++
         "for (int " ++ l_t ++ " = t0; " ++ l_t ++ " < t1; ++" ++ l_t ++ ") { " ++ 
         pShowOptPointerSet l_iter (kParams l_kernel)++
-        breakline ++ pShowPointerForHeader l_rank l_iter (tail $ kParams l_kernel) ++
+        breakline ++ pShowPointerForHeader l_rank l_iter (tail $ kParams l_kernel) 
+                        (show $ transStmts l_loads $ transOptPointer l_iter) ++
         breakline ++ pShowOptPointerStmt l_kernel ++ breakline ++ pShowObaseForTail l_rank ++
         pShowObaseTail l_rank ++ breakline ++ "};\n"
 
+-- same as pShowPointerKernel, except that the unit-stride loop is
+-- generated by pShowSimdLoops
+pShowSimdKernel :: String -> PKernel -> String
+pShowSimdKernel l_name l_kernel' = 
+    let (_, l_kernel) = pReuseKernel False l_kernel'
+        l_rank = length (kParams l_kernel) - 1
+        l_iter = kIter l_kernel
+        l_array = unionArrayIter l_iter
+        l_t = head $ kParams l_kernel
+    in  breakline ++ "auto " ++ l_name ++ " = [&] (" ++
+        "int t0, int t1, grid_info<" ++ show l_rank ++ "> const & grid) {" ++ 
+        breakline ++ "grid_info<" ++ show l_rank ++ "> l_grid = grid;" ++
+        pShowPointers l_iter ++ breakline ++ 
+        pShowArrayInfo l_array ++ pShowSoAPlanes l_kernel l_array ++ 
+        pShowArrayGaps l_rank l_array ++
+        breakline ++ pShowStrides l_rank l_array ++ 
+        (if pSimdSafe l_kernel then pShowSimdWidth l_array else "") ++ 
+        breakline ++ 
+        "for (int " ++ l_t ++ " = t0; " ++ l_t ++ " < t1; ++" ++ l_t ++ ") { " ++ 
+        pShowPointerSet l_iter (kParams l_kernel)++
+        breakline ++ pShowSimdForHeader l_rank l_iter (tail $ kParams l_kernel) ++
+        pShowSimdLoops l_kernel ++ breakline ++ pShowObaseForTail (l_rank-1) ++
+        pShowObaseTail l_rank ++ breakline ++ "};\n"
+
 pShowCPointerKernel :: String -> PKernel -> String
-pShowCPointerKernel l_name l_kernel = 
-    let l_rank = length (kParams l_kernel) - 1
+pShowCPointerKernel l_name l_kernel' = 
+    let (_, l_kernel) = pReuseKernel False l_kernel'
+        l_rank = length (kParams l_kernel) - 1
         l_iter = kIter l_kernel
         l_array = unionArrayIter l_iter
         l_t = head $ kParams l_kernel
@@ -310,6 +467,7 @@ pShowCPointerKernel l_name l_kernel =
         breakline ++ pShowStrides l_rank l_array ++ breakline ++
         pShowRefMacro (kParams l_kernel) l_array ++
         "for (int " ++ l_t ++ " = t0; " ++ l_t ++ " < t1; ++" ++ l_t ++ ") { " ++ 
+        pShowTimePlanes l_iter ++
         breakline ++ pShowRawForHeader (tail $ kParams l_kernel) ++
         breakline ++ pShowCPointerStmt l_kernel ++ breakline ++ pShowObaseForTail l_rank ++
         pShowObaseTail l_rank ++ breakline ++ pShowRefUnMacro l_array ++ 
@@ -326,11 +484,33 @@ transCPointer :: [Iter] -> Expr -> Expr
 transCPointer l_iters (PVAR q v dL) =
     case pIterLookup (v, dL) l_iters of
         Nothing -> PVAR q v dL
-        Just iterName -> VAR q $ pRef v dL
+        Just iterName -> VAR q $ pRef v (pTimePlane l_iters v $ head dL) (tail dL)
 transCPointer l_iters e = e
 
-pRef :: PName -> [DimExpr] -> String
-pRef a dL = "ref_" ++ a ++ "(" ++ (intercalate ", " $ map show dL) ++ ")"
+pRef :: PName -> String -> [DimExpr] -> String
+pRef a p dL = "ref_" ++ a ++ "(" ++ (intercalate ", " $ p : map show dL) ++ ")"
+
+-- the distinct time planes read/written by the kernel, the base of each 
+-- one is taken once per time step instead of per access
+getTimePlanes :: [Iter] -> [(PName, DimExpr)]
+getTimePlanes l_iters = nub $ map (\(_, a, dL) -> (aName a, head dL)) l_iters
+
+pTimePlane :: [Iter] -> PName -> DimExpr -> String
+pTimePlane l_iters a t = 
+    case elemIndex (a, t) $ getTimePlanes l_iters of
+        Nothing -> "/* NO time plane found! */"
+        Just n -> "l_" ++ a ++ "_plane_" ++ show n
+
+pShowTimePlanes :: [Iter] -> String
+pShowTimePlanes l_iters = concat $ map pShowTimePlane $ getTimePlanes l_iters
+    where pShowTimePlane (a, t) = 
+            case find (\(_, arr, _) -> aName arr == a) l_iters of
+                Nothing -> ""
+                Just (_, l_array, _) -> 
+                    breakline ++ show (aType l_array) ++ " * const " ++ 
+                    pTimePlane l_iters a t ++ " = " ++ a ++ "_base + " ++ 
+                    pGetTimeOffset (aToggle l_array) t ++ " * l_" ++ a ++ 
+                    "_total_size;"
 
 pShowRawForHeader :: [PName] -> String
 pShowRawForHeader [] = ""
@@ -358,13 +538,10 @@ pShowRefMacro :: [PName] -> [PArray] -> String
 pShowRefMacro _ [] = ""
 pShowRefMacro l_kernelParams aL@(a:as) =
     let l_name = aName a
-        l_t = head l_kernelParams
         l_dims = tail l_kernelParams
-        l_toggle = aToggle a
         l_rank = aRank a
-    in  "#define ref_" ++ l_name ++ "(" ++ pShowKernelParams l_kernelParams ++
-        ") " ++ l_name ++ "_base[" ++ pGetTimeOffset l_toggle (DimVAR l_t) ++
-        " * l_" ++ l_name ++ "_total_size + " ++ 
+    in  "#define ref_" ++ l_name ++ "(" ++ pShowKernelParams ("l_plane" : l_dims) ++
+        ") l_plane[" ++ 
         (intercalate " + " $ zipWith pMul l_dims $ pStrideList l_name l_rank) ++ "]" ++
         breakline ++ breakline ++ pShowRefMacro l_kernelParams as
 
@@ -381,11 +558,22 @@ pShowArrayInfo arrayInUse = foldr pShowArrayInfoItem "" arrayInUse
     where pShowArrayInfoItem l_arrayItem str =
             let l_type = aType l_arrayItem
                 l_name = aName l_arrayItem
-            in  str ++ breakline ++ show l_type ++ " * " ++ l_name ++ "_base"  ++ 
-                " = " ++ l_name ++ ".data();" ++ breakline ++
+                l_base = if aSoA l_arrayItem 
+                            then "const int " ++ l_name ++ "_base = 0;"
+                            else show l_type ++ " * " ++ l_name ++ "_base"  ++ 
+                                 " = " ++ l_name ++ ".data();"
+            in  str ++ breakline ++ l_base ++ breakline ++
                 "const int " ++ "l_" ++ l_name ++ "_total_size = " ++ l_name ++
                 ".total_size();" ++ breakline
 
+-- the beginning of each field plane of the SoA arrays used by the kernel
+pShowSoAPlanes :: PKernel -> [PArray] -> String
+pShowSoAPlanes l_kernel l_array =
+    let l_fields = getFromStmts getSoAField (transArrayMap l_array) (kStmt l_kernel)
+        pShowSoAPlane (a, f) = breakline ++ "auto const " ++ pSoAPlane a f ++ 
+                               " = &(" ++ a ++ ".plane_base()." ++ f ++ ");"
+    in  concat $ map pShowSoAPlane l_fields
+
 pShowStrides :: Int -> [PArray] -> String
 pShowStrides n [] = ""
 pShowStrides n aL@(a:as) = "const int " ++ getStrides n aL ++ ";\n"
@@ -401,7 +589,9 @@ pShowStrides n aL@(a:as) = "const int " ++ getStrides n aL ++ ";\n"
 pShowPointers :: [Iter] -> String
 pShowPointers [] = ""
 pShowPointers iL@(i:is) = foldr pShowPointer "" iL
-    where pShowPointer (nameIter, arrayInUse, dL) str =
+    where pShowPointer (nameIter, arrayInUse, dL) str 
+            | aSoA arrayInUse = str ++ breakline ++ "int " ++ nameIter ++ ";"
+            | otherwise = 
                 str ++ breakline ++ (show $ aType arrayInUse) ++ " * " ++ nameIter ++ ";"
 
 pShowPointerStmt :: PKernel -> String
@@ -425,6 +615,147 @@ pShowOptPointerStmt l_kernel =
         obaseStmts = transStmts oldStmts $ transOptPointer l_iter
     in show obaseStmts
 
+-- scalar replacement in the body of an obase kernel : a read repeated in 
+-- the body is loaded once per point into a local, and with l_rotate, the 
+-- reads of a run of consecutive offsets along the unit-stride dimension 
+-- are rotated through locals, so that only the leading one is loaded per 
+-- point. The rest of the run is loaded by the returned statements, which 
+-- have to go right before the unit-stride loop. A read only moves if no 
+-- write of the kernel can hit its time plane of the array
+pReuseKernel :: Bool -> PKernel -> ([Stmt], PKernel)
+pReuseKernel l_rotate l_kernel =
+    let l_stmts = kStmt l_kernel
+        l_params = kParams l_kernel
+        l_idx = last l_params
+        l_arrays = unionArrayIter $ kIter l_kernel
+        l_exprs = concat $ map getSubExprs $ getStmtsExprs l_stmts
+        l_writes = concat $ map getWrite l_exprs
+        pTime dL = getDimOffset (head l_params) (head dL)
+        pAlias a t (v, dL) = v == aName a && 
+                             maybe True (\t' -> mod (t' - t) (aToggle a) == 0) (pTime dL)
+        pReusable a dL = 
+            not (aSoA a) && basicType (aType a) /= PUserType && aToggle a > 0 &&
+            notElem Nothing (pTime dL : getDimOffsets l_params dL) &&
+            maybe False (\t -> not $ any (pAlias a t) l_writes) (pTime dL)
+        l_reads = [(a, dL) | PVAR "" v dL <- l_exprs, 
+                             a <- filter ((== v) . aName) l_arrays, pReusable a dL]
+        l_distinct = nub l_reads
+        pCount r = length $ filter (== r) l_reads
+        pInner (_, dL) = getDimOffset l_idx (last dL)
+        -- the runs along the unit-stride dimension : same array, time and 
+        -- outer offsets, and consecutive offsets in the unit-stride one
+        l_keys = nub [(a, init dL) | (a, dL) <- l_distinct]
+        pRun (a, l_outer) = 
+            let l_members = filter (\(a', dL) -> (a', init dL) == (a, l_outer)) l_distinct
+                l_offsets = sort $ nub [k | Just k <- map pInner l_members]
+            in  (a, l_members, l_offsets)
+        l_runs = if l_rotate == False || hasJumpStmts l_stmts then [] 
+                    else [r | r@(_, _, ks) <- map pRun l_keys, 
+                              length ks > 1, ks == [head ks .. last ks]]
+        l_inRun = concat [ms | (_, ms, _) <- l_runs]
+        l_cse = [r | r <- l_distinct, notElem r l_inRun, pCount r > 1]
+        pLocal a n = "l_reuse_" ++ aName a ++ "_" ++ n
+        pType a = [typeName $ aType a]
+        pRead a dL = PVAR "" (aName a) dL
+        -- the locals of the n-th run are numbered by offset - lowest offset
+        pRunLocal n (a, l_members, ks) = 
+            [((a, dL), pLocal a (show n ++ "_" ++ show (k - head ks))) 
+                | (a', dL) <- l_members, Just k <- [pInner (a', dL)]]
+        pRunDL (a, l_members, _) k = 
+            head [dL | r@(_, dL) <- l_members, pInner r == Just k]
+        pRunLoads n l_run@(a, _, ks) = 
+            [DEXPR (pType a) (aType a) 
+                [Duo "=" (VAR "" $ pLocal a (show n ++ "_" ++ show (k - head ks))) 
+                         (pRead a $ pRunDL l_run k)] | k <- init ks] ++
+            [DEXPR (pType a) (aType a) 
+                [VAR "" $ pLocal a (show n ++ "_" ++ show (last ks - head ks))]]
+        pRunLead n l_run@(a, _, ks) = 
+            EXPR $ Duo "=" (VAR "" $ pLocal a (show n ++ "_" ++ show (last ks - head ks)))
+                           (pRead a $ pRunDL l_run $ last ks)
+        pRunRoll n (a, _, ks) = 
+            [EXPR $ Duo "=" (VAR "" $ pLocal a (show n ++ "_" ++ show (k - head ks)))
+                            (VAR "" $ pLocal a (show n ++ "_" ++ show (k + 1 - head ks))) 
+                | k <- init ks]
+        l_cseLocals = zipWith (\n r@(a, _) -> (r, pLocal a $ show n)) [0..] l_cse
+        pCseLoad ((a, dL), l_local) = 
+            DEXPR ("const" : pType a) (aType a) [Duo "=" (VAR "" l_local) (pRead a dL)]
+        l_locals = l_cseLocals ++ concat (zipWith pRunLocal [0..] l_runs)
+        transReuse (PVAR "" v dL) = 
+            case [l | ((a, dL'), l) <- l_locals, aName a == v, dL' == dL] of
+                (l:_) -> VAR "" l
+                [] -> PVAR "" v dL
+        transReuse e = e
+        l_body = zipWith pRunLead [0..] l_runs ++ map pCseLoad l_cseLocals ++
+                 transStmts l_stmts transReuse ++ concat (zipWith pRunRoll [0..] l_runs)
+    in  if null l_locals then ([], l_kernel)
+           else (concat $ zipWith pRunLoads [0..] l_runs, l_kernel { kStmt = l_body })
+
+-- the expressions of a list of statements, outermost first
+getStmtsExprs :: [Stmt] -> [Expr]
+getStmtsExprs [] = []
+getStmtsExprs (a:as) = getStmtExprs a ++ getStmtsExprs as
+    where getStmtExprs (BRACES stmts) = getStmtsExprs stmts
+          getStmtExprs (EXPR e) = [e]
+          getStmtExprs (DEXPR qs t es) = es
+          getStmtExprs (IF e s1 s2) = e : getStmtExprs s1 ++ getStmtExprs s2
+          getStmtExprs (SWITCH e stmts) = e : getStmtsExprs stmts
+          getStmtExprs (CASE v stmts) = getStmtsExprs stmts
+          getStmtExprs (DEFAULT stmts) = getStmtsExprs stmts
+          getStmtExprs (DO e stmts) = e : getStmtsExprs stmts
+          getStmtExprs (WHILE e stmts) = e : getStmtsExprs stmts
+          getStmtExprs (FOR sL s) = concat (map getStmtsExprs sL) ++ getStmtExprs s
+          getStmtExprs (RET e) = [e]
+          getStmtExprs _ = []
+
+getSubExprs :: Expr -> [Expr]
+getSubExprs e = e : getSubExprsL e
+    where getSubExprsL (BExprVAR v e1) = getSubExprs e1
+          getSubExprsL (SVAR t e1 c f) = getSubExprs e1
+          getSubExprsL (PSVAR t e1 c f) = getSubExprs e1
+          getSubExprsL (Uno uop e1) = getSubExprs e1
+          getSubExprsL (PostUno uop e1) = getSubExprs e1
+          getSubExprsL (Duo bop e1 e2) = getSubExprs e1 ++ getSubExprs e2
+          getSubExprsL (PARENS e1) = getSubExprs e1
+          getSubExprsL _ = []
+
+-- the array elements written, or whose address is taken, by an expression
+getWrite :: Expr -> [(PName, [DimExpr])]
+getWrite (Duo bop e1 e2) 
+    | elem bop ["=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=", ">>="] =
+        getWriteTarget e1
+getWrite (Uno uop e) | elem uop ["++", "--", "&"] = getWriteTarget e
+getWrite (PostUno uop e) = getWriteTarget e
+getWrite (PVAR q v dL) | q /= "" = [(v, dL)]
+getWrite _ = []
+
+getWriteTarget :: Expr -> [(PName, [DimExpr])]
+getWriteTarget (PVAR q v dL) = [(v, dL)]
+getWriteTarget (PARENS e) = getWriteTarget e
+getWriteTarget (SVAR t e c f) = getWriteTarget e
+getWriteTarget (PSVAR t e c f) = getWriteTarget e
+-- '=' associates to the left in our grammar
+getWriteTarget (Duo bop e1 e2) = getWriteTarget e1 ++ getWriteTarget e2
+getWriteTarget _ = []
+
+-- does the body leave a point early ?
+hasJumpStmts :: [Stmt] -> Bool
+hasJumpStmts [] = False
+hasJumpStmts (a:as) = hasJumpStmt a || hasJumpStmts as
+    where hasJumpStmt (BRACES stmts) = hasJumpStmts stmts
+          hasJumpStmt (IF e s1 s2) = hasJumpStmt s1 || hasJumpStmt s2
+          hasJumpStmt (SWITCH e stmts) = hasJumpStmts stmts
+          hasJumpStmt (CASE v stmts) = hasJumpStmts stmts
+          hasJumpStmt (DEFAULT stmts) = hasJumpStmts stmts
+          hasJumpStmt (DO e stmts) = hasJumpStmts stmts
+          hasJumpStmt (WHILE e stmts) = hasJumpStmts stmts
+          hasJumpStmt (FOR sL s) = hasJumpStmt s
+          hasJumpStmt BREAK = True
+          hasJumpStmt CONT = True
+          hasJumpStmt RETURN = True
+          hasJumpStmt (RET e) = True
+          hasJumpStmt (UNKNOWN s) = True
+          hasJumpStmt _ = False
+
 transOptPointer :: [Iter] -> Expr -> Expr
 transOptPointer l_iters (PVAR q v dL) =
     case pIterLookup (v, dL) l_iters of
@@ -432,18 +763,44 @@ transOptPointer l_iters (PVAR q v dL) =
         Just iterName -> VAR q $ "(*" ++ iterName ++ ")"
 transOptPointer l_iters e = e
 
+-- the iterator of a SoA array is an index shared by all its field planes,
+-- so a.field(t, i, j) becomes a_plane_field[iter + de], and a whole element 
+-- of it is left to the a.interior() proxy
 transPointer :: [Iter] -> Expr -> Expr
 transPointer l_iters (PVAR q v dL) =
     case pPointerLookup (v, dL) l_iters of
         Nothing -> PVAR q v dL
-        Just (iterName, arrayInUse, des) -> 
-            BVAR iterName de
-                where de = simplifyDimExpr naive_de
-                      naive_de = foldr plusCombDimExpr x $ zipWith mulDimExpr strideL $ tail $ excludeDimExpr dL des 
-                      strideL = pGetArrayStrideList (aRank arrayInUse) (aName arrayInUse)
-                      x = (DimINT 0)
+        Just (iterName, arrayInUse, des) 
+            | aSoA arrayInUse -> PVAR q (v ++ ".interior") dL
+            | otherwise -> BVAR iterName $ pPointerOffset arrayInUse dL des
+transPointer l_iters (SVAR t (PVAR q v dL) "." f) =
+    case pPointerLookup (v, dL) l_iters of
+        Just (iterName, arrayInUse, des) | aSoA arrayInUse -> 
+            BVAR (pSoAPlane v f) $ simplifyDimExpr $ 
+                DimDuo "+" (DimVAR iterName) (pPointerOffset arrayInUse dL des)
+        _ -> SVAR t (PVAR q v dL) "." f
 transPointer l_iters e = e
 
+pPointerOffset :: PArray -> [DimExpr] -> [DimExpr] -> DimExpr
+pPointerOffset arrayInUse dL des = 
+    let naive_de = foldr plusCombDimExpr x $ zipWith mulDimExpr strideL $ tail $ excludeDimExpr dL des 
+        strideL = pGetArrayStrideList (aRank arrayInUse) (aName arrayInUse)
+        x = (DimINT 0)
+    in  simplifyDimExpr naive_de
+
+pSoAPlane :: PName -> String -> String
+pSoAPlane a f = a ++ "_plane_" ++ f
+
+-- inside the vectorized loop the pointers stay at l_base, so the 
+-- unit-stride index is folded into the subscript
+transSimdPointer :: PName -> String -> [Iter] -> Expr -> Expr
+transSimdPointer l_idx l_base l_iters e =
+    case transPointer l_iters e of
+        BVAR iterName de -> 
+            BVAR iterName $ simplifyDimExpr $ 
+                DimDuo "+" (DimParen (DimDuo "-" (DimVAR l_idx) (DimVAR l_base))) de
+        e' -> e'
+
 plusCombDimExpr :: DimExpr -> DimExpr -> DimExpr
 plusCombDimExpr e1 e2 = DimDuo "+" e1 e2
 
@@ -479,6 +836,32 @@ transIter l_iters (PVAR q v dL) =
         Just iterName -> VAR q iterName
 transIter l_iters e = e
 
+-- same as transStmts, except that l_action is applied to every expression
+-- (after its sub-expressions), not only to the array references
+transAllStmts :: [Stmt] -> (Expr -> Expr) -> [Stmt]
+transAllStmts l_stmts l_action = map transStmt l_stmts
+    where transStmt (BRACES stmts) = BRACES $ map transStmt stmts
+          transStmt (EXPR e) = EXPR $ transExpr e
+          transStmt (DEXPR qs t es) = DEXPR qs t $ map transExpr es
+          transStmt (IF e s1 s2) = IF (transExpr e) (transStmt s1) (transStmt s2)
+          transStmt (SWITCH e stmts) = SWITCH (transExpr e) $ map transStmt stmts
+          transStmt (CASE v stmts) = CASE v $ map transStmt stmts
+          transStmt (DEFAULT stmts) = DEFAULT $ map transStmt stmts
+          transStmt (DO e stmts) = DO (transExpr e) $ map transStmt stmts
+          transStmt (WHILE e stmts) = WHILE (transExpr e) $ map transStmt stmts
+          transStmt (FOR sL s) = FOR (map (map transStmt) sL) (transStmt s)
+          transStmt (RET e) = RET (transExpr e)
+          transStmt s = s
+          transExpr e = l_action $ transSubExpr e
+          transSubExpr (BExprVAR v e) = BExprVAR v $ transExpr e
+          transSubExpr (SVAR t e c f) = SVAR t (transExpr e) c f
+          transSubExpr (PSVAR t e c f) = PSVAR t (transExpr e) c f
+          transSubExpr (Uno uop e) = Uno uop $ transExpr e
+          transSubExpr (PostUno uop e) = PostUno uop $ transExpr e
+          transSubExpr (Duo bop e1 e2) = Duo bop (transExpr e1) (transExpr e2)
+          transSubExpr (PARENS e) = PARENS $ transExpr e
+          transSubExpr e = e
+
 pShowIterSet :: [Iter] -> [PName] -> String
 pShowIterSet iL@(i:is) l_kernelParams = concat $ map pShowIterSetTerm iL
     where pShowIterSetTerm (name, array, dim) = 
@@ -548,11 +931,23 @@ pShowPointerSet iL@(i:is) l_kernelParams = concat $ map pShowPointerSetTerm iL
             in  breakline ++ iterName ++ " = " ++ l_arrayBaseName ++ " + " ++ 
                 l_arrayTimeOffset ++ " + " ++ l_arraySpaceOffset ++ ";" 
 
+-- the time index is never negative, so a power-of-two toggle is a mask,
+-- and any other one a modulo by a constant (a multiply after icc/gcc)
 pGetTimeOffset :: Int -> DimExpr -> String
 pGetTimeOffset toggle tDim 
-    | toggle == 2 = "((" ++ show tDim ++ ")" ++ " & 0x1" ++ ")"
-    | toggle == 4 = "((" ++ show tDim ++ ")" ++ " & 0x11" ++ ")"
+    | toggle == 1 = "(0)"
+    | isPowerOf2 toggle = "((" ++ show tDim ++ ")" ++ " & " ++ show (toggle - 1) ++ ")"
     | otherwise = "((" ++ show tDim ++ ") % " ++ show toggle ++ ")"
+    where isPowerOf2 n = n > 0 && elem n (takeWhile (<= n) $ iterate (* 2) 1)
+
+pShowStaticToggle :: Int -> String
+pShowStaticToggle 0 = ""
+pShowStaticToggle l_toggle = ", " ++ show l_toggle
+
+-- the toggle has to be spelled out in front of a boundary functor
+pShowStaticBdry :: Int -> PName -> String
+pShowStaticBdry l_toggle "" = pShowStaticToggle l_toggle
+pShowStaticBdry l_toggle l_bdry = ", " ++ show l_toggle ++ ", " ++ l_bdry
 
 pCombineDim :: DimExpr -> String -> String
 -- l_stride_pa_0 may NOT necessary be "1", 
@@ -630,27 +1025,138 @@ pShowObaseForHeader n iL pL =
                            ") {" ++ pShowObaseForHeader (n-1) iL pL
     where wrapIterInc gap iter = iter ++ ".inc(" ++ gap ++ ")"
 
--- pL is the parameter list of original user supplied computing kernel
-pShowPointerForHeader :: Int -> [Iter] -> [PName] -> String
-pShowPointerForHeader _ _ [] = ""
-pShowPointerForHeader 1 iL pL = 
-                           breakline ++ pShowPragma ++
+-- pL is the parameter list of original user supplied computing kernel,
+-- l_loads go right before the unit-stride loop
+pShowPointerForHeader :: Int -> [Iter] -> [PName] -> String -> String
+pShowPointerForHeader _ _ [] _ = ""
+pShowPointerForHeader 1 iL pL l_loads = 
+                           breakline ++ l_loads ++ pShowPragma ++
                            breakline ++ pShowForHeader 0 (unionArrayIter iL) pL ++  
                            pShowIterComma iL ++
                            breakline ++ intercalate (", " ++ breakline) 
                                         (map ((++) "++" . getIterName) iL) ++ ") {"
 --                                        (map ((flip (++) "+=1") . getIterName) iL) ++ ") {"
 
-pShowPointerForHeader n iL pL = 
+pShowPointerForHeader n iL pL l_loads = 
                            breakline ++ pShowForHeader (n-1) (unionArrayIter iL) pL ++ 
                            pShowIterComma iL ++
                            breakline ++ intercalate (", " ++ breakline) 
                                      (zipWith wrapIterInc
                                         (map (getArrayGap (n-1)) (getArrayIter iL))
                                         (map getIterName iL)) ++ 
-                           ") {" ++ pShowPointerForHeader (n-1) iL pL
+                           ") {" ++ pShowPointerForHeader (n-1) iL pL l_loads
     where wrapIterInc gap iter = iter ++ " += " ++ gap 
 
+-- same as pShowPointerForHeader, but stops above the loop over l_stop
+pShowPointerForHeaderTo :: Int -> Int -> [Iter] -> [PName] -> String
+pShowPointerForHeaderTo l_stop n iL pL
+    | n - 1 <= l_stop = ""
+    | otherwise = 
+                           breakline ++ pShowForHeader (n-1) (unionArrayIter iL) pL ++ 
+                           pShowIterComma iL ++
+                           breakline ++ intercalate (", " ++ breakline) 
+                                     (zipWith wrapIterInc
+                                        (map (getArrayGap (n-1)) (getArrayIter iL))
+                                        (map getIterName iL)) ++ 
+                           ") {" ++ pShowPointerForHeaderTo l_stop (n-1) iL pL
+    where wrapIterInc gap iter = iter ++ " += " ++ gap 
+
+-- same as pShowPointerForHeader, but stops above the unit-stride loop
+pShowSimdForHeader :: Int -> [Iter] -> [PName] -> String
+pShowSimdForHeader _ _ [] = ""
+pShowSimdForHeader 1 iL pL = ""
+pShowSimdForHeader n iL pL = 
+                           breakline ++ pShowForHeader (n-1) (unionArrayIter iL) pL ++ 
+                           pShowIterComma iL ++
+                           breakline ++ intercalate (", " ++ breakline) 
+                                     (zipWith wrapIterInc
+                                        (map (getArrayGap (n-1)) (getArrayIter iL))
+                                        (map getIterName iL)) ++ 
+                           ") {" ++ pShowSimdForHeader (n-1) iL pL
+    where wrapIterInc gap iter = iter ++ " += " ++ gap 
+
+-- # of elements of the first array per vector, 64 bytes covers both 
+-- AVX2 and AVX-512
+pShowSimdWidth :: [PArray] -> String
+pShowSimdWidth [] = ""
+pShowSimdWidth (a:as) = 
+    let l_size = "sizeof(" ++ show (aType a) ++ ")"
+    in  "const int l_simd_width = (" ++ l_size ++ " < 64) ? (int)(64 / " ++ 
+        l_size ++ ") : 1;" ++ breakline
+
+-- can the unit-stride loop be vectorized ? Not if the kernel reads a time 
+-- plane it writes at another offset along the unit-stride dimension, as 
+-- the points of a vector would then depend on each other. Unknown time or 
+-- unit-stride offsets count as a hit
+pSimdSafe :: PKernel -> Bool
+pSimdSafe l_kernel = 
+    let l_params = kParams l_kernel
+        l_t = head l_params
+        l_idx = last l_params
+        l_arrays = unionArrayIter $ kIter l_kernel
+        l_exprs = concat $ map getSubExprs $ getStmtsExprs $ kStmt l_kernel
+        l_writes = concat $ map getWrite l_exprs
+        l_reads = [(v, dL) | PVAR _ v dL <- l_exprs]
+        pToggle v = maybe 0 aToggle $ find ((== v) . aName) l_arrays
+        pSamePlane v dR dW = 
+            case (getDimOffset l_t (head dR), getDimOffset l_t (head dW)) of
+                (Just r, Just w) -> pToggle v <= 0 || mod (r - w) (pToggle v) == 0
+                _ -> True
+        pInner dL = getDimOffset l_idx (last dL)
+        pCarried (v, dR) (w, dW) = 
+            v == w && (null dR || null dW || 
+                       (pSamePlane v dR dW && 
+                        (pInner dR == Nothing || pInner dR /= pInner dW)))
+    in  not $ or [pCarried r w | r <- l_reads, w <- l_writes]
+
+-- the unit-stride loop : a scalar peel loop up to the vector alignment of 
+-- the first point of the row, the vectorized body and a scalar remainder 
+-- loop. The alignment is the one of the address of a pointer into the 
+-- array the vector width is taken from, a written one if any. 
+-- The peel/remainder loops bump the pointers as in pShowPointerForHeader, 
+-- the vectorized body indexes off the pointers and bumps them afterwards.
+-- A kernel which fails pSimdSafe gets a plain scalar loop
+pShowSimdLoops :: PKernel -> String
+pShowSimdLoops l_kernel = 
+    let l_iter = kIter l_kernel
+        l_idx = last $ kParams l_kernel
+        l_iterNames = map getIterName l_iter
+        l_simdStmts = transStmts (kStmt l_kernel) $ 
+                        transSimdPointer l_idx "l_simd_peel" l_iter
+        l_writes = concat $ map getWrite $ concat $ map getSubExprs $ 
+                        getStmtsExprs $ kStmt l_kernel
+        l_writeIters = [n | w <- l_writes, Just n <- [pIterLookup w l_iter]]
+        l_alignIters = [n | (n, a, _) <- l_iter, not (aSoA a),
+                            aName a == aName (head $ unionArrayIter l_iter)]
+        l_skip = 
+            case filter (`elem` l_writeIters) l_alignIters ++ l_alignIters of
+                (n:_) -> "(l_simd_width - (int)(((size_t)" ++ n ++ " / sizeof(*" ++ 
+                         n ++ ")) % l_simd_width)) % l_simd_width"
+                [] -> "(l_simd_width - ((l_simd_lo % l_simd_width) + l_simd_width) % l_simd_width) % l_simd_width"
+        pShowScalarHeader l_lo l_hi = 
+            "for (int " ++ l_idx ++ " = " ++ l_lo ++ "; " ++ l_idx ++ " < " ++ 
+            l_hi ++ "; " ++ (intercalate ", " $ map ((++) "++") (l_idx:l_iterNames)) ++ 
+            ") {"
+        pShowIterBump l_name = breakline ++ l_name ++ " += l_simd_end - l_simd_peel;"
+        l_scalar = breakline ++ pShowScalarHeader "l_grid.x0[0]" "l_grid.x1[0]" ++
+                   breakline ++ pShowPointerStmt l_kernel ++ breakline ++ "}"
+    in  if not (pSimdSafe l_kernel) then l_scalar else 
+        breakline ++ "const int l_simd_lo = l_grid.x0[0], l_simd_hi = l_grid.x1[0];" ++
+        breakline ++ "const int l_simd_skip = " ++ l_skip ++ ";" ++
+        breakline ++ "const int l_simd_peel = (l_simd_lo + l_simd_skip < l_simd_hi) ? l_simd_lo + l_simd_skip : l_simd_hi;" ++
+        breakline ++ "const int l_simd_end = l_simd_peel + (l_simd_hi - l_simd_peel) / l_simd_width * l_simd_width;" ++
+        breakline ++ "/* scalar peel */" ++
+        breakline ++ pShowScalarHeader "l_simd_lo" "l_simd_peel" ++
+        breakline ++ pShowPointerStmt l_kernel ++ breakline ++ "}" ++
+        breakline ++ "#pragma omp simd" ++
+        breakline ++ "for (int " ++ l_idx ++ " = l_simd_peel; " ++ l_idx ++ 
+        " < l_simd_end; ++" ++ l_idx ++ ") {" ++
+        breakline ++ show l_simdStmts ++ breakline ++ "}" ++
+        (concat $ map pShowIterBump l_iterNames) ++
+        breakline ++ "/* scalar remainder */" ++
+        breakline ++ pShowScalarHeader "l_simd_end" "l_simd_hi" ++
+        breakline ++ pShowPointerStmt l_kernel ++ breakline ++ "}"
+
 pShowIterComma :: [Iter] -> String
 pShowIterComma [] = ""
 pShowIterComma iL@(i:is) = ", "
@@ -113,6 +113,16 @@ getToggleFromShape l_shapes =
         l_t_min = minimum l_t
     in  (1 + l_t_max - l_t_min)
 
+-- the time planes an array read through l_shapes has to keep, if the
+-- oldest one is read only at the home cell, it is overwritten in place
+getLiveToggleFromShape :: Int -> [[Int]] -> Int
+getLiveToggleFromShape l_home l_shapes =
+    let l_t_min = minimum $ l_home : map head l_shapes
+        l_oldest = filter ((== l_t_min) . head) l_shapes
+        l_homeOnly = l_t_min < l_home && all (all (== 0) . tail) l_oldest
+        l_toggle = 1 + l_home - l_t_min
+    in  if l_homeOnly then l_toggle - 1 else l_toggle
+
 getSlopesFromShape :: Int -> [[Int]] -> [Int]
 getSlopesFromShape l_height l_shapes = 
     let l_spatials = transpose $ map tail l_shapes
@@ -161,6 +171,17 @@ getPointer kernelParams arrayInUse (PVAR q v dL) =
     in  [(iterName, arrayInUse, dL')]
 getPointer _ arrayInUse _ = []
 
+-- only the pointer modes know the per-field planes of a SoA array, 
+-- the other modes leave its accesses to operator()
+dropSoAIter :: [Iter] -> [Iter]
+dropSoAIter = filter (not . aSoA . pSecond)
+
+-- the fields of SoA arrays read/written through (SVAR _ (PVAR ..) "." field)
+getSoAField :: PArray -> Expr -> [(PName, String)]
+getSoAField arrayInUse (SVAR t (PVAR q v dL) c f) =
+    if aSoA arrayInUse && c == "." then [(aName arrayInUse, f)] else []
+getSoAField _ _ = []
+
 transIterN :: Int -> [Iter] -> [Iter]
 transIterN _ [] = []
 transIterN n ((name, array, dim):is) = (name ++ show n, array, dim) : (transIterN (n+1) is)
@@ -199,6 +220,52 @@ transInterior l_arrayInUse (PVAR q v dL) =
                                    else PVAR q v dL
 transInterior l_arrayInUse e = e
 
+-- the constant offset of a spatial index from its kernel parameter, 
+-- e.g. i, i+1 or (i-2), and Nothing if the index is of any other form
+getDimOffset :: PName -> DimExpr -> Maybe Int
+getDimOffset l_param (DimVAR v) = if v == l_param then Just 0 else Nothing
+getDimOffset l_param (DimParen e) = getDimOffset l_param e
+getDimOffset l_param (DimDuo "+" e (DimINT n)) = fmap (+ n) $ getDimOffset l_param e
+getDimOffset l_param (DimDuo "+" (DimINT n) e) = fmap (+ n) $ getDimOffset l_param e
+getDimOffset l_param (DimDuo "-" e (DimINT n)) = fmap (subtract n) $ getDimOffset l_param e
+getDimOffset _ _ = Nothing
+
+-- the index of the point l_param + n instead of l_param, an index of the 
+-- form l_param +/- constant is kept in that form
+shiftDimExpr :: PName -> Int -> DimExpr -> DimExpr
+shiftDimExpr l_param n e =
+    case getDimOffset l_param e of
+        Just k -> pOffsetExpr (k + n)
+        Nothing -> substDim e
+    where pOffsetExpr k 
+            | k > 0 = DimDuo "+" (DimVAR l_param) (DimINT k)
+            | k < 0 = DimDuo "-" (DimVAR l_param) (DimINT (-k))
+            | otherwise = DimVAR l_param
+          substDim (DimVAR v) 
+            | v == l_param && n /= 0 = DimParen (DimDuo "+" (DimVAR v) (DimINT n))
+          substDim (DimDuo bop e1 e2) = DimDuo bop (substDim e1) (substDim e2)
+          substDim (DimParen e1) = DimParen (substDim e1)
+          substDim e1 = e1
+
+getDimOffsets :: [PName] -> [DimExpr] -> [Maybe Int]
+getDimOffsets l_kernelParams dL = 
+    if length dL == length l_kernelParams 
+       then zipWith getDimOffset (tail l_kernelParams) (tail dL)
+       else map (const Nothing) (tail l_kernelParams)
+
+-- in a boundary kernel, l_faces are the spatial dimensions in which the
+-- home cell is within reach of an edge. An access moving along none of 
+-- them stays inside the domain and needs no boundary check
+transFace :: [PName] -> [PName] -> [Int] -> Expr -> Expr
+transFace l_arrayInUse l_kernelParams l_faces (PVAR q v dL) =
+    if elem v l_arrayInUse == True then PVAR q (v ++ l_access) dL
+                                   else PVAR q v dL
+    where l_inside = and $ zipWith inside [0..] $ getDimOffsets l_kernelParams dL
+          inside _ Nothing = False
+          inside d (Just n) = n == 0 || notElem d l_faces
+          l_access = if l_inside then ".interior" else ".boundary"
+transFace _ _ _ e = e
+
 getArrayName :: [PArray] -> [PName]
 getArrayName [] = []
 getArrayName (a:as) = (aName a) : (getArrayName as)
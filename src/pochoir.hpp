@@ -26,11 +26,161 @@
 #ifndef EXPR_STENCIL_HPP
 #define EXPR_STENCIL_HPP
 
+#include <cstring>
+#include <climits>
+#include <unistd.h>
 #include "pochoir_common.hpp"
 #include "pochoir_walk_recursive.hpp"
 #include "pochoir_array.hpp"
+#include "pochoir_soa.hpp"
 /* assuming there won't be more than 10 Pochoir_Array in one Pochoir object! */
 #define ARRAY_SIZE 10
+/* default tuning cache, one line per (machine, stencil, walker) */
+#define TUNE_FILE "pochoir_tune.dat"
+/* # of time steps of each trial run and # of repetitions per candidate */
+#define TUNE_TRIAL_STEPS 16
+#define TUNE_REPEAT 2
+
+/* compare the contents of two snapshots of a Pochoir_Array, 
+ * floating point values are allowed a small relative error because 
+ * the interior and boundary kernels may be compiled differently
+ */
+template <typename T>
+static inline bool tune_equal_elem(T const * _a, T const * _b, size_t _n) {
+    return (memcmp(_a, _b, _n * sizeof(T)) == 0);
+}
+
+template <typename T>
+static inline bool tune_equal_fp(T const * _a, T const * _b, size_t _n) {
+    for (size_t i = 0; i < _n; ++i) {
+        T l_mag = max((T)fabs(_a[i]), (T)fabs(_b[i]));
+        if (fabs(_a[i] - _b[i]) > 1e-6 * max(l_mag, (T)1))
+            return false;
+    }
+    return true;
+}
+
+static inline bool tune_equal_elem(double const * _a, double const * _b, size_t _n) {
+    return tune_equal_fp(_a, _b, _n);
+}
+
+static inline bool tune_equal_elem(float const * _a, float const * _b, size_t _n) {
+    return tune_equal_fp(_a, _b, _n);
+}
+
+template <typename T>
+static bool tune_equal(void const * _a, void const * _b, size_t _n) {
+    return tune_equal_elem((T const *)_a, (T const *)_b, _n);
+}
+
+/* write / fill the halo of a ghost-zone array, see Pochoir_Array::Register_Ghost() */
+template <typename T_Array, int N_RANK>
+static void ghost_push(void * _arr, int _t, grid_info<N_RANK> const & _grid) {
+    static_cast<T_Array *>(_arr)->Push_Ghost(_t, _grid);
+}
+
+template <typename T_Array>
+static void ghost_fill(void * _arr, int _t) {
+    static_cast<T_Array *>(_arr)->Fill_Ghost(_t);
+}
+
+/* mark the file of an array dirty, see Pochoir_Array::Register_File() */
+template <typename T_Array>
+static void file_dirty(void * _arr) {
+    static_cast<T_Array *>(_arr)->Dirty_File();
+}
+
+template <int N_RANK> class Pochoir;
+template <int N_RANK> class Pochoir_Dist;
+
+/* A Pochoir_Plan keeps the walker of the runs of 'timestep' steps, set
+ * up and with its cut tree recorded on the first Run()/Run_Obase() with
+ * the plan, the later ones only replay the base cases. It stays valid as 
+ * long as the domain and the arrays registered with the Pochoir object 
+ * are the same, Reset() makes the next run plan again.
+ * The plan doesn't follow Pipeline_Time() and Numa_Locality().
+ * Flatten() compiles the cut tree into a flat schedule of base-case zoids
+ * and dependency edges, run as a dag without the syncs of the tree. 
+ * Save() writes the schedule out as text, and Load() makes the next run
+ * replay a saved schedule instead of planning. A schedule saved for 
+ * another grid, domain, shape or thresholds is refused.
+ */
+template <int N_RANK>
+class Pochoir_Plan {
+    private:
+        typedef enum {PLAN_NONE, PLAN_RUN, PLAN_OBASE, PLAN_OBASE_BOUNDARY} plan_mode;
+        Algorithm<N_RANK> * algor_;
+        int timestep_;
+        plan_mode mode_;
+        /* toggle of the arrays the plan was made for */
+        int toggle_;
+        void const * owner_;
+        bool flat_;
+        char const * load_file_;
+        /* not copyable, it owns the walker */
+        Pochoir_Plan(Pochoir_Plan<N_RANK> const & _plan);
+        Pochoir_Plan<N_RANK> & operator= (Pochoir_Plan<N_RANK> const & _plan);
+        bool valid(void const * _owner, plan_mode _mode) const { 
+            return algor_ != NULL && owner_ == _owner && mode_ == _mode; 
+        }
+    public:
+        Pochoir_Plan(int _timestep) : algor_(NULL), timestep_(_timestep), mode_(PLAN_NONE), toggle_(0), owner_(NULL), flat_(false), load_file_(NULL) { }
+        ~Pochoir_Plan(void) { delete algor_; }
+        int timestep(void) const { return timestep_; }
+        void Reset(void) { delete algor_; algor_ = NULL; mode_ = PLAN_NONE; owner_ = NULL; }
+        void Flatten(void) { 
+            flat_ = true; 
+            if (algor_ != NULL)
+                algor_->flatten_plan();
+        }
+        void Save(char const * fname);
+        void Load(char const * fname) { Reset(); flat_ = true; load_file_ = fname; }
+        /* record the plan of a fresh walker, or load it */
+        void make(int t0, int t1, grid_info<N_RANK> const & grid, bool boundary, bool obase);
+        friend class Pochoir<N_RANK>;
+};
+
+template <int N_RANK>
+void Pochoir_Plan<N_RANK>::Save(char const * fname) {
+    if (algor_ == NULL) {
+        printf("Pochoir plan error:\n");
+        printf("Nothing to save, run with the plan first!\n");
+        exit(1);
+    }
+    Flatten();
+    FILE * l_fp = fopen(fname, "w");
+    if (l_fp == NULL) {
+        printf("Pochoir plan error:\n");
+        printf("Can't open %s!\n", fname);
+        exit(1);
+    }
+    fprintf(l_fp, "# %d time steps, mode %d, toggle %d\n", timestep_, (int)mode_, toggle_);
+    algor_->save_plan(l_fp);
+    fclose(l_fp);
+}
+
+template <int N_RANK>
+void Pochoir_Plan<N_RANK>::make(int t0, int t1, grid_info<N_RANK> const & grid, bool boundary, bool obase) {
+    if (load_file_ == NULL) {
+        algor_->make_plan(t0, t1, grid, boundary, obase, flat_);
+        return;
+    }
+    FILE * l_fp = fopen(load_file_, "r");
+    int l_timestep = -1, l_mode = -1, l_toggle = -1;
+    bool l_ok = (l_fp != NULL) 
+        && fscanf(l_fp, " # %d time steps, mode %d, toggle %d", &l_timestep, &l_mode, &l_toggle) == 3
+        && l_timestep == timestep_ && l_mode == (int)mode_ && l_toggle == toggle_
+        && algor_->load_plan(l_fp, t0, t1, grid);
+    if (l_fp != NULL)
+        fclose(l_fp);
+    if (!l_ok) {
+        printf("Pochoir plan error:\n");
+        printf("%s is not a plan of %d time steps for this run, its domain, shape or thresholds differ!\n", load_file_, timestep_);
+        exit(1);
+    }
+    load_file_ = NULL;
+}
+
 template <int N_RANK>
 class Pochoir {
     private:
@@ -53,6 +203,64 @@ class Pochoir {
         int shape_size_;
         int num_arr_;
         int arr_type_size_;
+        /* registered arrays, the autotuner saves/restores/compares them */
+        int num_tune_arr_;
+        void * arr_data_[ARRAY_SIZE];
+        size_t arr_len_[ARRAY_SIZE], arr_bytes_[ARRAY_SIZE];
+        bool (*arr_equal_[ARRAY_SIZE])(void const *, void const *, size_t);
+        /* a hash of the strides, halos and planes of the registered arrays */
+        unsigned int layout_hash_;
+        void add_layout(int _v) { layout_hash_ = (layout_hash_ ^ (unsigned int)_v) * 16777619u; }
+        /* autotuning of the base-case thresholds */
+        bool tuneFlag_, tunedFlag_;
+        char const * tune_file_;
+        char const * tuned_walker_;
+        int tune_dt_, tune_dx_[N_RANK];
+        /* pipelined time slabs, and their strips bound to NUMA nodes */
+        bool pipeFlag_, numaFlag_;
+        int pipe_dt_;
+        /* out-of-core sweep, and the rows of the registered arrays it
+         * pages in and out
+         */
+        bool oocFlag_;
+        size_t ooc_budget_;
+        int num_ooc_arr_;
+        char * ooc_data_[ARRAY_SIZE];
+        size_t ooc_plane_[ARRAY_SIZE], ooc_row_[ARRAY_SIZE];
+        int ooc_toggle_[ARRAY_SIZE], ooc_rows_[ARRAY_SIZE];
+        void add_ooc_arr(char * data, size_t plane, size_t row, int toggle, int rows);
+        void ooc_advise(int r0, int r1, bool need);
+        int ooc_rows(void) const;
+        /* base-case zoids swept as a wavefront of slabs (Pochoir_Wavefront) */
+        bool waveFlag_;
+        int wave_dt_, wave_rows_;
+        void setWave(Algorithm<N_RANK> & algor);
+        template <typename F>
+        Pochoir_Wavefront<N_RANK, F> wavefront(F const & f) const;
+        void add_tune_arr(void * data, size_t len, size_t bytes, bool (*equal)(void const *, void const *, size_t));
+        /* registered arrays with a ghost zone, all or none of them */
+        int num_ghost_arr_;
+        bool regPlainArrayFlag;
+        void * ghost_arr_[ARRAY_SIZE];
+        typename Algorithm<N_RANK>::ghost_fn ghost_fn_[ARRAY_SIZE];
+        void (*ghost_fill_fn_[ARRAY_SIZE])(void *, int);
+        void add_ghost_arr(void * arr, typename Algorithm<N_RANK>::ghost_fn fn, void (*fill_fn)(void *, int));
+        /* registered arrays mapped from a file, marked dirty by a run */
+        int num_file_arr_;
+        void * file_arr_[ARRAY_SIZE];
+        void (*file_dirty_fn_[ARRAY_SIZE])(void *);
+        void dirtyFiles(void);
+        void setGhost(Algorithm<N_RANK> & algor);
+        void tune_key(char * key, int key_size, char const * walker);
+        bool load_tune(char const * key);
+        void save_tune(char const * key);
+        template <typename G>
+        double tune_trial(Algorithm<N_RANK> & algor, int trial, G const & g, void * const * init);
+        template <typename G>
+        void tune_thres(char const * walker, int timestep, Algorithm<N_RANK> & algor, G const & g);
+        Algorithm<N_RANK> & setPlan(Pochoir_Plan<N_RANK> & plan, int mode);
+        /* Pochoir_Dist runs the walker of the rank over slabs of zoids */
+        friend class Pochoir_Dist<N_RANK>;
 
     public:
     template <size_t N_SIZE>
@@ -68,11 +276,35 @@ class Pochoir {
         regShapeFlag = true;
         num_arr_ = 0;
         arr_type_size_ = 0;
+        num_tune_arr_ = 0;
+        layout_hash_ = 2166136261u;
+        num_ghost_arr_ = 0;
+        num_file_arr_ = 0;
+        regPlainArrayFlag = false;
+        tuneFlag_ = tunedFlag_ = false;
+        tune_file_ = TUNE_FILE;
+        tuned_walker_ = NULL;
+        pipeFlag_ = numaFlag_ = false;
+        pipe_dt_ = 0;
+        oocFlag_ = false;
+        ooc_budget_ = 0;
+        num_ooc_arr_ = 0;
+        waveFlag_ = false;
+        wave_dt_ = wave_rows_ = 0;
     }
     /* currently, we just compute the slope[] out of the shape[] */
     /* We get the grid_info out of arrayInUse */
-    template <typename T>
-    void Register_Array(Pochoir_Array<T, N_RANK> & arr);
+    template <typename T, int N_TOGGLE, typename BF>
+    void Register_Array(Pochoir_Array<T, N_RANK, N_TOGGLE, BF> & arr);
+    template <typename T, typename BF>
+    void Register_Array(Pochoir_SoA_Array<T, N_RANK, BF> & arr);
+    /* register an array with the entries of the shape[] reading it,
+     * so that it keeps only the live time planes 
+     */
+    template <typename T, int N_TOGGLE, typename BF, size_t N_SIZE>
+    void Register_Array(Pochoir_Array<T, N_RANK, N_TOGGLE, BF> & arr, Pochoir_Shape<N_RANK> (& shape)[N_SIZE]);
+    template <typename T, typename BF, size_t N_SIZE>
+    void Register_Array(Pochoir_SoA_Array<T, N_RANK, BF> & arr, Pochoir_Shape<N_RANK> (& shape)[N_SIZE]);
 
     /* We should still keep the Register_Domain for zero-padding!!! */
     template <typename Domain>
@@ -98,6 +330,49 @@ class Pochoir {
         arr.Register_Boundary(_bv);
         Register_Array(arr);
     } 
+    /* Auto_Tune() makes the following Run()/Run_Obase() search the base-case
+     * thresholds on a few short trial runs over the registered arrays, 
+     * the best ones are kept in the cache file 'fname' for later runs.
+     * The trial runs don't change the content of the registered arrays.
+     */
+    void Auto_Tune(char const * fname = TUNE_FILE) { 
+        tuneFlag_ = true; tunedFlag_ = false; tune_file_ = fname; 
+    }
+    /* Pipeline_Time() makes the following Run(timestep, f, bf)/Run_Obase()
+     * cut the time steps into slabs of 'dt' steps (0 picks it from the
+     * number of workers), a zoid of an upper slab starts as soon as the 
+     * zoids of the lower slab in its dependence cone are done.
+     */
+    void Pipeline_Time(int dt = 0) {
+        pipeFlag_ = true; pipe_dt_ = dt;
+    }
+    /* Numa_Locality() makes the following Run(timestep, f, bf)/Run_Obase()
+     * cut the grid along the outermost dimension into top-level zoids, and 
+     * give each one to the group of workers on the NUMA node which first 
+     * touched its pages (see Pochoir_Alloc), stealing within the group 
+     * first. It pipelines the time slabs as Pipeline_Time() does, the 
+     * groups only exist on the thread pool backend (pochoir_parallel.hpp).
+     */
+    void Numa_Locality(void) { numaFlag_ = true; }
+    /* Out_Of_Core() makes the following Run(timestep, f, bf)/Run_Obase()
+     * sweep the grid in time slabs, strip by strip along the outermost 
+     * dimension, with the strips and the slab height picked so that the 
+     * strips being computed, and the next one being paged in, fit in 
+     * 'budget' bytes of the registered arrays. Meant for arrays allocated
+     * by Pochoir_Alloc_File (see Pochoir_Alloc), whose pages are hinted in
+     * before a strip runs and written back after.
+     */
+    void Out_Of_Core(size_t budget) { oocFlag_ = true; ooc_budget_ = budget; }
+    /* Temporal_Block() makes the following Run_Obase() run each base-case
+     * zoid of 'dt' time steps (0 keeps the walker's) as a wavefront of 
+     * slabs of 'rows' rows of the outermost dimension (0 picks them from 
+     * the bytes of the registered arrays per row), each slab taking all the
+     * time steps of the zoid while it is in cache. The base-case zoids are
+     * let grow along the outermost dimension to hold a few slabs.
+     */
+    void Temporal_Block(int dt = 0, int rows = 0) {
+        waveFlag_ = true; wave_dt_ = dt; wave_rows_ = rows;
+    }
     /* Executable Spec */
     template <typename BF>
     void Run(int timestep, BF const & bf);
@@ -110,6 +385,13 @@ class Pochoir {
     /* obase for interior and ExecSpec for boundary */
     template <typename F, typename BF>
     void Run_Obase(int timestep, F const & f, BF const & bf);
+    /* the same, over plan.timestep() steps, replaying the plan */
+    template <typename F, typename BF>
+    void Run(Pochoir_Plan<N_RANK> & plan, F const & f, BF const & bf);
+    template <typename F>
+    void Run_Obase(Pochoir_Plan<N_RANK> & plan, F const & f);
+    template <typename F, typename BF>
+    void Run_Obase(Pochoir_Plan<N_RANK> & plan, F const & f, BF const & bf);
 };
 
 template <int N_RANK>
@@ -130,6 +412,13 @@ void Pochoir<N_RANK>::checkFlags(void) {
     return;
 }
 
+/* a run is about to write the planes of the arrays mapped from files */
+template <int N_RANK>
+void Pochoir<N_RANK>::dirtyFiles(void) {
+    for (int k = 0; k < num_file_arr_; ++k)
+        file_dirty_fn_[k](file_arr_[k]);
+}
+
 template <int N_RANK> template <typename T_Array> 
 void Pochoir<N_RANK>::getPhysDomainFromArray(T_Array & arr) {
     /* get the physical grid */
@@ -157,8 +446,8 @@ void Pochoir<N_RANK>::cmpPhysDomainFromArray(T_Array & arr) {
     }
 }
 
-template <int N_RANK> template <typename T>
-void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK> & arr) {
+template <int N_RANK> template <typename T, int N_TOGGLE, typename BF>
+void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK, N_TOGGLE, BF> & arr) {
     if (!regShapeFlag) {
         cout << "Please register Shape before register Array!" << endl;
         exit(1);
@@ -177,6 +466,23 @@ void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK> & arr) {
         cmpPhysDomainFromArray(arr);
     }
     arr.Register_Shape(shape_, shape_size_);
+    size_t l_len = (size_t)arr.toggle() * arr.total_size();
+    for (int i = 0; i < N_RANK; ++i) {
+        add_layout(arr.stride(i));
+        add_layout(arr.ghost(i));
+    }
+    add_layout(arr.toggle());
+    add_tune_arr((void *)arr.view()->data(), l_len, l_len * sizeof(T), &tune_equal<T>);
+    add_ooc_arr((char *)arr.rows(0, 0), (size_t)arr.total_size() * sizeof(T), (size_t)arr.row_size() * sizeof(T), arr.toggle(), arr.size(N_RANK-1));
+    if (arr.file() != NULL && num_file_arr_ < ARRAY_SIZE) {
+        file_arr_[num_file_arr_] = (void *)&arr;
+        file_dirty_fn_[num_file_arr_] = &file_dirty<Pochoir_Array<T, N_RANK, N_TOGGLE, BF> >;
+        ++num_file_arr_;
+    }
+    if (arr.ghost())
+        add_ghost_arr((void *)&arr, &ghost_push<Pochoir_Array<T, N_RANK, N_TOGGLE, BF>, N_RANK>, &ghost_fill<Pochoir_Array<T, N_RANK, N_TOGGLE, BF> >);
+    else
+        regPlainArrayFlag = true;
 #if 0
     arr.set_slope(slope_);
     arr.set_toggle(toggle_);
@@ -185,6 +491,199 @@ void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK> & arr) {
     regArrayFlag = true;
 }
 
+/* the field planes of a SoA array are saved/compared bytewise by the autotuner */
+template <int N_RANK> template <typename T, typename BF>
+void Pochoir<N_RANK>::Register_Array(Pochoir_SoA_Array<T, N_RANK, BF> & arr) {
+    if (!regShapeFlag) {
+        cout << "Please register Shape before register Array!" << endl;
+        exit(1);
+    }
+
+    if (num_arr_ == 0) {
+        arr_type_size_ = sizeof(T);
+        ++num_arr_;
+    } 
+    if (!regPhysDomainFlag) {
+        getPhysDomainFromArray(arr);
+    } else {
+        cmpPhysDomainFromArray(arr);
+    }
+    arr.Register_Shape(shape_, shape_size_);
+    for (int i = 0; i < N_RANK; ++i)
+        add_layout(arr.stride(i));
+    add_layout(arr.toggle());
+    add_tune_arr((void *)arr.data(), arr.bytes(), arr.bytes(), &tune_equal<char>);
+    regPlainArrayFlag = true;
+    regArrayFlag = true;
+}
+
+/* the home time shift of the stencil is the latest one in its shape[] */
+template <int N_RANK> template <typename T, int N_TOGGLE, typename BF, size_t N_SIZE>
+void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK, N_TOGGLE, BF> & arr, Pochoir_Shape<N_RANK> (& shape)[N_SIZE]) {
+    if (!regShapeFlag) {
+        cout << "Please register Shape before register Array!" << endl;
+        exit(1);
+    }
+    arr.Register_Liveness(shape, N_SIZE, toggle_ - 1 - time_shift_);
+    Register_Array(arr);
+}
+
+template <int N_RANK> template <typename T, typename BF, size_t N_SIZE>
+void Pochoir<N_RANK>::Register_Array(Pochoir_SoA_Array<T, N_RANK, BF> & arr, Pochoir_Shape<N_RANK> (& shape)[N_SIZE]) {
+    if (!regShapeFlag) {
+        cout << "Please register Shape before register Array!" << endl;
+        exit(1);
+    }
+    arr.Register_Liveness(shape, N_SIZE, toggle_ - 1 - time_shift_);
+    Register_Array(arr);
+}
+
+/* record a registered array for the autotuner, once per buffer */
+template <int N_RANK>
+void Pochoir<N_RANK>::add_tune_arr(void * data, size_t len, size_t bytes, bool (*equal)(void const *, void const *, size_t)) {
+    int l_arr;
+    for (l_arr = 0; l_arr < num_tune_arr_; ++l_arr) {
+        if (arr_data_[l_arr] == data)
+            return;
+    }
+    if (num_tune_arr_ < ARRAY_SIZE) {
+        arr_data_[l_arr] = data;
+        arr_len_[l_arr] = len;
+        arr_bytes_[l_arr] = bytes;
+        arr_equal_[l_arr] = equal;
+        ++num_tune_arr_;
+    }
+}
+
+/* record a registered array for Out_Of_Core(), once per buffer */
+template <int N_RANK>
+void Pochoir<N_RANK>::add_ooc_arr(char * data, size_t plane, size_t row, int toggle, int rows) {
+    for (int k = 0; k < num_ooc_arr_; ++k) {
+        if (ooc_data_[k] == data)
+            return;
+    }
+    if (num_ooc_arr_ < ARRAY_SIZE) {
+        ooc_data_[num_ooc_arr_] = data;
+        ooc_plane_[num_ooc_arr_] = plane;
+        ooc_row_[num_ooc_arr_] = row;
+        ooc_toggle_[num_ooc_arr_] = toggle;
+        ooc_rows_[num_ooc_arr_] = rows;
+        ++num_ooc_arr_;
+    }
+}
+
+/* the rows of the outermost dimension whose time planes, in all the 
+ * registered arrays, fit the budget of Out_Of_Core()
+ */
+template <int N_RANK>
+int Pochoir<N_RANK>::ooc_rows(void) const {
+    size_t l_bytes = 0;
+    for (int k = 0; k < num_ooc_arr_; ++k)
+        l_bytes += ooc_toggle_[k] * ooc_row_[k];
+    if (l_bytes == 0 || ooc_budget_ / l_bytes > (size_t)INT_MAX)
+        return INT_MAX;
+    return max((int)(ooc_budget_ / l_bytes), 1);
+}
+
+/* page the rows [r0, r1) of every time plane in ahead of time (need), or
+ * start writing them back and let the OS reclaim them (!need). Only whole
+ * pages within the rows are handed back.
+ */
+template <int N_RANK>
+void Pochoir<N_RANK>::ooc_advise(int r0, int r1, bool need) {
+    size_t const l_page = sysconf(_SC_PAGESIZE);
+    for (int k = 0; k < num_ooc_arr_; ++k) {
+        int const l_r0 = max(r0, 0), l_r1 = min(r1, ooc_rows_[k]);
+        if (l_r0 >= l_r1)
+            continue;
+        for (int q = 0; q < ooc_toggle_[k]; ++q) {
+            size_t l_begin = (size_t)(ooc_data_[k] + q * ooc_plane_[k] + l_r0 * ooc_row_[k]);
+            size_t l_end = l_begin + (l_r1 - l_r0) * ooc_row_[k];
+            if (need) {
+                l_begin = l_begin / l_page * l_page;
+                madvise((void *)l_begin, l_end - l_begin, MADV_WILLNEED);
+                continue;
+            }
+            l_begin = (l_begin + l_page - 1) / l_page * l_page;
+            l_end = l_end / l_page * l_page;
+            if (l_begin >= l_end)
+                continue;
+            msync((void *)l_begin, l_end - l_begin, MS_ASYNC);
+#ifdef MADV_PAGEOUT
+            madvise((void *)l_begin, l_end - l_begin, MADV_PAGEOUT);
+#endif
+        }
+    }
+}
+
+template <int N_RANK>
+void Pochoir<N_RANK>::add_ghost_arr(void * arr, typename Algorithm<N_RANK>::ghost_fn fn, void (*fill_fn)(void *, int)) {
+    for (int k = 0; k < num_ghost_arr_; ++k) {
+        if (ghost_arr_[k] == arr)
+            return;
+    }
+    if (num_ghost_arr_ >= ARRAY_SIZE) {
+        printf("Pochoir registration error:\n");
+        printf("More than %d arrays with a ghost zone!\n", ARRAY_SIZE);
+        exit(1);
+    }
+    ghost_arr_[num_ghost_arr_] = arr;
+    ghost_fn_[num_ghost_arr_] = fn;
+    ghost_fill_fn_[num_ghost_arr_] = fill_fn;
+    ++num_ghost_arr_;
+}
+
+/* boundary zoids run the interior kernel only if every array has a halo */
+template <int N_RANK>
+void Pochoir<N_RANK>::setGhost(Algorithm<N_RANK> & algor) {
+    if (num_ghost_arr_ == 0)
+        return;
+    if (regPlainArrayFlag) {
+        printf("Pochoir registration error:\n");
+        printf("Arrays with and without a ghost zone are registered with the same Pochoir object!\n");
+        exit(1);
+    }
+    /* the halo is as wide as the farthest spatial shift of the shape */
+    int l_width[N_RANK];
+    for (int r = 0; r < N_RANK; ++r) {
+        l_width[r] = 0;
+        for (int i = 0; i < shape_size_; ++i)
+            l_width[r] = max(l_width[r], abs(shape_[i].shift[N_RANK-r]));
+    }
+    for (int k = 0; k < num_ghost_arr_; ++k)
+        ghost_fill_fn_[k](ghost_arr_[k], 0+time_shift_);
+    algor.set_ghost(num_ghost_arr_, ghost_arr_, ghost_fn_, l_width);
+}
+
+/* the wavefront base case runs zoids of wave_dt_ steps, wide enough along
+ * the outermost dimension for the two leaning ends and WAVE_SLABS slabs
+ */
+template <int N_RANK>
+void Pochoir<N_RANK>::setWave(Algorithm<N_RANK> & algor) {
+    if (!waveFlag_)
+        return;
+    int l_dx[N_RANK];
+    int const l_dt = (wave_dt_ > 0) ? wave_dt_ : algor.dt_thres();
+    for (int i = 0; i < N_RANK; ++i)
+        l_dx[i] = algor.dx_thres(i);
+    l_dx[N_RANK-1] = max(l_dx[N_RANK-1], 2 * slope_[N_RANK-1] * (toggle_ - 1) * l_dt + WAVE_SLABS * max(wave_rows_, 1));
+    algor.set_thres(l_dt, l_dx);
+}
+
+/* wrap the obase kernel, the cuts of a slab lean by the slope of the 
+ * outermost dimension for each time plane an array keeps; without 
+ * Temporal_Block() the wrapper just calls 'f'
+ */
+template <int N_RANK> template <typename F>
+Pochoir_Wavefront<N_RANK, F> Pochoir<N_RANK>::wavefront(F const & f) const {
+    size_t l_bytes = 0, l_points = 1;
+    for (int k = 0; k < num_tune_arr_; ++k)
+        l_bytes += arr_bytes_[k];
+    for (int i = 0; i < N_RANK; ++i)
+        l_points *= phys_grid_.x1[i] - phys_grid_.x0[i];
+    return Pochoir_Wavefront<N_RANK, F>(f, wave_rows_, waveFlag_ ? slope_[N_RANK-1] * (toggle_ - 1) : 0, max(l_bytes / max(l_points, (size_t)1), (size_t)1));
+}
+
 template <int N_RANK> template <size_t N_SIZE>
 void Pochoir<N_RANK>::Register_Shape(Pochoir_Shape<N_RANK> (& shape)[N_SIZE]) {
     /* currently we just get the slope_[] and toggle_ out of the shape[] */
@@ -331,6 +830,186 @@ void Pochoir<N_RANK>::Register_Domain(Domain const & r_i) {
     regLogicDomainFlag = true;
 }
 
+/* the key of the tuning cache : machine, walker, element size, 
+ * # of workers, a hash of the shape, a hash of the layout of the arrays
+ * (padding, ghost zone, live planes) and of the modes of the run 
+ * (Temporal_Block, Pipeline_Time, Numa_Locality), and the logic domain
+ */
+template <int N_RANK>
+void Pochoir<N_RANK>::tune_key(char * key, int key_size, char const * walker) {
+    char l_host[64];
+    unsigned int l_hash = 2166136261u;
+    int l_len;
+
+    if (gethostname(l_host, sizeof(l_host)) != 0)
+        strcpy(l_host, "unknown");
+    l_host[sizeof(l_host)-1] = '\0';
+    for (int i = 0; i < shape_size_; ++i) {
+        for (int r = 0; r < N_RANK+1; ++r) {
+            l_hash = (l_hash ^ (unsigned int)shape_[i].shift[r]) * 16777619u;
+        }
+    }
+    unsigned int l_mode = layout_hash_;
+    int const l_modes[] = { waveFlag_, wave_dt_, wave_rows_, pipeFlag_, pipe_dt_, numaFlag_ };
+    for (int k = 0; k < (int)(sizeof(l_modes) / sizeof(l_modes[0])); ++k)
+        l_mode = (l_mode ^ (unsigned int)l_modes[k]) * 16777619u;
+    l_len = snprintf(key, key_size, "%s:%dD:%s:%d:%d:%08x:%08x:", l_host, N_RANK, walker, arr_type_size_, pochoir_max_workers(), l_hash, l_mode);
+    for (int i = N_RANK-1; i >= 0 && l_len < key_size; --i) {
+        l_len += snprintf(key + l_len, key_size - l_len, (i > 0) ? "%dx" : "%d", logic_grid_.x1[i] - logic_grid_.x0[i]);
+    }
+}
+
+/* each line of the tuning cache is : key dt dx[N_RANK-1] ... dx[0],
+ * the last matching line wins
+ */
+template <int N_RANK>
+bool Pochoir<N_RANK>::load_tune(char const * key) {
+    char l_line[1024], l_key[512];
+    int l_dt, l_dx[N_RANK], l_pos, l_n, i;
+    bool l_found = false;
+    FILE * fp = fopen(tune_file_, "r");
+
+    if (fp == NULL)
+        return false;
+    while (fgets(l_line, sizeof(l_line), fp) != NULL) {
+        if (sscanf(l_line, "%511s %d%n", l_key, &l_dt, &l_pos) != 2 || strcmp(l_key, key) != 0)
+            continue;
+        for (i = N_RANK-1; i >= 0; --i) {
+            if (sscanf(l_line + l_pos, "%d%n", &l_dx[i], &l_n) != 1)
+                break;
+            l_pos += l_n;
+        }
+        if (i >= 0 || l_dt < 1)
+            continue;
+        tune_dt_ = l_dt;
+        for (i = 0; i < N_RANK; ++i)
+            tune_dx_[i] = max(1, l_dx[i]);
+        l_found = true;
+    }
+    fclose(fp);
+    return l_found;
+}
+
+template <int N_RANK>
+void Pochoir<N_RANK>::save_tune(char const * key) {
+    FILE * fp = fopen(tune_file_, "a");
+
+    if (fp == NULL) {
+        printf("Pochoir autotuner: can't write tuning cache %s!\n", tune_file_);
+        return;
+    }
+    fprintf(fp, "%s %d", key, tune_dt_);
+    for (int i = N_RANK-1; i >= 0; --i)
+        fprintf(fp, " %d", tune_dx_[i]);
+    fprintf(fp, "\n");
+    fclose(fp);
+}
+
+/* one trial run from the saved initial content, returns the best time */
+template <int N_RANK> template <typename G>
+double Pochoir<N_RANK>::tune_trial(Algorithm<N_RANK> & algor, int trial, G const & g, void * const * init) {
+    struct timeval l_start, l_end;
+    double l_best = INF;
+
+    for (int r = 0; r < TUNE_REPEAT; ++r) {
+        for (int k = 0; k < num_tune_arr_; ++k)
+            memcpy(arr_data_[k], init[k], arr_bytes_[k]);
+        gettimeofday(&l_start, 0);
+        pochoir_region([&]() { g(algor, trial); });
+        gettimeofday(&l_end, 0);
+        l_best = min(l_best, tdiff(&l_end, &l_start));
+    }
+    return l_best;
+}
+
+/* search the thresholds by coordinate descent, first dt, then dx from the
+ * outermost dimension, each over 1/4x .. 4x of the best value so far.
+ * A candidate is rejected if its result differs from the one of the 
+ * default thresholds. Every setting gets the minimum widths of 
+ * Temporal_Block() on top. Arrays out of core or mapped from a file are
+ * not copied for the trials : they only take thresholds from the cache.
+ */
+template <int N_RANK> template <typename G>
+void Pochoir<N_RANK>::tune_thres(char const * walker, int timestep, Algorithm<N_RANK> & algor, G const & g) {
+    char l_key[512];
+    int const l_trial = min(timestep, TUNE_TRIAL_STEPS);
+
+    if (tunedFlag_ && strcmp(tuned_walker_, walker) == 0) {
+        algor.set_thres(tune_dt_, tune_dx_);
+        setWave(algor);
+        return;
+    }
+    if (l_trial <= 0)
+        return;
+    tune_key(l_key, sizeof(l_key), walker);
+    if (!load_tune(l_key)) {
+        if (oocFlag_ || num_file_arr_ > 0)
+            return;
+        void * l_init[ARRAY_SIZE], * l_ref[ARRAY_SIZE];
+        int l_dt = algor.dt_thres(), l_dx[N_RANK];
+        double l_best;
+
+        for (int i = 0; i < N_RANK; ++i)
+            l_dx[i] = algor.dx_thres(i);
+        for (int k = 0; k < num_tune_arr_; ++k) {
+            l_init[k] = malloc(arr_bytes_[k]);
+            l_ref[k] = malloc(arr_bytes_[k]);
+            if (l_init[k] == NULL || l_ref[k] == NULL) {
+                printf("Pochoir autotuner: out of memory!\n");
+                exit(1);
+            }
+            memcpy(l_init[k], arr_data_[k], arr_bytes_[k]);
+        }
+        l_best = tune_trial(algor, l_trial, g, l_init);
+        for (int k = 0; k < num_tune_arr_; ++k)
+            memcpy(l_ref[k], arr_data_[k], arr_bytes_[k]);
+        for (int p = N_RANK; p >= 0; --p) {
+            int * l_param = (p == N_RANK) ? &l_dt : &l_dx[p];
+            int const l_center = *l_param;
+            int l_best_v = l_center, l_prev = 0;
+            for (int c = 0; c < 5; ++c) {
+                int l_v = max(1, (c < 2) ? (l_center >> (2 - c)) : (l_center << (c - 2)));
+                if (l_v == l_center || l_v == l_prev)
+                    continue;
+                l_prev = l_v;
+                *l_param = l_v;
+                algor.set_thres(l_dt, l_dx);
+                setWave(algor);
+                double l_time = tune_trial(algor, l_trial, g, l_init);
+                bool l_match = true;
+                for (int k = 0; k < num_tune_arr_; ++k)
+                    l_match = l_match && arr_equal_[k](arr_data_[k], l_ref[k], arr_len_[k]);
+                if (!l_match) {
+                    printf("Pochoir autotuner: threshold %d of dim %d changed the result, skipped!\n", l_v, p);
+                } else if (l_time < l_best) {
+                    l_best = l_time;
+                    l_best_v = l_v;
+                }
+            }
+            *l_param = l_best_v;
+        }
+        for (int k = 0; k < num_tune_arr_; ++k) {
+            memcpy(arr_data_[k], l_init[k], arr_bytes_[k]);
+            free(l_init[k]);
+            free(l_ref[k]);
+        }
+        tune_dt_ = l_dt;
+        for (int i = 0; i < N_RANK; ++i)
+            tune_dx_[i] = l_dx[i];
+        save_tune(l_key);
+    }
+#if DEBUG
+    printf("tuned thresholds for %s : dt = %d", l_key, tune_dt_);
+    for (int i = N_RANK-1; i >= 0; --i)
+        printf(", dx[%d] = %d", i, tune_dx_[i]);
+    printf("\n");
+#endif
+    tunedFlag_ = true;
+    tuned_walker_ = walker;
+    algor.set_thres(tune_dt_, tune_dx_);
+    setWave(algor);
+}
+
 /* Executable Spec */
 template <int N_RANK> template <typename BF>
 void Pochoir<N_RANK>::Run(int timestep, BF const & bf) {
@@ -344,6 +1023,7 @@ void Pochoir<N_RANK>::Run(int timestep, BF const & bf) {
     /* base_case_kernel() will mimic exact the behavior of serial nested loop!
     */
     checkFlags();
+    dirtyFiles();
     inRun = true;
     algor.base_case_kernel_boundary(0 + time_shift_, timestep + time_shift_, logic_grid_, bf);
     inRun = false;
@@ -365,15 +1045,27 @@ void Pochoir<N_RANK>::Run(int timestep, F const & f, BF const & bf) {
      */
     timestep_ = timestep;
     checkFlags();
+    dirtyFiles();
+    setGhost(algor);
 #pragma isat marker M2_begin
 #if BICUT
 #if 1
-    algor.walk_bicut_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
+    if (tuneFlag_)
+        tune_thres("walk_bicut_boundary_p", timestep, algor, [&](Algorithm<N_RANK> & l_algor, int l_timestep) {
+            l_algor.walk_bicut_boundary_p(0+time_shift_, l_timestep+time_shift_, logic_grid_, f, bf); });
+    if (oocFlag_)
+        pochoir_region([&]() { algor.stream_time(0+time_shift_, timestep+time_shift_, logic_grid_, true, ooc_rows(), toggle_ - 1, [&](int l_t0, int l_t1, grid_info<N_RANK> const & l_grid) {
+            algor.walk_bicut_boundary_p(l_t0, l_t1, l_grid, f, bf); }, [&](int l_r0, int l_r1, bool l_need) { ooc_advise(l_r0, l_r1, l_need); }); });
+    else if (pipeFlag_ || numaFlag_)
+        pochoir_region([&]() { algor.pipeline_time(0+time_shift_, timestep+time_shift_, logic_grid_, true, pipe_dt_, toggle_ - 1, numaFlag_ ? pochoir_num_groups() : 1, [&](int l_t0, int l_t1, grid_info<N_RANK> const & l_grid) {
+            algor.walk_bicut_boundary_p(l_t0, l_t1, l_grid, f, bf); }); });
+    else
+        pochoir_region([&]() { algor.walk_bicut_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf); });
 #else
-    algor.sim_bicut_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
+    pochoir_region([&]() { algor.sim_bicut_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf); });
 #endif
 #else
-    algor.walk_ncores_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
+    pochoir_region([&]() { algor.walk_ncores_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf); });
 #endif
 #pragma isat marker M2_end
 }
@@ -386,11 +1078,14 @@ void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f) {
     algor.set_thres(arr_type_size_);
     timestep_ = timestep;
     checkFlags();
+    dirtyFiles();
+    setWave(algor);
+    Pochoir_Wavefront<N_RANK, F> const l_f = wavefront(f);
 #if BICUT
 #if 0
     fprintf(stderr, "Call obase_bicut\n");
 #pragma isat marker M2_begin
-    algor.obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, f);
+    pochoir_region([&]() { algor.obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, l_f); });
 #pragma isat marker M2_end
 #else
 //     fprintf(stderr, "Call shorter_duo_sim_obase_bicut\n");
@@ -398,10 +1093,20 @@ void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f) {
    // algor.sim_obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, f);
 #if 1
     // printf("shorter_duo_sim_obase_bicut!\n");
-    algor.shorter_duo_sim_obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, f);
+    if (tuneFlag_)
+        tune_thres("shorter_duo_sim_obase_bicut", timestep, algor, [&](Algorithm<N_RANK> & l_algor, int l_timestep) {
+            l_algor.shorter_duo_sim_obase_bicut(0+time_shift_, l_timestep+time_shift_, logic_grid_, l_f); });
+    if (oocFlag_)
+        pochoir_region([&]() { algor.stream_time(0+time_shift_, timestep+time_shift_, logic_grid_, false, ooc_rows(), toggle_ - 1, [&](int l_t0, int l_t1, grid_info<N_RANK> const & l_grid) {
+            algor.shorter_duo_sim_obase_bicut(l_t0, l_t1, l_grid, l_f); }, [&](int l_r0, int l_r1, bool l_need) { ooc_advise(l_r0, l_r1, l_need); }); });
+    else if (pipeFlag_ || numaFlag_)
+        pochoir_region([&]() { algor.pipeline_time(0+time_shift_, timestep+time_shift_, logic_grid_, false, pipe_dt_, toggle_ - 1, numaFlag_ ? pochoir_num_groups() : 1, [&](int l_t0, int l_t1, grid_info<N_RANK> const & l_grid) {
+            algor.shorter_duo_sim_obase_bicut(l_t0, l_t1, l_grid, l_f); }); });
+    else
+        pochoir_region([&]() { algor.shorter_duo_sim_obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, l_f); });
 #else
     printf("stevenj!\n");
-    algor.stevenj(0+time_shift_, timestep+time_shift_, logic_grid_, f);
+    pochoir_region([&]() { algor.stevenj(0+time_shift_, timestep+time_shift_, logic_grid_, l_f); });
 #endif
     // algor.duo_sim_obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, f);
 #pragma isat marker M2_end
@@ -412,7 +1117,7 @@ void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f) {
 #endif
 #endif
 #else
-    algor.obase_m(0+time_shift_, timestep+time_shift_, logic_grid_, f);
+    pochoir_region([&]() { algor.obase_m(0+time_shift_, timestep+time_shift_, logic_grid_, l_f); });
 #endif
 }
 
@@ -428,21 +1133,35 @@ void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f, BF const & bf) {
      */
     timestep_ = timestep;
     checkFlags();
+    dirtyFiles();
+    setGhost(algor);
+    setWave(algor);
+    Pochoir_Wavefront<N_RANK, F> const l_f = wavefront(f);
 #if BICUT
 #if 0
     fprintf(stderr, "Call obase_bicut_boundary_P\n");
 #pragma isat marker M2_begin
-    algor.obase_bicut_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
+    pochoir_region([&]() { algor.obase_bicut_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, l_f, bf); });
 #pragma isat marker M2_end
 #else
 //    fprintf(stderr, "Call sim_obase_bicut_P\n");
 #pragma isat marker M2_begin
 #if 1
     // printf("shorter_duo_sim_obase_bicut_p!\n");
-    algor.shorter_duo_sim_obase_bicut_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
+    if (tuneFlag_)
+        tune_thres("shorter_duo_sim_obase_bicut_p", timestep, algor, [&](Algorithm<N_RANK> & l_algor, int l_timestep) {
+            l_algor.shorter_duo_sim_obase_bicut_p(0+time_shift_, l_timestep+time_shift_, logic_grid_, l_f, bf); });
+    if (oocFlag_)
+        pochoir_region([&]() { algor.stream_time(0+time_shift_, timestep+time_shift_, logic_grid_, true, ooc_rows(), toggle_ - 1, [&](int l_t0, int l_t1, grid_info<N_RANK> const & l_grid) {
+            algor.shorter_duo_sim_obase_bicut_p(l_t0, l_t1, l_grid, l_f, bf); }, [&](int l_r0, int l_r1, bool l_need) { ooc_advise(l_r0, l_r1, l_need); }); });
+    else if (pipeFlag_ || numaFlag_)
+        pochoir_region([&]() { algor.pipeline_time(0+time_shift_, timestep+time_shift_, logic_grid_, true, pipe_dt_, toggle_ - 1, numaFlag_ ? pochoir_num_groups() : 1, [&](int l_t0, int l_t1, grid_info<N_RANK> const & l_grid) {
+            algor.shorter_duo_sim_obase_bicut_p(l_t0, l_t1, l_grid, l_f, bf); }); });
+    else
+        pochoir_region([&]() { algor.shorter_duo_sim_obase_bicut_p(0+time_shift_, timestep+time_shift_, logic_grid_, l_f, bf); });
 #else
     printf("stevenj_p!\n");
-    algor.stevenj_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
+    pochoir_region([&]() { algor.stevenj_p(0+time_shift_, timestep+time_shift_, logic_grid_, l_f, bf); });
 #endif
 #pragma isat marker M2_end
 #if STAT
@@ -453,9 +1172,100 @@ void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f, BF const & bf) {
 #endif
 #else
 #pragma isat marker M2_begin
-    algor.obase_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
+    pochoir_region([&]() { algor.obase_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, l_f, bf); });
 #pragma isat marker M2_end
 #endif
 }
 
+/* set up the walker of a plan as Run()/Run_Obase() do, the cut tree is
+ * recorded by the caller
+ */
+template <int N_RANK>
+Algorithm<N_RANK> & Pochoir<N_RANK>::setPlan(Pochoir_Plan<N_RANK> & plan, int mode) {
+    plan.Reset();
+    plan.algor_ = new Algorithm<N_RANK>(slope_);
+    plan.mode_ = (typename Pochoir_Plan<N_RANK>::plan_mode)mode;
+    plan.toggle_ = toggle_;
+    plan.owner_ = this;
+    Algorithm<N_RANK> & algor = *plan.algor_;
+    algor.set_phys_grid(phys_grid_);
+    algor.set_thres(arr_type_size_);
+    timestep_ = plan.timestep_;
+    checkFlags();
+    dirtyFiles();
+    return algor;
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Run(Pochoir_Plan<N_RANK> & plan, F const & f, BF const & bf) {
+    int const timestep = plan.timestep();
+    if (!plan.valid(this, Pochoir_Plan<N_RANK>::PLAN_RUN)) {
+        Algorithm<N_RANK> & l_algor = setPlan(plan, Pochoir_Plan<N_RANK>::PLAN_RUN);
+        setGhost(l_algor);
+        if (tuneFlag_ && plan.load_file_ == NULL)
+            tune_thres("walk_bicut_boundary_p", timestep, l_algor, [&](Algorithm<N_RANK> & l_tune_algor, int l_timestep) {
+                l_tune_algor.walk_bicut_boundary_p(0+time_shift_, l_timestep+time_shift_, logic_grid_, f, bf); });
+        plan.make(0+time_shift_, timestep+time_shift_, logic_grid_, true, false);
+    }
+    Algorithm<N_RANK> & algor = *plan.algor_;
+    timestep_ = timestep;
+    dirtyFiles();
+    setGhost(algor);
+    pochoir_region([&]() { algor.replay_plan([&](int t0, int t1, grid_info<N_RANK> const & grid, int mask) {
+        if (mask == 0)
+            algor.base_case_kernel_interior(t0, t1, grid, f);
+        else if (algor.ghost())
+            algor.base_case_kernel_ghost(t0, t1, grid, f);
+        else
+            algor.base_case_kernel_classified(t0, t1, grid, mask, f, bf);
+    }); });
+}
+
+template <int N_RANK> template <typename F>
+void Pochoir<N_RANK>::Run_Obase(Pochoir_Plan<N_RANK> & plan, F const & f) {
+    int const timestep = plan.timestep();
+    Pochoir_Wavefront<N_RANK, F> const l_f = wavefront(f);
+    if (!plan.valid(this, Pochoir_Plan<N_RANK>::PLAN_OBASE)) {
+        Algorithm<N_RANK> & l_algor = setPlan(plan, Pochoir_Plan<N_RANK>::PLAN_OBASE);
+        setWave(l_algor);
+        if (tuneFlag_ && plan.load_file_ == NULL)
+            tune_thres("shorter_duo_sim_obase_bicut", timestep, l_algor, [&](Algorithm<N_RANK> & l_tune_algor, int l_timestep) {
+                l_tune_algor.shorter_duo_sim_obase_bicut(0+time_shift_, l_timestep+time_shift_, logic_grid_, l_f); });
+        plan.make(0+time_shift_, timestep+time_shift_, logic_grid_, false, true);
+    }
+    Algorithm<N_RANK> & algor = *plan.algor_;
+    timestep_ = timestep;
+    dirtyFiles();
+    pochoir_region([&]() { algor.replay_plan([&](int t0, int t1, grid_info<N_RANK> const & grid, int mask) {
+        l_f(t0, t1, grid);
+    }); });
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Run_Obase(Pochoir_Plan<N_RANK> & plan, F const & f, BF const & bf) {
+    int const timestep = plan.timestep();
+    Pochoir_Wavefront<N_RANK, F> const l_f = wavefront(f);
+    if (!plan.valid(this, Pochoir_Plan<N_RANK>::PLAN_OBASE_BOUNDARY)) {
+        Algorithm<N_RANK> & l_algor = setPlan(plan, Pochoir_Plan<N_RANK>::PLAN_OBASE_BOUNDARY);
+        setWave(l_algor);
+        setGhost(l_algor);
+        if (tuneFlag_ && plan.load_file_ == NULL)
+            tune_thres("shorter_duo_sim_obase_bicut_p", timestep, l_algor, [&](Algorithm<N_RANK> & l_tune_algor, int l_timestep) {
+                l_tune_algor.shorter_duo_sim_obase_bicut_p(0+time_shift_, l_timestep+time_shift_, logic_grid_, l_f, bf); });
+        plan.make(0+time_shift_, timestep+time_shift_, logic_grid_, true, true);
+    }
+    Algorithm<N_RANK> & algor = *plan.algor_;
+    timestep_ = timestep;
+    dirtyFiles();
+    setGhost(algor);
+    pochoir_region([&]() { algor.replay_plan([&](int t0, int t1, grid_info<N_RANK> const & grid, int mask) {
+        if (mask == 0)
+            l_f(t0, t1, grid);
+        else if (algor.ghost())
+            algor.base_case_obase_ghost(t0, t1, grid, l_f);
+        else
+            algor.base_case_obase_classified(t0, t1, grid, mask, l_f, bf);
+    }); });
+}
+
 #endif
@@ -24,15 +24,23 @@
 
 #ifndef POCHOIR_ARRAY_H
 #define POCHOIR_ARRAY_H
-// #include <iostream>
-// #include <iomanip>
+#include <iostream>
+#include <iomanip>
 #include <cstdio>
 #include <cstdlib>
+#include <new>
+#include <string>
+#include <cstring>
+#include <typeinfo>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "pochoir_range.hpp"
 #include "pochoir_common.hpp"
 #include "pochoir_proxy.hpp"
-#include <cilk/holder.h>
+#include "pochoir_parallel.hpp"
 
 using namespace std;
 
@@ -47,23 +55,253 @@ inline int cal_index<0>(int const * _idx, int const * _stride) {
 	return (_idx[0] * _stride[0]);
 }
 
+#define CACHE_LINE_SIZE 64
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+/* distance in bytes between two addresses mapping to the same L1 set,
+ * i.e. L1 size / associativity
+ */
+#define CACHE_SET_STRIDE 4096
+
+/* padding of the rows, see Pochoir_Array::Register_Padding() */
+#define PAD_NONE 0
+#define PAD_AUTO -1
+
+/* allocation policy of the Storage<T> behind a Pochoir_Array,
+ * register it by Pochoir_Array::Register_Alloc() before the shape.
+ * - align : alignment of the buffer in bytes (a power of two);
+ * - huge_page : round the buffer up to huge pages and madvise() it
+ *   to the transparent huge page pool;
+ * - first_touch : construct the elements in parallel, slab by slab 
+ *   along the outermost spatial dimension, which is the order the
+ *   walker cuts the grid, so that the OS places each page on the
+ *   NUMA node that will later compute it, one contiguous run of slabs
+ *   per group of workers as Pochoir::Numa_Locality() expects;
+ * - alloc_fn / free_fn : user supplied allocator, NULL for the default
+ *   posix_memalign() / free() pair, or pochoir_file_alloc() / 
+ *   pochoir_file_free() (Pochoir_Alloc_File) for a grid out of core;
+ * - file : the file the buffer is mapped from, with a header, NULL for
+ *   none, see Pochoir_Array::Register_File().
+ */
+struct Pochoir_Alloc {
+    size_t align;
+    bool huge_page;
+    bool first_touch;
+    void * (*alloc_fn)(size_t _bytes, size_t _align);
+    void (*free_fn)(void * _p, size_t _bytes);
+    char const * file;
+};
+
+/* the header in front of the time planes in the file of a Pochoir_Array,
+ * which describes the layout of the planes and the time of the last 
+ * checkpoint. The planes start at POCHOIR_FILE_DATA bytes in the file.
+ */
+#define POCHOIR_FILE_MAGIC "POCHOIR"
+#define POCHOIR_FILE_VERSION 1
+#define POCHOIR_FILE_DATA 4096
+
+struct Pochoir_File_Header {
+    char magic[8];
+    int version;
+    int rank, toggle, elem_size;
+    char elem_type[64];
+    int phys_size[SUPPORT_RANK], stride[SUPPORT_RANK], ghost[SUPPORT_RANK];
+    long long total_size;
+    /* time passed to the last Checkpoint(), -1 for none or if a run has
+     * written the planes since
+     */
+    long long time;
+};
+
+static const Pochoir_Alloc Pochoir_Alloc_Default = { CACHE_LINE_SIZE, false, true, NULL, NULL, NULL };
+static const Pochoir_Alloc Pochoir_Alloc_Serial = { CACHE_LINE_SIZE, false, false, NULL, NULL, NULL };
+static const Pochoir_Alloc Pochoir_Alloc_Huge = { HUGE_PAGE_SIZE, true, true, NULL, NULL, NULL };
+
+static inline void * pochoir_alloc_mem(size_t _bytes, Pochoir_Alloc const & _alloc) {
+    void * l_p = NULL;
+    size_t l_align = _alloc.align;
+    if (l_align < sizeof(void *))
+        l_align = sizeof(void *);
+    if (_alloc.alloc_fn != NULL) {
+        l_p = _alloc.alloc_fn(_bytes, l_align);
+    } else if (posix_memalign(&l_p, l_align, _bytes) != 0) {
+        l_p = NULL;
+    }
+    if (l_p == NULL) {
+        printf("Pochoir_Array : failed to allocate %lu bytes!\n", (unsigned long)_bytes);
+        exit(1);
+    }
+#ifdef MADV_HUGEPAGE
+    if (_alloc.huge_page) 
+        madvise(l_p, _bytes, MADV_HUGEPAGE);
+#endif
+    return l_p;
+}
+
+static inline void pochoir_free_mem(void * _p, size_t _bytes, Pochoir_Alloc const & _alloc) {
+    if (_alloc.free_fn != NULL) 
+        _alloc.free_fn(_p, _bytes);
+    else
+        free(_p);
+}
+
+/* alloc_fn / free_fn backing the buffer by a scratch file mapped shared,
+ * so that the OS pages a grid larger than the memory in and out of the
+ * file, see Pochoir::Out_Of_Core(). The file is created in the directory
+ * $POCHOIR_OOC_DIR (/tmp by default) and unlinked at once. The mapping is
+ * page aligned, which covers any alignment up to the page size.
+ */
+static inline void * pochoir_file_alloc(size_t _bytes, size_t _align) {
+    char const * l_dir = getenv("POCHOIR_OOC_DIR");
+    std::string l_path = std::string((l_dir != NULL) ? l_dir : "/tmp") + "/pochoir_XXXXXX";
+    int const l_fd = mkstemp(&l_path[0]);
+    void * l_p = MAP_FAILED;
+    if (l_fd >= 0) {
+        unlink(l_path.c_str());
+        if (ftruncate(l_fd, _bytes) == 0)
+            l_p = mmap(NULL, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, l_fd, 0);
+        close(l_fd);
+    }
+    if (l_p == MAP_FAILED || (size_t)l_p % _align != 0) {
+        printf("Pochoir_Array : failed to map %lu bytes of a file in %s!\n", (unsigned long)_bytes, l_path.c_str());
+        exit(1);
+    }
+    return l_p;
+}
+
+static inline void pochoir_file_free(void * _p, size_t _bytes) {
+    munmap(_p, _bytes);
+}
+
+static const Pochoir_Alloc Pochoir_Alloc_File = { CACHE_LINE_SIZE, false, false, pochoir_file_alloc, pochoir_file_free, NULL };
+
 template <typename T>
 class Storage {
 	private:
 		T * storage_;
 		int ref_;
+        int size_;
+        size_t bytes_;
+        Pochoir_Alloc alloc_;
+        /* the mapped file if alloc_.file is set, and whether its planes 
+         * were written by an earlier run
+         */
+        Pochoir_File_Header * header_;
+        bool restored_;
 	public:
-		inline Storage(int _sz) {
-			storage_ = new T[_sz];
+		inline Storage(int _sz) : size_(_sz), alloc_(Pochoir_Alloc_Serial), header_(NULL), restored_(false) {
+			storage_ = alloc(_sz);
 			ref_ = 1;
-			for (int i = 0; i < _sz; ++i)
-				storage_[i] = T();
+            init(0, _sz);
+		}
+
+        /* if _alloc.first_touch is set, the elements are left unconstructed,
+         * and the owner must init() every range of the buffer itself
+         */
+		inline Storage(int _sz, Pochoir_Alloc const & _alloc) : size_(_sz), alloc_(_alloc), header_(NULL), restored_(false) {
+			storage_ = alloc(_sz);
+			ref_ = 1;
+            if (!alloc_.first_touch)
+                init(0, _sz);
+		}
+
+        /* map the buffer from _alloc.file. A new file gets _header and
+         * constructed elements (by the owner if _alloc.first_touch); an
+         * existing one must have the same header but for the time, and 
+         * its elements are taken as they are.
+         */
+		inline Storage(int _sz, Pochoir_Alloc const & _alloc, Pochoir_File_Header const & _header) : size_(_sz), alloc_(_alloc), header_(NULL), restored_(false) {
+            struct stat l_stat;
+            void * l_p = MAP_FAILED;
+            bytes_ = (size_t)_sz * sizeof(T);
+            int const l_fd = open(alloc_.file, O_RDWR | O_CREAT, 0644);
+            if (l_fd >= 0 && fstat(l_fd, &l_stat) == 0) {
+                restored_ = (l_stat.st_size > 0);
+                if (restored_ || ftruncate(l_fd, POCHOIR_FILE_DATA + bytes_) == 0)
+                    l_p = mmap(NULL, POCHOIR_FILE_DATA + bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, l_fd, 0);
+            }
+            if (l_fd >= 0)
+                close(l_fd);
+            if (l_p == MAP_FAILED) {
+                printf("Pochoir_Array : failed to map %lu bytes of the file %s!\n", (unsigned long)(POCHOIR_FILE_DATA + bytes_), alloc_.file);
+                exit(1);
+            }
+            header_ = static_cast<Pochoir_File_Header *>(l_p);
+            storage_ = reinterpret_cast<T *>(static_cast<char *>(l_p) + POCHOIR_FILE_DATA);
+            ref_ = 1;
+            if (restored_) {
+                Pochoir_File_Header l_header = *header_;
+                l_header.time = _header.time;
+                if ((size_t)l_stat.st_size != POCHOIR_FILE_DATA + bytes_ 
+                    || memcmp(&l_header, &_header, sizeof(l_header)) != 0) {
+                    printf("Pochoir_Array : the file %s holds another array!\n", alloc_.file);
+                    exit(1);
+                }
+                if (header_->time < 0) {
+                    printf("Pochoir_Array : the file %s was written after its last Checkpoint()!\n", alloc_.file);
+                    exit(1);
+                }
+                return;
+            }
+            *header_ = _header;
+            if (!alloc_.first_touch)
+                init(0, _sz);
 		}
 
 		inline ~Storage() {
-			delete[] storage_;
+            for (int i = 0; i < size_; ++i)
+                storage_[i].~T();
+            if (header_ != NULL)
+                munmap(header_, POCHOIR_FILE_DATA + bytes_);
+            else
+                pochoir_free_mem(storage_, bytes_, alloc_);
 		}
 
+        bool restored() const { return restored_; }
+        long long file_time() const { return (header_ != NULL) ? header_->time : -1; }
+
+        /* record the time _t in the header and write the planes back, 
+         * asynchronously unless _wait. With _wait the planes are on disk
+         * before the header names their time.
+         */
+        void checkpoint(long long _t, bool _wait) {
+            if (header_ == NULL) {
+                printf("Pochoir_Array : Checkpoint() of an array without Register_File()!\n");
+                exit(1);
+            }
+            if (_wait) {
+                msync(storage_, bytes_, MS_SYNC);
+                header_->time = _t;
+                msync(header_, POCHOIR_FILE_DATA, MS_SYNC);
+            } else {
+                header_->time = _t;
+                msync(header_, POCHOIR_FILE_DATA + bytes_, MS_ASYNC);
+            }
+        }
+
+        /* the planes are about to change : mark the header dirty on
+         * disk first, so that a restart refuses the file until the next
+         * checkpoint names their time again
+         */
+        void dirty(void) {
+            if (header_ == NULL || header_->time < 0)
+                return;
+            header_->time = -1;
+            msync(header_, POCHOIR_FILE_DATA, MS_SYNC);
+        }
+
+        inline T * alloc(int _sz) {
+            bytes_ = (size_t)_sz * sizeof(T);
+            if (alloc_.huge_page)
+                bytes_ = (bytes_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            return static_cast<T *>(pochoir_alloc_mem(bytes_, alloc_));
+        }
+
+        /* construct the elements in [_begin, _end) */
+        inline void init(int _begin, int _end) {
+            for (int i = _begin; i < _end; ++i)
+                new (&storage_[i]) T();
+        }
+
 		inline void inc_ref() { 
 			++ref_; 
 		}
@@ -87,7 +325,12 @@ class Storage {
 		T * data() { return storage_; }
 };
 
-template <typename T, int N_RANK>
+/* N_TOGGLE > 0 fixes the number of time planes at compile time, so that
+ * the plane of a time index is a mask (power of two) or a multiply rather
+ * than a division; the shape must then need no more than N_TOGGLE planes.
+ * N_TOGGLE = 0 takes the number of planes from the shape at run time.
+ */
+template <typename T, int N_RANK, int N_TOGGLE = 0, typename BF = Pochoir_Bdry_Fn_Ptr>
 class Pochoir_Array {
 	private:
 		Storage<T> * view_; // real storage of elements
@@ -98,27 +341,35 @@ class Pochoir_Array {
 		size_info phys_size_; // physical of elements in each dimension
 		size_info stride_; // stride of each dimension
         bool allocMemFlag_;
+        Pochoir_Alloc alloc_;
 		int total_size_;
         int slope_[N_RANK], toggle_;
+        /* toggle_ - 1 if toggle_ is a power of two, -1 otherwise */
+        int toggle_mask_;
+        /* time planes kept by shape liveness, 0 if not registered */
+        int live_toggle_;
+        /* width of the ghost zone around each spatial dimension, 
+         * see Register_Ghost()
+         */
+        bool ghostFlag_;
+        int ghost_[N_RANK];
+        /* offset of cell (0, ..., 0) from the begining of its time plane */
+        int ghost_offset_;
+        /* time shifts the shape reads, [ghost_t0_, ghost_t1_) */
+        int ghost_t0_, ghost_t1_;
+        /* padding of the rows, see Register_Padding() */
+        int pad_;
         Pochoir_Shape<N_RANK> * shape_;
         int shape_size_;
-        typedef T (*BValue_1D)(Pochoir_Array<T, 1> &, int, int);
-        typedef T (*BValue_2D)(Pochoir_Array<T, 2> &, int, int, int);
-        typedef T (*BValue_3D)(Pochoir_Array<T, 3> &, int, int, int, int);
-        typedef T (*BValue_4D)(Pochoir_Array<T, 4> &, int, int, int, int, int);
-        typedef T (*BValue_5D)(Pochoir_Array<T, 5> &, int, int, int, int, int, int);
-        typedef T (*BValue_6D)(Pochoir_Array<T, 6> &, int, int, int, int, int, int, int);
-        typedef T (*BValue_7D)(Pochoir_Array<T, 7> &, int, int, int, int, int, int, int, int);
-        typedef T (*BValue_8D)(Pochoir_Array<T, 8> &, int, int, int, int, int, int, int, int, int);
-        BValue_1D bv1_;
-        BValue_2D bv2_;
-        BValue_3D bv3_;
-        BValue_4D bv4_;
-        BValue_5D bv5_;
-        BValue_6D bv6_;
-        BValue_7D bv7_;
-        BValue_8D bv8_;
-        cilk::holder<T, cilk::holder_keep_last> ret_v;
+        typedef typename Pochoir_BValue<Pochoir_Array<T, N_RANK, N_TOGGLE, BF>, T, N_RANK>::type BValue;
+        BValue bv_;
+        /* the boundary functor BF of the array type, or bv_ */
+        typedef Pochoir_Bdry_Call<BF, BValue> BCall;
+        /* built-in boundary condition, Pochoir_Bdry_User if it's bv_ */
+        Pochoir_Boundary_Kind bkind_;
+        /* the value of a Pochoir_Bdry_Constant boundary */
+        T bconst_;
+        Pochoir_Holder<T> ret_v;
         // Pochoir_Proxy<T> ret_v;
 	public:
 		/* create array with initial size 
@@ -132,8 +383,13 @@ class Pochoir_Array {
             total_size_ = sz0;
             shape_ = NULL;
             view_ = NULL;
-            bv1_ = NULL; bv2_ = NULL; bv3_ = NULL;
+            bv_ = NULL; bkind_ = Pochoir_Bdry_User; bconst_ = T();
             allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+            ghostFlag_ = false; ghost_offset_ = 0; ghost_t0_ = ghost_t1_ = 0; pad_ = PAD_NONE;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = 0;
+            toggle_ = 0; toggle_mask_ = -1;
 //            view_ = new Storage<T>(TOGGLE * total_size_);
 //            data_ = view_->data();
         }
@@ -147,8 +403,13 @@ class Pochoir_Array {
             shape_ = NULL;
 			total_size_ = phys_size_[0] * phys_size_[1];
 			view_ = NULL;
-            bv1_ = NULL; bv2_ = NULL; bv3_ = NULL;
+            bv_ = NULL; bkind_ = Pochoir_Bdry_User; bconst_ = T();
             allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+            ghostFlag_ = false; ghost_offset_ = 0; ghost_t0_ = ghost_t1_ = 0; pad_ = PAD_NONE;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = 0;
+            toggle_ = 0; toggle_mask_ = -1;
 //			  view_ = new Storage<T>(TOGGLE * total_size_) ;
 //            data_ = view_->data();
 		}
@@ -168,8 +429,13 @@ class Pochoir_Array {
 			}
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
-            bv1_ = NULL; bv2_ = NULL; bv3_ = NULL;
+            bv_ = NULL; bkind_ = Pochoir_Bdry_User; bconst_ = T();
             allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+            ghostFlag_ = false; ghost_offset_ = 0; ghost_t0_ = ghost_t1_ = 0; pad_ = PAD_NONE;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = 0;
+            toggle_ = 0; toggle_mask_ = -1;
 //  		  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
 		}
@@ -190,8 +456,13 @@ class Pochoir_Array {
 			}
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
-            bv1_ = NULL; bv2_ = NULL; bv3_ = NULL;
+            bv_ = NULL; bkind_ = Pochoir_Bdry_User; bconst_ = T();
             allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+            ghostFlag_ = false; ghost_offset_ = 0; ghost_t0_ = ghost_t1_ = 0; pad_ = PAD_NONE;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = 0;
+            toggle_ = 0; toggle_mask_ = -1;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
 		}
@@ -213,8 +484,13 @@ class Pochoir_Array {
 			}
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
-            bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL;
+            bv_ = NULL; bkind_ = Pochoir_Bdry_User; bconst_ = T();
             allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+            ghostFlag_ = false; ghost_offset_ = 0; ghost_t0_ = ghost_t1_ = 0; pad_ = PAD_NONE;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = 0;
+            toggle_ = 0; toggle_mask_ = -1;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
 		}
@@ -237,8 +513,13 @@ class Pochoir_Array {
 			}
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
-            bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL;
+            bv_ = NULL; bkind_ = Pochoir_Bdry_User; bconst_ = T();
             allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+            ghostFlag_ = false; ghost_offset_ = 0; ghost_t0_ = ghost_t1_ = 0; pad_ = PAD_NONE;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = 0;
+            toggle_ = 0; toggle_mask_ = -1;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
 		}
@@ -262,8 +543,13 @@ class Pochoir_Array {
 			}
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
-            bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL;
+            bv_ = NULL; bkind_ = Pochoir_Bdry_User; bconst_ = T();
             allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+            ghostFlag_ = false; ghost_offset_ = 0; ghost_t0_ = ghost_t1_ = 0; pad_ = PAD_NONE;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = 0;
+            toggle_ = 0; toggle_mask_ = -1;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
 		}
@@ -288,8 +574,13 @@ class Pochoir_Array {
 			}
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
-            bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL;
+            bv_ = NULL; bkind_ = Pochoir_Bdry_User; bconst_ = T();
             allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+            ghostFlag_ = false; ghost_offset_ = 0; ghost_t0_ = ghost_t1_ = 0; pad_ = PAD_NONE;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = 0;
+            toggle_ = 0; toggle_mask_ = -1;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
 		}
@@ -297,7 +588,7 @@ class Pochoir_Array {
 		/* Copy constructor -- create another view of the
 		 * same array
 		 */
-		Pochoir_Array (Pochoir_Array<T, N_RANK> const & orig) {
+		Pochoir_Array (Pochoir_Array<T, N_RANK, N_TOGGLE, BF> const & orig) {
 			total_size_ = orig.total_size();
 			for (int i = 0; i < N_RANK; ++i) {
 				phys_size_[i] = orig.phys_size(i);
@@ -306,24 +597,23 @@ class Pochoir_Array {
                 logic_start_[i] = 0; logic_end_[i] = logic_size_[i];
 			}
 			view_ = NULL;
-			view_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).view();
+			view_ = const_cast<Pochoir_Array<T, N_RANK, N_TOGGLE, BF> &>(orig).view();
 			view_->inc_ref();
-            /* We also get the BValue function pointer from orig */
-            bv1_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_1D(); 
-            bv2_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_2D(); 
-            bv3_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_3D(); 
-            bv4_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_4D(); 
-            bv5_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_5D(); 
-            bv6_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_6D(); 
-            bv7_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_7D(); 
-            bv8_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_8D(); 
-            data_ = view_->data();
+            /* We also get the boundary condition from orig */
+            bv_ = orig.bv_; bkind_ = orig.bkind_; bconst_ = orig.bconst_;
             allocMemFlag_ = true;
+            alloc_ = orig.alloc_;
+            live_toggle_ = orig.live_toggle_;
+            ghostFlag_ = orig.ghostFlag_; ghost_offset_ = orig.ghost_offset_;
+            ghost_t0_ = orig.ghost_t0_; ghost_t1_ = orig.ghost_t1_; pad_ = orig.pad_;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = orig.ghost_[i];
+            data_ = view_->data() + ghost_offset_;
+            toggle_ = orig.toggle_; toggle_mask_ = orig.toggle_mask_;
             shape_ = NULL;
 		}
 
         /* assignment operator for vector<> */
-		Pochoir_Array<T, N_RANK> & operator= (Pochoir_Array<T, N_RANK> const & orig) {
+		Pochoir_Array<T, N_RANK, N_TOGGLE, BF> & operator= (Pochoir_Array<T, N_RANK, N_TOGGLE, BF> const & orig) {
 			total_size_ = orig.total_size();
 			for (int i = 0; i < N_RANK; ++i) {
 				phys_size_[i] = orig.phys_size(i);
@@ -331,19 +621,18 @@ class Pochoir_Array {
 				stride_[i] = orig.stride(i);
 			}
 			view_ = NULL;
-			view_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).view();
+			view_ = const_cast<Pochoir_Array<T, N_RANK, N_TOGGLE, BF> &>(orig).view();
 			view_->inc_ref();
-            /* We also get the BValue function pointer from orig */
-            bv1_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_1D(); 
-            bv2_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_2D(); 
-            bv3_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_3D(); 
-            bv4_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_4D(); 
-            bv5_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_5D(); 
-            bv6_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_6D(); 
-            bv7_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_7D(); 
-            bv8_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_8D(); 
-            data_ = view_->data();
+            /* We also get the boundary condition from orig */
+            bv_ = orig.bv_; bkind_ = orig.bkind_; bconst_ = orig.bconst_;
             allocMemFlag_ = true;
+            alloc_ = orig.alloc_;
+            live_toggle_ = orig.live_toggle_;
+            ghostFlag_ = orig.ghostFlag_; ghost_offset_ = orig.ghost_offset_;
+            ghost_t0_ = orig.ghost_t0_; ghost_t1_ = orig.ghost_t1_; pad_ = orig.pad_;
+            for (int i = 0; i < N_RANK; ++i) ghost_[i] = orig.ghost_[i];
+            data_ = view_->data() + ghost_offset_;
+            toggle_ = orig.toggle_; toggle_mask_ = orig.toggle_mask_;
             shape_ = NULL;
             return *this;
 		}
@@ -362,26 +651,24 @@ class Pochoir_Array {
 
         inline T * data() { return data_; }
         /* return the function pointer which generates the boundary value! */
-        BValue_1D bv_1D(void) { return bv1_; }
-        BValue_2D bv_2D(void) { return bv2_; }
-        BValue_3D bv_3D(void) { return bv3_; }
-        BValue_4D bv_4D(void) { return bv4_; }
-        BValue_5D bv_5D(void) { return bv5_; }
-        BValue_6D bv_6D(void) { return bv6_; }
-        BValue_7D bv_7D(void) { return bv7_; }
-        BValue_8D bv_8D(void) { return bv8_; }
-
-        /* guarantee that only one version of boundary function is registered ! */
-        void Register_Boundary(BValue_1D _bv1) { bv1_ = _bv1;  bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL; bv8_ = NULL;}
-        void Register_Boundary(BValue_2D _bv2) { bv2_ = _bv2;  bv1_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL; bv8_ = NULL;}
-        void Register_Boundary(BValue_3D _bv3) { bv3_ = _bv3;  bv1_ = NULL; bv2_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL; bv8_ = NULL;}
-        void Register_Boundary(BValue_4D _bv4) { bv4_ = _bv4;  bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL; bv8_ = NULL;}
-        void Register_Boundary(BValue_5D _bv5) { bv5_ = _bv5;  bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv6_ = NULL; bv7_ = NULL; bv8_ = NULL;}
-        void Register_Boundary(BValue_6D _bv6) { bv6_ = _bv6;  bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv7_ = NULL; bv8_ = NULL;}
-        void Register_Boundary(BValue_7D _bv7) { bv7_ = _bv7;  bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL; bv8_ = NULL;}
-        void Register_Boundary(BValue_8D _bv8) { bv8_ = _bv8;  bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL;}
-
-        void unRegister_Boundary(void) { bv1_ = NULL;  bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; ; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL; bv8_ = NULL}
+        BValue bv(void) { return bv_; }
+        Pochoir_Boundary_Kind bkind(void) const { return bkind_; }
+        /* a user boundary : the functor BF or a registered boundary function */
+        inline bool user_bdry(void) const { return BCall::functor || bv_ != NULL; }
+
+        /* guarantee that only one boundary condition is registered ! */
+        void Register_Boundary(BValue _bv) { bv_ = _bv; bkind_ = Pochoir_Bdry_User; }
+        /* register a built-in boundary condition, which the accessors resolve
+         * inline without calling a boundary function; _v is the value of
+         * a Pochoir_Bdry_Constant boundary
+         */
+        void Register_Boundary(Pochoir_Boundary_Kind _kind, T const & _v = T()) {
+            bv_ = NULL;
+            bkind_ = (_kind == Pochoir_Bdry_Zero) ? Pochoir_Bdry_Constant : _kind;
+            bconst_ = (_kind == Pochoir_Bdry_Zero) ? T() : _v;
+        }
+
+        void unRegister_Boundary(void) { bv_ = NULL; bkind_ = Pochoir_Bdry_User; }
 
         void Register_Domain(grid_info<N_RANK> initial_grid) {
             for (int i = 0; i < N_RANK; ++i) {
@@ -411,7 +698,7 @@ class Pochoir_Array {
                 }
             }
             depth = l_max_time_shift - l_min_time_shift;
-            toggle_ = depth + 1;
+            set_toggle((live_toggle_ > 0) ? live_toggle_ : depth + 1);
             for (int i = 0; i < shape_size; ++i) {
                 for (int r = 0; r < N_RANK; ++r) {
 //                    slope_[r] = max(slope_[r], abs((int)ceil((float)shape_[i].shift[r+1]/(l_max_time_shift - shape_[i].shift[0]))));
@@ -456,7 +743,7 @@ class Pochoir_Array {
                 }
             }
             depth = l_max_time_shift - l_min_time_shift;
-            toggle_ = depth + 1;
+            set_toggle((live_toggle_ > 0) ? live_toggle_ : depth + 1);
             for (int i = 0; i < N_SIZE; ++i) {
                 for (int r = 0; r < N_RANK; ++r) {
 //                    slope_[r] = max(slope_[r], abs((int)ceil((float)shape_[i].shift[r+1]/(l_max_time_shift - shape_[i].shift[0]))));
@@ -507,7 +794,7 @@ class Pochoir_Array {
                 }
             }
             depth = l_max_time_shift - l_min_time_shift;
-            toggle_ = depth + 1;
+            set_toggle((live_toggle_ > 0) ? live_toggle_ : depth + 1);
             for (i = 0; i < N_SIZE1+N_SIZE2; ++i) {
                 for (int r = 0; r < N_RANK; ++r) {
 //                    slope_[r] = max(slope_[r], abs((int)ceil((float)shape_[i].shift[r+1]/(l_max_time_shift - shape_[i].shift[0]))));
@@ -578,23 +865,240 @@ class Pochoir_Array {
             for (int i = 0; i < N_RANK; ++i) 
                 slope_[i] = _slope[i]; 
         }
-        void set_toggle(int _toggle) { toggle_ = _toggle; }
+        void set_toggle(int _toggle) { 
+            if (N_TOGGLE > 0) {
+                if (_toggle > N_TOGGLE) {
+                    printf("Pochoir_Array : the shape needs %d time planes, more than the %d of the array!\n", _toggle, N_TOGGLE);
+                    exit(1);
+                }
+                _toggle = N_TOGGLE;
+            }
+            toggle_ = _toggle; 
+            toggle_mask_ = ((_toggle & (_toggle - 1)) == 0) ? _toggle - 1 : -1;
+        }
+        /* register the allocation policy, must come before the 
+         * Register_Shape() / Pochoir::Register_Array() which allocates
+         */
+        void Register_Alloc(Pochoir_Alloc const & _alloc) {
+            if (allocMemFlag_) {
+                printf("Pochoir_Array : Register_Alloc() after the memory is allocated!\n");
+                exit(1);
+            }
+            alloc_ = _alloc;
+        }
+        /* map the time planes from the file _fname (a checkpoint), with a
+         * Pochoir_File_Header in front of them. If the file holds this 
+         * array already, e.g. on a restart, its planes are used as they 
+         * are, with no copy, and the Run() goes on from them. Must come 
+         * before the memory is allocated.
+         */
+        void Register_File(char const * _fname) {
+            if (allocMemFlag_) {
+                printf("Pochoir_Array : Register_File() after the memory is allocated!\n");
+                exit(1);
+            }
+            alloc_.file = _fname;
+        }
+        /* the time of the last Checkpoint() into the file, -1 if none or
+         * if a Run() has written the planes since
+         */
+        long long File_Time() const { return (view_ != NULL) ? view_->file_time() : -1; }
+        /* write the planes back to the file, with _t as the current time,
+         * asynchronously unless _wait, between two Run()s
+         */
+        void Checkpoint(long long _t, bool _wait = false) { view_->checkpoint(_t, _wait); }
+        /* called by Pochoir::Run() before it writes the planes */
+        void Dirty_File(void) { if (view_ != NULL) view_->dirty(); }
+
+        /* keep only the time planes which are live for the entries of
+         * shape[] reading this array (see live_toggle()), instead of all
+         * the planes of the stencil's shape. _home is the time shift the
+         * array is written at. Must come before the memory is allocated.
+         */
+        void Register_Liveness(Pochoir_Shape<N_RANK> const * shape, int shape_size, int _home) {
+            int const l_toggle = live_toggle<N_RANK>(shape, shape_size, _home);
+            if (l_toggle == 0) {
+                printf("Pochoir_Array : Register_Liveness() with a time shift later than the home %d!\n", _home);
+                exit(1);
+            }
+            /* an array shared by several stencils is registered again */
+            if (allocMemFlag_ && l_toggle != toggle_) {
+                printf("Pochoir_Array : Register_Liveness() after the memory is allocated!\n");
+                exit(1);
+            }
+            live_toggle_ = l_toggle;
+        }
+
+        template <size_t N_SIZE>
+        void Register_Liveness(Pochoir_Shape<N_RANK> (& shape)[N_SIZE], int _home) {
+            Register_Liveness(shape, N_SIZE, _home);
+        }
+
+        /* pad the rows of the array to avoid cache-set conflicts between
+         * neighboring rows / planes, must come before the memory is allocated.
+         * - _multiple > 0 : round the leading dimension up to a multiple 
+         *   of _multiple elements;
+         * - PAD_AUTO : round the leading dimension up to a cache line, and
+         *   add one more cache line to any row / plane whose size in bytes
+         *   is a multiple of CACHE_SET_STRIDE;
+         * - PAD_NONE : the dense layout.
+         */
+        void Register_Padding(int _multiple = PAD_AUTO) {
+            if (allocMemFlag_) {
+                printf("Pochoir_Array : Register_Padding() after the memory is allocated!\n");
+                exit(1);
+            }
+            pad_ = _multiple;
+            set_layout();
+        }
+
+        /* allocate the array with a ghost zone (halo) around the domain,
+         * as wide in each dimension as the farthest spatial shift of the 
+         * shape. Before each time step of a zoid touching the boundary, the
+         * walker fills the halo cells the step reads from the boundary 
+         * condition of the array, so that boundary zoids run the interior 
+         * / obase kernel, instead of checking every access. Must come 
+         * before the memory is allocated.
+         */
+        void Register_Ghost(void) {
+            if (allocMemFlag_) {
+                printf("Pochoir_Array : Register_Ghost() after the memory is allocated!\n");
+                exit(1);
+            }
+            ghostFlag_ = true;
+        }
+
+        /* strides and plane size out of the extents plus the ghost zone,
+         * with the rows padded by pad_
+         */
+        void set_layout(void) {
+            int const l_line = (sizeof(T) < CACHE_LINE_SIZE) ? (int)(CACHE_LINE_SIZE / sizeof(T)) : 1;
+            int l_stride = phys_size_[0] + 2 * ghost_[0];
+            if (pad_ > 0) {
+                l_stride = (l_stride + pad_ - 1) / pad_ * pad_;
+            } else if (pad_ == PAD_AUTO) {
+                l_stride = (l_stride + l_line - 1) / l_line * l_line;
+                if ((l_stride * sizeof(T)) % CACHE_SET_STRIDE == 0)
+                    l_stride += l_line;
+            }
+            stride_[0] = 1;
+            for (int i = 1; i < N_RANK; ++i) {
+                stride_[i] = l_stride;
+                l_stride = stride_[i] * (phys_size_[i] + 2 * ghost_[i]);
+                if (pad_ == PAD_AUTO && (l_stride * sizeof(T)) % CACHE_SET_STRIDE == 0)
+                    l_stride += l_line;
+            }
+            total_size_ = l_stride;
+            ghost_offset_ = 0;
+            for (int i = 0; i < N_RANK; ++i)
+                ghost_offset_ += ghost_[i] * stride_[i];
+        }
+
+        /* the ghost zone and the time shifts read out of the shape */
+        void set_ghost(void) {
+            ghost_t0_ = ghost_t1_ = shape_[0].shift[0];
+            for (int r = 0; r < N_RANK; ++r)
+                ghost_[r] = 0;
+            for (int i = 0; i < shape_size_; ++i) {
+                ghost_t0_ = min(ghost_t0_, shape_[i].shift[0]);
+                ghost_t1_ = max(ghost_t1_, shape_[i].shift[0]);
+                for (int r = 0; r < N_RANK; ++r)
+                    ghost_[r] = max(ghost_[r], abs(shape_[i].shift[N_RANK-r]));
+            }
+            /* a halo cell maps back to one cell of the domain */
+            for (int r = 0; r < N_RANK; ++r) {
+                if (ghost_[r] > phys_size_[r]) {
+                    printf("Pochoir_Array : the ghost zone is wider than dimension %d!\n", r);
+                    exit(1);
+                }
+            }
+        }
+
         void alloc_mem(void) {
             if (!allocMemFlag_) {
-                view_ = new Storage<T>(toggle_*total_size_) ;
-                data_ = view_->data();
+                if (ghostFlag_) {
+                    set_ghost();
+                    set_layout();
+                }
+                if (alloc_.file != NULL)
+                    view_ = new Storage<T>(toggle_*total_size_, alloc_, file_header());
+                else
+                    view_ = new Storage<T>(toggle_*total_size_, alloc_) ;
+                data_ = view_->data() + ghost_offset_;
                 allocMemFlag_ = true;
+                if (alloc_.first_touch && !view_->restored()) 
+                    first_touch();
             }
         }
+
+        Pochoir_File_Header file_header(void) const {
+            Pochoir_File_Header l_header;
+            memset(&l_header, 0, sizeof(l_header));
+            strncpy(l_header.magic, POCHOIR_FILE_MAGIC, sizeof(l_header.magic));
+            l_header.version = POCHOIR_FILE_VERSION;
+            l_header.rank = N_RANK;
+            l_header.toggle = toggle_;
+            l_header.elem_size = sizeof(T);
+            strncpy(l_header.elem_type, typeid(T).name(), sizeof(l_header.elem_type) - 1);
+            for (int i = 0; i < N_RANK; ++i) {
+                l_header.phys_size[i] = phys_size_[i];
+                l_header.stride[i] = stride_[i];
+                l_header.ghost[i] = ghost_[i];
+            }
+            l_header.total_size = total_size_;
+            l_header.time = -1;
+            return l_header;
+        }
+
+        /* initialize each time plane in slabs of the outermost spatial 
+         * dimension, in parallel, so that the pages of a slab are first
+         * touched by the worker which is likely to compute it
+         */
+        void first_touch(void) {
+            int const l_slabs = phys_size_[N_RANK-1] + 2 * ghost_[N_RANK-1];
+            int const l_slab_size = stride_[N_RANK-1];
+            int const l_tail = l_slabs * l_slab_size;
+            Storage<T> * l_view = view_;
+            int const l_toggle = toggle_, l_total_size = total_size_;
+            pochoir_group_for(0, l_slabs, [&](int i) {
+                for (int t = 0; t < l_toggle; ++t) {
+                    int const l_begin = t * l_total_size + i * l_slab_size;
+                    l_view->init(l_begin, l_begin + l_slab_size);
+                }
+            });
+            /* the padding past the last slab, if any */
+            for (int t = 0; t < l_toggle; ++t) 
+                l_view->init(t * l_total_size + l_tail, (t+1) * l_total_size);
+        }
 		/* return size */
 		int phys_size(int _dim) const { return phys_size_[_dim]; }
 		int logic_size(int _dim) const { return logic_size_[_dim]; }
         /* the size() function is for user's convenience! */
 		int size(int _dim) const { return phys_size_[_dim]; }
 		int slope(int _dim) const { return slope_[_dim]; }
+        bool ghost() const { return ghostFlag_; }
+        /* the file the planes are mapped from, NULL for none */
+        char const * file() const { return alloc_.file; }
+		int ghost(int _dim) const { return ghost_[_dim]; }
+		int toggle() const { return toggle_; }
+
+        /* the offset of the time plane of _t >= 0, all the accessors go 
+         * through it
+         */
+        inline int plane_offset(int _t) const {
+            if (N_TOGGLE > 0)
+                return (int)((unsigned)_t % N_TOGGLE) * total_size_;
+            return ((toggle_mask_ >= 0) ? (_t & toggle_mask_) : (_t % toggle_)) * total_size_;
+        }
 
 		/* return total_size_ */
 		int total_size() const { return total_size_; }
+        /* rows [_r, _r + n) of the outermost dimension in the time plane _p
+         * (0 <= _p < toggle()) are n * row_size() contiguous elements from
+         * rows(_p, _r), see Pochoir_Dist
+         */
+        T * rows(int _p, int _r) { return data_ + _p * total_size_ + _r * stride_[N_RANK-1]; }
+        int row_size() const { return stride_[N_RANK-1]; }
 
 		/* return stride */
 		int stride (int _dim) const { return stride_[_dim]; }
@@ -649,7 +1153,7 @@ class Pochoir_Array {
                  || _idx3 < logic_start_[3] || _idx3 >= logic_end_[3] \
                  || _idx4 < logic_start_[4] || _idx4 >= logic_end_[4] \
                  || _idx5 < logic_start_[5] || _idx5 >= logic_end_[5] \
-                 || _idx6 < logic_start_[6] || _idx5 >= logic_end_[6])
+                 || _idx6 < logic_start_[6] || _idx6 >= logic_end_[6])
 
 #define check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0) \
             (_idx0 < logic_start_[0] || _idx0 >= logic_end_[0] \
@@ -658,8 +1162,270 @@ class Pochoir_Array {
                  || _idx3 < logic_start_[3] || _idx3 >= logic_end_[3] \
                  || _idx4 < logic_start_[4] || _idx4 >= logic_end_[4] \
                  || _idx5 < logic_start_[5] || _idx5 >= logic_end_[5] \
-                 || _idx6 < logic_start_[6] || _idx5 >= logic_end_[6] \
-                 || _idx7 < logic_start_[7] || _idx5 >= logic_end_[7])
+                 || _idx6 < logic_start_[6] || _idx6 >= logic_end_[6] \
+                 || _idx7 < logic_start_[7] || _idx7 >= logic_end_[7])
+
+        /* the cell a built-in Periodic/Mirror/Clamp boundary reads for an
+         * off-domain index; the time index is left as is
+         */
+		inline T & bdry_value (int _idx1, int _idx0) {
+			int l_idx = bdry_index(bkind_, _idx0, logic_start_[0], logic_end_[0]) * stride_[0]
+                      + plane_offset(_idx1);
+            return (*(data_ + l_idx));
+		}
+
+		inline T & bdry_value (int _idx2, int _idx1, int _idx0) {
+			int l_idx = bdry_index(bkind_, _idx0, logic_start_[0], logic_end_[0]) * stride_[0]
+                      + bdry_index(bkind_, _idx1, logic_start_[1], logic_end_[1]) * stride_[1]
+                      + plane_offset(_idx2);
+            return (*(data_ + l_idx));
+		}
+
+		inline T & bdry_value (int _idx3, int _idx2, int _idx1, int _idx0) {
+			int l_idx = bdry_index(bkind_, _idx0, logic_start_[0], logic_end_[0]) * stride_[0]
+                      + bdry_index(bkind_, _idx1, logic_start_[1], logic_end_[1]) * stride_[1]
+                      + bdry_index(bkind_, _idx2, logic_start_[2], logic_end_[2]) * stride_[2]
+                      + plane_offset(_idx3);
+            return (*(data_ + l_idx));
+		}
+
+		inline T & bdry_value (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+			int l_idx = bdry_index(bkind_, _idx0, logic_start_[0], logic_end_[0]) * stride_[0]
+                      + bdry_index(bkind_, _idx1, logic_start_[1], logic_end_[1]) * stride_[1]
+                      + bdry_index(bkind_, _idx2, logic_start_[2], logic_end_[2]) * stride_[2]
+                      + bdry_index(bkind_, _idx3, logic_start_[3], logic_end_[3]) * stride_[3]
+                      + plane_offset(_idx4);
+            return (*(data_ + l_idx));
+		}
+
+		inline T & bdry_value (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+			int l_idx = bdry_index(bkind_, _idx0, logic_start_[0], logic_end_[0]) * stride_[0]
+                      + bdry_index(bkind_, _idx1, logic_start_[1], logic_end_[1]) * stride_[1]
+                      + bdry_index(bkind_, _idx2, logic_start_[2], logic_end_[2]) * stride_[2]
+                      + bdry_index(bkind_, _idx3, logic_start_[3], logic_end_[3]) * stride_[3]
+                      + bdry_index(bkind_, _idx4, logic_start_[4], logic_end_[4]) * stride_[4]
+                      + plane_offset(_idx5);
+            return (*(data_ + l_idx));
+		}
+
+		inline T & bdry_value (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+			int l_idx = bdry_index(bkind_, _idx0, logic_start_[0], logic_end_[0]) * stride_[0]
+                      + bdry_index(bkind_, _idx1, logic_start_[1], logic_end_[1]) * stride_[1]
+                      + bdry_index(bkind_, _idx2, logic_start_[2], logic_end_[2]) * stride_[2]
+                      + bdry_index(bkind_, _idx3, logic_start_[3], logic_end_[3]) * stride_[3]
+                      + bdry_index(bkind_, _idx4, logic_start_[4], logic_end_[4]) * stride_[4]
+                      + bdry_index(bkind_, _idx5, logic_start_[5], logic_end_[5]) * stride_[5]
+                      + plane_offset(_idx6);
+            return (*(data_ + l_idx));
+		}
+
+		inline T & bdry_value (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+			int l_idx = bdry_index(bkind_, _idx0, logic_start_[0], logic_end_[0]) * stride_[0]
+                      + bdry_index(bkind_, _idx1, logic_start_[1], logic_end_[1]) * stride_[1]
+                      + bdry_index(bkind_, _idx2, logic_start_[2], logic_end_[2]) * stride_[2]
+                      + bdry_index(bkind_, _idx3, logic_start_[3], logic_end_[3]) * stride_[3]
+                      + bdry_index(bkind_, _idx4, logic_start_[4], logic_end_[4]) * stride_[4]
+                      + bdry_index(bkind_, _idx5, logic_start_[5], logic_end_[5]) * stride_[5]
+                      + bdry_index(bkind_, _idx6, logic_start_[6], logic_end_[6]) * stride_[6]
+                      + plane_offset(_idx7);
+            return (*(data_ + l_idx));
+		}
+
+		inline T & bdry_value (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+			int l_idx = bdry_index(bkind_, _idx0, logic_start_[0], logic_end_[0]) * stride_[0]
+                      + bdry_index(bkind_, _idx1, logic_start_[1], logic_end_[1]) * stride_[1]
+                      + bdry_index(bkind_, _idx2, logic_start_[2], logic_end_[2]) * stride_[2]
+                      + bdry_index(bkind_, _idx3, logic_start_[3], logic_end_[3]) * stride_[3]
+                      + bdry_index(bkind_, _idx4, logic_start_[4], logic_end_[4]) * stride_[4]
+                      + bdry_index(bkind_, _idx5, logic_start_[5], logic_end_[5]) * stride_[5]
+                      + bdry_index(bkind_, _idx6, logic_start_[6], logic_end_[6]) * stride_[6]
+                      + bdry_index(bkind_, _idx7, logic_start_[7], logic_end_[7]) * stride_[7]
+                      + plane_offset(_idx8);
+            return (*(data_ + l_idx));
+		}
+
+        /* the value the boundary condition gives an off-domain cell */
+        inline T ghost_value(int _t, size_info const & _idx) {
+            if (bkind_ == Pochoir_Bdry_Constant)
+                return bconst_;
+            if (bkind_ != Pochoir_Bdry_User) {
+                size_info l_bidx;
+                for (int i = 0; i < N_RANK; ++i)
+                    l_bidx[i] = bdry_index(bkind_, _idx[i], logic_start_[i], logic_end_[i]);
+                return data_[cal_index<N_RANK-1>(l_bidx, stride_) + plane_offset(_t)];
+            }
+            return Pochoir_BValue_Apply<N_RANK>::apply(BCall::fn(bv_), *this, _t, _idx);
+        }
+
+        /* fill the off-domain cells of the box [_lo, _hi) at time _t, 
+         * as a set of disjoint boxes each below or above the domain in
+         * dimension d and within it in the dimensions < d
+         */
+        void fill_ghost(int _t, int const * _lo, int const * _hi) {
+            int l_lo[N_RANK], l_hi[N_RANK];
+            for (int d = 0; d < N_RANK; ++d) {
+                for (int i = 0; i < N_RANK; ++i) {
+                    l_lo[i] = (i < d) ? max(_lo[i], 0) : _lo[i];
+                    l_hi[i] = (i < d) ? min(_hi[i], phys_size_[i]) : _hi[i];
+                }
+                l_lo[d] = _lo[d]; l_hi[d] = min(_hi[d], 0);
+                fill_ghost_cells(_t, l_lo, l_hi);
+                l_lo[d] = max(_lo[d], phys_size_[d]); l_hi[d] = _hi[d];
+                fill_ghost_cells(_t, l_lo, l_hi);
+            }
+        }
+
+        void fill_ghost_cells(int _t, int const * _lo, int const * _hi) {
+            size_info l_idx;
+            for (int i = 0; i < N_RANK; ++i) {
+                if (_lo[i] >= _hi[i])
+                    return;
+                l_idx[i] = _lo[i];
+            }
+            T * const l_plane = data_ + plane_offset(_t);
+            while (true) {
+                l_plane[cal_index<N_RANK-1>(l_idx, stride_)] = ghost_value(_t, l_idx);
+                int i = 0;
+                while (i < N_RANK && ++l_idx[i] == _hi[i]) {
+                    l_idx[i] = _lo[i];
+                    ++i;
+                }
+                if (i == N_RANK)
+                    return;
+            }
+        }
+
+        /* the in-domain cell along dimension _i that the value of halo 
+         * index _x comes from : the boundary kind remaps it, a user boundary
+         * function is owned by the periodic image, which is the cell the 
+         * walker orders the readers of _x after
+         */
+        inline int ghost_source(int _i, int _x) const {
+            if (bkind_ == Pochoir_Bdry_User)
+                return bdry_index(Pochoir_Bdry_Periodic, _x, 0, phys_size_[_i]);
+            return bdry_index(bkind_, _x, logic_start_[_i], logic_end_[_i]);
+        }
+
+        /* write the halo cells of plane _t whose source cells, along every
+         * dimension, lie in [_lo, _hi), a box inside the domain. Along each
+         * dimension, the indices below the domain, in it and above it, that
+         * map into the box form three runs (the remap is monotone on each
+         * side), and every combination but the one inside the domain in 
+         * every dimension is a box of halo cells
+         */
+        void push_ghost(int _t, int const * _lo, int const * _hi) {
+            int l_run[N_RANK][3][2];
+            for (int i = 0; i < N_RANK; ++i) {
+                int const l_size = phys_size_[i];
+                l_run[i][0][0] = l_run[i][2][0] = 0;
+                l_run[i][0][1] = l_run[i][2][1] = 0;
+                for (int x = -ghost_[i]; x < 0; ++x) {
+                    int const l_src = ghost_source(i, x);
+                    if (l_src >= _lo[i] && l_src < _hi[i]) {
+                        if (l_run[i][0][0] == l_run[i][0][1])
+                            l_run[i][0][0] = x;
+                        l_run[i][0][1] = x + 1;
+                    }
+                }
+                for (int x = l_size; x < l_size + ghost_[i]; ++x) {
+                    int const l_src = ghost_source(i, x);
+                    if (l_src >= _lo[i] && l_src < _hi[i]) {
+                        if (l_run[i][2][0] == l_run[i][2][1])
+                            l_run[i][2][0] = x;
+                        l_run[i][2][1] = x + 1;
+                    }
+                }
+                l_run[i][1][0] = _lo[i]; l_run[i][1][1] = _hi[i];
+            }
+            int l_nbox = 1;
+            for (int i = 0; i < N_RANK; ++i)
+                l_nbox *= 3;
+            for (int c = 0; c < l_nbox; ++c) {
+                int l_box_lo[N_RANK], l_box_hi[N_RANK];
+                bool l_halo = false;
+                for (int i = 0, l_c = c; i < N_RANK; ++i, l_c /= 3) {
+                    l_box_lo[i] = l_run[i][l_c % 3][0];
+                    l_box_hi[i] = l_run[i][l_c % 3][1];
+                    l_halo = l_halo || (l_c % 3 != 1);
+                }
+                if (l_halo)
+                    fill_ghost_cells(_t, l_box_lo, l_box_hi);
+            }
+        }
+
+        /* write the halo images of the cells which one time step of the 
+         * walker over _grid has just computed, in the plane it wrote. The
+         * walker hands in _grid in its periodic coordinates, which wrap 
+         * around the domain at most once.
+         *
+         * A halo cell is only written by the step which computes its source
+         * cell (see ghost_source()), right after it computed it, so each
+         * cell has a single writer and a step reading it is ordered after
+         * it by the same dependencies as a read of its source. The halo 
+         * planes never have to be refreshed by their readers, which share
+         * them. Every plane gets its halo at full width, which covers the
+         * reads of all the time shifts of the shape. A constant boundary
+         * never changes, it is filled once by Fill_Ghost().
+         */
+        void Push_Ghost(int _t, grid_info<N_RANK> const & _grid) {
+            int l_lo[N_RANK][2], l_hi[N_RANK][2], l_pieces[N_RANK];
+            if (!ghostFlag_ || bkind_ == Pochoir_Bdry_Constant
+                || (bkind_ == Pochoir_Bdry_User && !user_bdry()))
+                return;
+            for (int i = 0; i < N_RANK; ++i) {
+                int const l_size = phys_size_[i];
+                int const l_len = _grid.x1[i] - _grid.x0[i];
+                if (l_len <= 0)
+                    return;
+                int const l_x0 = ((_grid.x0[i] % l_size) + l_size) % l_size;
+                l_pieces[i] = 1;
+                if (l_len >= l_size) {
+                    l_lo[i][0] = 0; l_hi[i][0] = l_size;
+                } else if (l_x0 + l_len <= l_size) {
+                    l_lo[i][0] = l_x0; l_hi[i][0] = l_x0 + l_len;
+                } else {
+                    l_lo[i][0] = l_x0; l_hi[i][0] = l_size;
+                    l_lo[i][1] = 0; l_hi[i][1] = l_x0 + l_len - l_size;
+                    l_pieces[i] = 2;
+                }
+            }
+            /* one box for each combination of the pieces of the dimensions */
+            for (int c = 0; c < (1 << N_RANK); ++c) {
+                int l_box_lo[N_RANK], l_box_hi[N_RANK];
+                bool l_valid = true;
+                for (int i = 0; i < N_RANK && l_valid; ++i) {
+                    int const l_piece = (c >> i) & 1;
+                    l_valid = (l_piece < l_pieces[i]);
+                    if (l_valid) {
+                        l_box_lo[i] = l_lo[i][l_piece];
+                        l_box_hi[i] = l_hi[i][l_piece];
+                    }
+                }
+                if (l_valid)
+                    push_ghost(_t + ghost_t1_, l_box_lo, l_box_hi);
+            }
+        }
+
+        /* fill the whole halo of the planes the first time step from _t 
+         * reads, before a run, or of every time plane with a constant 
+         * boundary
+         */
+        void Fill_Ghost(int _t) {
+            int l_lo[N_RANK], l_hi[N_RANK];
+            if (!ghostFlag_ || (bkind_ == Pochoir_Bdry_User && !user_bdry()))
+                return;
+            for (int i = 0; i < N_RANK; ++i) {
+                l_lo[i] = -ghost_[i]; l_hi[i] = phys_size_[i] + ghost_[i];
+            }
+            if (bkind_ == Pochoir_Bdry_Constant) {
+                for (int t = 0; t < toggle_; ++t)
+                    fill_ghost(t, l_lo, l_hi);
+                return;
+            }
+            for (int s = ghost_t0_; s < ghost_t1_; ++s)
+                fill_ghost(_t + s, l_lo, l_hi);
+        }
+
         /* 
          * orig_value() is reserved for "ostream" : cout << Pochoir_Array
          */
@@ -667,35 +1433,23 @@ class Pochoir_Array {
             bool l_boundary = check_boundary(_idx);
             bool set_boundary = false;
             T l_bvalue = 0;
-            if (l_boundary && bv1_ != NULL) {
-                l_bvalue = bv1_(*this, _timestep, _idx[0]);
-                set_boundary = true;
-            } else if (l_boundary && bv2_ != NULL) {
-                l_bvalue = bv2_(*this, _timestep, _idx[1], _idx[0]);
-                set_boundary = true;
-            } else if (l_boundary && bv3_ != NULL) {
-                l_bvalue = bv3_(*this, _timestep, _idx[2], _idx[1], _idx[0]);
-                set_boundary = true;
-            } else if (l_boundary && bv4_ != NULL) {
-                l_bvalue = bv4_(*this, _timestep, _idx[3], _idx[2], _idx[1], _idx[0]);
-                set_boundary = true;
-            } else if (l_boundary && bv5_ != NULL) {
-                l_bvalue = bv5_(*this, _timestep, _idx[4], _idx[3], _idx[2], _idx[1], _idx[0]);
-                set_boundary = true;
-            } else if (l_boundary && bv6_ != NULL) {
-                l_bvalue = bv6_(*this, _timestep, _idx[5], _idx[4], _idx[3], _idx[2], _idx[1], _idx[0]);
+            if (l_boundary && bkind_ == Pochoir_Bdry_Constant) {
+                l_bvalue = bconst_;
                 set_boundary = true;
-            } else if (l_boundary && bv7_ != NULL) {
-                l_bvalue = bv7_(*this, _timestep, _idx[6], _idx[5], _idx[4], _idx[3], _idx[2], _idx[1], _idx[0]);
+            } else if (l_boundary && bkind_ != Pochoir_Bdry_User) {
+                size_info l_bidx;
+                for (int i = 0; i < N_RANK; ++i)
+                    l_bidx[i] = bdry_index(bkind_, _idx[i], logic_start_[i], logic_end_[i]);
+                l_bvalue = data_[cal_index<N_RANK-1>(l_bidx, stride_) + plane_offset(_timestep)];
                 set_boundary = true;
-            } else if (l_boundary && bv8_ != NULL) {
-                l_bvalue = bv8_(*this, _timestep, _idx[7], _idx[6], _idx[5], _idx[4], _idx[3], _idx[2], _idx[1], _idx[0]);
+            } else if (l_boundary && user_bdry()) {
+                l_bvalue = Pochoir_BValue_Apply<N_RANK>::apply(BCall::fn(bv_), *this, _timestep, _idx);
                 set_boundary = true;
             }
 
             /* the highest dimension is time dimension! */
-            int l_idx = cal_index<N_RANK>(_idx, stride_) + (_timestep % toggle_) * total_size_;
-            return (set_boundary) ? l_bvalue : (*view_)[l_idx];
+            int l_idx = cal_index<N_RANK-1>(_idx, stride_) + plane_offset(_timestep);
+            return (set_boundary) ? l_bvalue : data_[l_idx];
         }
 
 		/* index operator() for the format of a(i, j, k) 
@@ -725,13 +1479,17 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary1(_idx1, _idx0);
-            bool set_boundary = (l_boundary && bv1_ != NULL);
-            if (set_boundary) { 
-                ret_v() = bv1_(*this, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary1(_idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + plane_offset(_idx1);
             return (*(data_ + l_idx));
 		}
 
@@ -763,13 +1521,17 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary2(_idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv2_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv2_(*this, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary2(_idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + plane_offset(_idx2);
             return (*(data_ + l_idx));
 		}
 
@@ -797,13 +1559,17 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary3(_idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv3_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv3_(*this, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary3(_idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + plane_offset(_idx3);
             return (*(data_ + l_idx));
 		}
 
@@ -831,13 +1597,17 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary4(_idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv4_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv4_(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary4(_idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + plane_offset(_idx4);
             return (*(data_ + l_idx));
 		}
 
@@ -866,13 +1636,17 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary5(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv5_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv5_(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary5(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + plane_offset(_idx5);
             return (*(data_ + l_idx));
 		}
 
@@ -901,13 +1675,17 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary6(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv6_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv6_(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary6(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + plane_offset(_idx6);
             return (*(data_ + l_idx));
 		}
 
@@ -937,13 +1715,17 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary7(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv7_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv7_(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary7(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + plane_offset(_idx7);
             return (*(data_ + l_idx));
 		}
 
@@ -973,55 +1755,59 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv8_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv8_(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + plane_offset(_idx8);
             return (*(data_ + l_idx));
 		}
 
         /* set()/get() pair to set/get boundary value in user supplied bvalue function */
 		inline T & set (int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + plane_offset(_idx1);
+			return data_[l_idx];
 		}
 
 		inline T & set (int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + plane_offset(_idx2);
+			return data_[l_idx];
 		}
 
 		inline T & set (int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + plane_offset(_idx3);
+			return data_[l_idx];
 		}
 
 		inline T & set (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + plane_offset(_idx4);
+			return data_[l_idx];
 		}
 
 		inline T & set (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + plane_offset(_idx5);
+			return data_[l_idx];
 		}
 
 		inline T & set (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + plane_offset(_idx6);
+			return data_[l_idx];
 		}
 
 		inline T & set (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + plane_offset(_idx7);
+			return data_[l_idx];
 		}
 
 		inline T & set (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8i % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + plane_offset(_idx8);
+			return data_[l_idx];
 		}
 
 		inline T get (int _idx1, int _idx0) {
@@ -1030,8 +1816,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d)\n", _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + plane_offset(_idx1);
+			return data_[l_idx];
 		}
 
 		inline T get (int _idx2, int _idx1, int _idx0) {
@@ -1040,8 +1826,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d)\n", _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + plane_offset(_idx2);
+			return data_[l_idx];
 		}
 
 		inline T get (int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1050,8 +1836,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d)\n", _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + plane_offset(_idx3);
+			return data_[l_idx];
 		}
 
 		inline T get (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1060,8 +1846,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d)\n", _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + plane_offset(_idx4);
+			return data_[l_idx];
 		}
 
 		inline T get (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1070,8 +1856,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d)\n", _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + plane_offset(_idx5);
+			return data_[l_idx];
 		}
 
 		inline T get (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1080,8 +1866,8 @@ class Pochoir_Array {
                 printf("Out-of-range accesss by boundary function at index (%d, %d, %d, %d, %d, %d, %d)\n", _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + plane_offset(_idx6);
+			return data_[l_idx];
 		}
 
 		inline T get (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1090,8 +1876,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d, %d, %d)\n", _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + plane_offset(_idx7);
+			return data_[l_idx];
 		}
 
 		inline T get (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1100,8 +1886,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d, %d, %d, %d)\n", _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + plane_offset(_idx8);
+			return data_[l_idx];
 		}
 
 		/* index operator() for the format of a.interior(i, j, k) 
@@ -1110,130 +1896,162 @@ class Pochoir_Array {
          */
 
 		inline T & interior (int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + plane_offset(_idx1);
+			return data_[l_idx];
 		}
 
 		inline T & interior (int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + plane_offset(_idx2);
+			return data_[l_idx];
 		}
 
 		inline T & interior (int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + plane_offset(_idx3);
+			return data_[l_idx];
 		}
 
 		inline T & interior (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + plane_offset(_idx4);
+			return data_[l_idx];
 		}
 
 		inline T & interior (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5i % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + plane_offset(_idx5);
+			return data_[l_idx];
 		}
 
 		inline T & interior (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + plane_offset(_idx6);
+			return data_[l_idx];
 		}
 
 		inline T & interior (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + plane_offset(_idx7);
+			return data_[l_idx];
 		}
 
 		inline T & interior (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + plane_offset(_idx8);
+			return data_[l_idx];
 		}
 
 		inline T & boundary (int _idx1, int _idx0) {
-            bool l_boundary = check_boundary1(_idx1, _idx0);
-            bool set_boundary = (l_boundary && bv1_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv1_(*this, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary1(_idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + plane_offset(_idx1);
             return (*(data_ + l_idx));
 		}
 
 		inline T & boundary (int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary2(_idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv2_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv2_(*this, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary2(_idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + plane_offset(_idx2);
             return (*(data_ + l_idx));
 		}
 
 		inline T & boundary (int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary3(_idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv3_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv3_(*this, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary3(_idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + plane_offset(_idx3);
             return (*(data_ + l_idx));
 		}
 
 		inline T & boundary (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary4(_idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv4_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv4_(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary4(_idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + plane_offset(_idx4);
             return (*(data_ + l_idx));
 		}
 
 		inline T & boundary (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary5(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv5_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv5_(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary5(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + plane_offset(_idx5);
             return (*(data_ + l_idx));
 		}
 
 		inline T & boundary (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary6(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv6_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv6_(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary6(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + plane_offset(_idx6);
             return (*(data_ + l_idx));
 		}
 
 		inline T & boundary (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary7(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv7_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv7_(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary7(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + plane_offset(_idx7);
             return (*(data_ + l_idx));
 		}
 
 		inline T & boundary (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv8_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv8_(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+            if (check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (bkind_ == Pochoir_Bdry_Constant)
+                    return bconst_;
+                if (bkind_ != Pochoir_Bdry_User)
+                    return bdry_value(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                if (user_bdry()) {
+                    ret_v() = BCall::fn(bv_)(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return ret_v();
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
+			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + plane_offset(_idx8);
             return (*(data_ + l_idx));
 		}
 
@@ -1258,14 +2076,14 @@ class Pochoir_Array {
 		}
 
 #if 1
-		template <typename T2, int N2>
-		friend std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2> const & x); 
+		template <typename T2, int N2, int G2>
+		friend std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2, G2> const & x); 
 #endif
 };
 
 #if 1
-template<typename T2, int N2>
-std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2> const & x) { 
+template<typename T2, int N2, int G2>
+std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2, G2> const & x) { 
 	typedef int size_info[N2];
 	size_info l_index, l_head_index, l_tail_index;
 	bool done = false, line_break = false;
@@ -1282,10 +2100,10 @@ std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2> const & x) {
 
 	while (!done) {
 		T2 x0, x1;
-		x0 = const_cast<Pochoir_Array<T2, N2> &>(x).orig_value(0, l_index);
-		x1 = const_cast<Pochoir_Array<T2, N2> &>(x).orig_value(1, l_index);
+		x0 = const_cast<Pochoir_Array<T2, N2, G2> &>(x).orig_value(0, l_index);
+		x1 = const_cast<Pochoir_Array<T2, N2, G2> &>(x).orig_value(1, l_index);
 		os << std::setw(9) << x0 << " (" << x1 << ")" << " "; 
-		done = const_cast<Pochoir_Array<T2, N2> &>(x).update_index(l_index, line_break, l_head_index, l_tail_index);
+		done = const_cast<Pochoir_Array<T2, N2, G2> &>(x).update_index(l_index, line_break, l_head_index, l_tail_index);
 		if (line_break) {
 			os << std::endl;
 			line_break = false;
@@ -100,6 +100,180 @@ struct Pochoir_Shape {
 template <int N_RANK, size_t N>
 size_t ArraySize (Pochoir_Shape<N_RANK> (& arr)[N]) { return N; }
 
+/* built-in boundary conditions of an array, resolved inline by the array
+ * accessors instead of calling out to a boundary function :
+ * - Pochoir_Bdry_Zero / Pochoir_Bdry_Constant : an off-domain cell reads
+ *   T() / the registered constant
+ * - Pochoir_Bdry_Periodic : the index wraps around the domain
+ * - Pochoir_Bdry_Mirror : the index reflects about the domain edge,
+ *   the edge cell included (-1 reads 0, -2 reads 1)
+ * - Pochoir_Bdry_Clamp : the index sticks to the nearest edge cell
+ * Pochoir_Bdry_User is a user supplied boundary function (or none).
+ */
+enum Pochoir_Boundary_Kind {
+    Pochoir_Bdry_User = 0,
+    Pochoir_Bdry_Zero,
+    Pochoir_Bdry_Constant,
+    Pochoir_Bdry_Periodic,
+    Pochoir_Bdry_Mirror,
+    Pochoir_Bdry_Clamp
+};
+
+/* the user supplied boundary function of an array A of rank N_RANK */
+template <typename A, typename T, int N_RANK>
+struct Pochoir_BValue;
+
+template <typename A, typename T>
+struct Pochoir_BValue<A, T, 1> { typedef T (*type)(A &, int, int); };
+template <typename A, typename T>
+struct Pochoir_BValue<A, T, 2> { typedef T (*type)(A &, int, int, int); };
+template <typename A, typename T>
+struct Pochoir_BValue<A, T, 3> { typedef T (*type)(A &, int, int, int, int); };
+template <typename A, typename T>
+struct Pochoir_BValue<A, T, 4> { typedef T (*type)(A &, int, int, int, int, int); };
+template <typename A, typename T>
+struct Pochoir_BValue<A, T, 5> { typedef T (*type)(A &, int, int, int, int, int, int); };
+template <typename A, typename T>
+struct Pochoir_BValue<A, T, 6> { typedef T (*type)(A &, int, int, int, int, int, int, int); };
+template <typename A, typename T>
+struct Pochoir_BValue<A, T, 7> { typedef T (*type)(A &, int, int, int, int, int, int, int, int); };
+template <typename A, typename T>
+struct Pochoir_BValue<A, T, 8> { typedef T (*type)(A &, int, int, int, int, int, int, int, int, int); };
+
+/* the boundary functor type of an array with none : the array calls the
+ * boundary function registered by Register_Boundary() through a pointer
+ */
+struct Pochoir_Bdry_Fn_Ptr { };
+
+/* BCall::fn(bv) is what an array calls for a user boundary value, the
+ * functor BF of the array type, which the compiler can inline, or the 
+ * registered function pointer bv if BF is Pochoir_Bdry_Fn_Ptr
+ */
+template <typename BF, typename BV>
+struct Pochoir_Bdry_Call {
+    enum { functor = 1 };
+    static inline BF fn(BV) { return BF(); }
+};
+
+template <typename BV>
+struct Pochoir_Bdry_Call<Pochoir_Bdry_Fn_Ptr, BV> {
+    enum { functor = 0 };
+    static inline BV fn(BV bv) { return bv; }
+};
+
+/* call a boundary function or functor with the spatial index packed in 
+ * idx[], idx[0] being the unit-stride dimension
+ */
+template <int N_RANK>
+struct Pochoir_BValue_Apply;
+
+template <>
+struct Pochoir_BValue_Apply<1> {
+    template <typename BV, typename A>
+    static inline auto apply(BV const & bv, A & a, int t, int const * idx) -> decltype(bv(a, t, idx[0])) {
+        return bv(a, t, idx[0]);
+    }
+};
+template <>
+struct Pochoir_BValue_Apply<2> {
+    template <typename BV, typename A>
+    static inline auto apply(BV const & bv, A & a, int t, int const * idx) -> decltype(bv(a, t, idx[1], idx[0])) {
+        return bv(a, t, idx[1], idx[0]);
+    }
+};
+template <>
+struct Pochoir_BValue_Apply<3> {
+    template <typename BV, typename A>
+    static inline auto apply(BV const & bv, A & a, int t, int const * idx) -> decltype(bv(a, t, idx[2], idx[1], idx[0])) {
+        return bv(a, t, idx[2], idx[1], idx[0]);
+    }
+};
+template <>
+struct Pochoir_BValue_Apply<4> {
+    template <typename BV, typename A>
+    static inline auto apply(BV const & bv, A & a, int t, int const * idx) -> decltype(bv(a, t, idx[3], idx[2], idx[1], idx[0])) {
+        return bv(a, t, idx[3], idx[2], idx[1], idx[0]);
+    }
+};
+template <>
+struct Pochoir_BValue_Apply<5> {
+    template <typename BV, typename A>
+    static inline auto apply(BV const & bv, A & a, int t, int const * idx) -> decltype(bv(a, t, idx[4], idx[3], idx[2], idx[1], idx[0])) {
+        return bv(a, t, idx[4], idx[3], idx[2], idx[1], idx[0]);
+    }
+};
+template <>
+struct Pochoir_BValue_Apply<6> {
+    template <typename BV, typename A>
+    static inline auto apply(BV const & bv, A & a, int t, int const * idx) -> decltype(bv(a, t, idx[5], idx[4], idx[3], idx[2], idx[1], idx[0])) {
+        return bv(a, t, idx[5], idx[4], idx[3], idx[2], idx[1], idx[0]);
+    }
+};
+template <>
+struct Pochoir_BValue_Apply<7> {
+    template <typename BV, typename A>
+    static inline auto apply(BV const & bv, A & a, int t, int const * idx) -> decltype(bv(a, t, idx[6], idx[5], idx[4], idx[3], idx[2], idx[1], idx[0])) {
+        return bv(a, t, idx[6], idx[5], idx[4], idx[3], idx[2], idx[1], idx[0]);
+    }
+};
+template <>
+struct Pochoir_BValue_Apply<8> {
+    template <typename BV, typename A>
+    static inline auto apply(BV const & bv, A & a, int t, int const * idx) -> decltype(bv(a, t, idx[7], idx[6], idx[5], idx[4], idx[3], idx[2], idx[1], idx[0])) {
+        return bv(a, t, idx[7], idx[6], idx[5], idx[4], idx[3], idx[2], idx[1], idx[0]);
+    }
+};
+
+/* map an off-domain index of a built-in Periodic/Mirror/Clamp boundary
+ * back into [lb, ub)
+ */
+static inline int bdry_index(Pochoir_Boundary_Kind kind, int idx, int lb, int ub) {
+    if (idx >= lb && idx < ub)
+        return idx;
+    int const l_n = ub - lb;
+    int l_i;
+    switch (kind) {
+        case Pochoir_Bdry_Periodic:
+            l_i = (idx - lb) % l_n;
+            return lb + (l_i < 0 ? l_i + l_n : l_i);
+        case Pochoir_Bdry_Mirror:
+            l_i = (idx - lb) % (2 * l_n);
+            l_i = (l_i < 0 ? l_i + 2 * l_n : l_i);
+            return lb + (l_i < l_n ? l_i : 2 * l_n - 1 - l_i);
+        default:
+            return (idx < lb ? lb : ub - 1);
+    }
+}
+
+/* the number of time planes an array has to keep, given the entries of
+ * the shape[] through which the kernel reads it, and the home time shift
+ * it is written at. A plane is live from its write until the oldest time
+ * shift reading it; if that oldest shift is only read at the home cell,
+ * the write of the home cell takes over its storage in place.
+ * Returns 0 for an entry later than home.
+ */
+template <int N_RANK>
+static inline int live_toggle(Pochoir_Shape<N_RANK> const * shape, int shape_size, int home) {
+    int l_min_time_shift = home;
+    for (int i = 0; i < shape_size; ++i) {
+        if (shape[i].shift[0] > home)
+            return 0;
+        if (shape[i].shift[0] < l_min_time_shift)
+            l_min_time_shift = shape[i].shift[0];
+    }
+    int l_toggle = home - l_min_time_shift + 1;
+    bool l_home_only = (l_min_time_shift < home);
+    for (int i = 0; i < shape_size && l_home_only; ++i) {
+        if (shape[i].shift[0] != l_min_time_shift)
+            continue;
+        for (int r = 1; r < N_RANK+1; ++r) {
+            if (shape[i].shift[r] != 0)
+                l_home_only = false;
+        }
+    }
+    return (l_home_only ? l_toggle - 1 : l_toggle);
+}
+
 #define KLEIN 0
 #define USE_CILK_FOR 0
 #define BICUT 1
@@ -174,6 +348,27 @@ static inline void klein_region(grid_info<2> & grid, grid_info<2> const & initia
 #define Pochoir_Array_7D(type) Pochoir_Array<type, 7>
 #define Pochoir_Array_8D(type) Pochoir_Array<type, 8>
 
+/* an array whose user boundary is the function 'bdry' of a Pochoir_Boundary_*D
+ * definition, called through its functor bdry##_Fn rather than a pointer
+ */
+#define Pochoir_Array_Bdry_1D(type, bdry) Pochoir_Array<type, 1, 0, bdry##_Fn>
+#define Pochoir_Array_Bdry_2D(type, bdry) Pochoir_Array<type, 2, 0, bdry##_Fn>
+#define Pochoir_Array_Bdry_3D(type, bdry) Pochoir_Array<type, 3, 0, bdry##_Fn>
+#define Pochoir_Array_Bdry_4D(type, bdry) Pochoir_Array<type, 4, 0, bdry##_Fn>
+#define Pochoir_Array_Bdry_5D(type, bdry) Pochoir_Array<type, 5, 0, bdry##_Fn>
+#define Pochoir_Array_Bdry_6D(type, bdry) Pochoir_Array<type, 6, 0, bdry##_Fn>
+#define Pochoir_Array_Bdry_7D(type, bdry) Pochoir_Array<type, 7, 0, bdry##_Fn>
+#define Pochoir_Array_Bdry_8D(type, bdry) Pochoir_Array<type, 8, 0, bdry##_Fn>
+
+#define Pochoir_SoA_Array_1D(type) Pochoir_SoA_Array<type, 1>
+#define Pochoir_SoA_Array_2D(type) Pochoir_SoA_Array<type, 2>
+#define Pochoir_SoA_Array_3D(type) Pochoir_SoA_Array<type, 3>
+#define Pochoir_SoA_Array_4D(type) Pochoir_SoA_Array<type, 4>
+#define Pochoir_SoA_Array_5D(type) Pochoir_SoA_Array<type, 5>
+#define Pochoir_SoA_Array_6D(type) Pochoir_SoA_Array<type, 6>
+#define Pochoir_SoA_Array_7D(type) Pochoir_SoA_Array<type, 7>
+#define Pochoir_SoA_Array_8D(type) Pochoir_SoA_Array<type, 8>
+
 #define Pochoir_Shape_1D Pochoir_Shape<1>
 #define Pochoir_Shape_2D Pochoir_Shape<2>
 #define Pochoir_Shape_3D Pochoir_Shape<3>
@@ -236,43 +431,92 @@ static inline void klein_region(grid_info<2> & grid, grid_info<2> const & initia
 #define Pochoir_Obase_Fn_8D(name, t0, t1, grid) \
     auto name = [&](int t0, int t1, grid_info<8> const & grid) {
 
-/* - these function templates are for computing boundary values, currently
- *   icc doesn't support capturing the lambda function by function objects,
- *   so, we have to utilize the function pointers!
+/* - these function templates are for computing boundary values, either
+ *   registered by pointer with Register_Boundary(name), or, with the 
+ *   functor name##_Fn in the array type (Pochoir_Array_Bdry_*D), called
+ *   directly so that the compiler can inline them;
  * - because these functions will be called inside T & operator() functions,
  *   so we have to return a value of T&
  */
 #define Pochoir_Boundary_1D(name, arr, t, i) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 1> & arr, int t, int i) { 
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 1, N_TOGGLE, BF> & arr, int t, int i); \
+    struct name##_Fn { \
+        template <typename A> \
+        inline auto operator() (A & arr, int t, int i) const -> decltype(name(arr, t, i)) { return name(arr, t, i); } \
+    }; \
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 1, N_TOGGLE, BF> & arr, int t, int i) { 
 
 #define Pochoir_Boundary_2D(name, arr, t, i, j) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 2> & arr, int t, int i, int j) { 
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 2, N_TOGGLE, BF> & arr, int t, int i, int j); \
+    struct name##_Fn { \
+        template <typename A> \
+        inline auto operator() (A & arr, int t, int i, int j) const -> decltype(name(arr, t, i, j)) { return name(arr, t, i, j); } \
+    }; \
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 2, N_TOGGLE, BF> & arr, int t, int i, int j) { 
 
 #define Pochoir_Boundary_3D(name, arr, t, i, j, k) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 3> & arr, int t, int i, int j, int k) { 
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 3, N_TOGGLE, BF> & arr, int t, int i, int j, int k); \
+    struct name##_Fn { \
+        template <typename A> \
+        inline auto operator() (A & arr, int t, int i, int j, int k) const -> decltype(name(arr, t, i, j, k)) { return name(arr, t, i, j, k); } \
+    }; \
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 3, N_TOGGLE, BF> & arr, int t, int i, int j, int k) { 
 
 #define Pochoir_Boundary_4D(name, arr, t, i, j, k, l) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 4> & arr, int t, int i, int j, int k, int l) { 
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 4, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l); \
+    struct name##_Fn { \
+        template <typename A> \
+        inline auto operator() (A & arr, int t, int i, int j, int k, int l) const -> decltype(name(arr, t, i, j, k, l)) { return name(arr, t, i, j, k, l); } \
+    }; \
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 4, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l) { 
 
 #define Pochoir_Boundary_5D(name, arr, t, i, j, k, l, m) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 5> & arr, int t, int i, int j, int k, int l, int m) { 
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 5, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l, int m); \
+    struct name##_Fn { \
+        template <typename A> \
+        inline auto operator() (A & arr, int t, int i, int j, int k, int l, int m) const -> decltype(name(arr, t, i, j, k, l, m)) { return name(arr, t, i, j, k, l, m); } \
+    }; \
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 5, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l, int m) { 
 
 #define Pochoir_Boundary_6D(name, arr, t, i, j, k, l, m, n) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 6> & arr, int t, int i, int j, int k, int l, int m, int n) { 
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 6, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l, int m, int n); \
+    struct name##_Fn { \
+        template <typename A> \
+        inline auto operator() (A & arr, int t, int i, int j, int k, int l, int m, int n) const -> decltype(name(arr, t, i, j, k, l, m, n)) { return name(arr, t, i, j, k, l, m, n); } \
+    }; \
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 6, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l, int m, int n) { 
 
 #define Pochoir_Boundary_7D(name, arr, t, i, j, k, l, m, n, o) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 7> & arr, int t, int i, int j, int k, int l, int m, int n, int o) { 
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 7, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l, int m, int n, int o); \
+    struct name##_Fn { \
+        template <typename A> \
+        inline auto operator() (A & arr, int t, int i, int j, int k, int l, int m, int n, int o) const -> decltype(name(arr, t, i, j, k, l, m, n, o)) { return name(arr, t, i, j, k, l, m, n, o); } \
+    }; \
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 7, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l, int m, int n, int o) { 
 
 #define Pochoir_Boundary_8D(name, arr, t, i, j, k, l, m, n, o, p) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 8> & arr, int t, int i, int j, int k, int l, int m, int n, int o, int p) { 
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 8, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l, int m, int n, int o, int p); \
+    struct name##_Fn { \
+        template <typename A> \
+        inline auto operator() (A & arr, int t, int i, int j, int k, int l, int m, int n, int o, int p) const -> decltype(name(arr, t, i, j, k, l, m, n, o, p)) { return name(arr, t, i, j, k, l, m, n, o, p); } \
+    }; \
+    template <typename T, int N_TOGGLE, typename BF> \
+    T name (Pochoir_Array<T, 8, N_TOGGLE, BF> & arr, int t, int i, int j, int k, int l, int m, int n, int o, int p) { 
 
 #define Pochoir_Boundary_End }
 
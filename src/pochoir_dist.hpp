@@ -0,0 +1,330 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ ********************************************************************************/
+
+#ifndef POCHOIR_DIST_H
+#define POCHOIR_DIST_H
+
+#include <climits>
+#include "pochoir.hpp"
+#include "pochoir_transport.hpp"
+
+/* Distributed Pochoir : the outermost dimension of the grid is split 
+ * into contiguous runs of rows, one per rank of a Pochoir_Transport. 
+ * Each rank keeps its rows plus a halo of H rows on each side which has
+ * a neighbor (periodic : all of them) in its own Pochoir_Arrays, of 
+ * Local_Size() rows, row 0 being the global row Local_Begin(). 
+ * The time steps are run in slabs of dt steps. Before each slab the 
+ * ranks exchange their halos, then each rank runs the cache-oblivious 
+ * walker over the upright trapezoid which shrinks from its rows plus the
+ * halos down to its own rows at the top of the slab. The rows of the 
+ * halos are computed twice, by the owner and the neighbor, which saves 
+ * all the communication within the slab. H = slope * (dt + depth - 1),
+ * slope and depth of the shape along the outermost dimension.
+ *
+ *      Pochoir_Socket_Transport comm(4);
+ *      Pochoir_Dist_2D dist(comm, shape, N);
+ *      Pochoir_Array_2D(double) a(dist.Local_Size(), NX);
+ *      ... register a with the Pochoir object p and with dist, 
+ *      ... init the rows [Own_Begin(), Own_End()) of a
+ *      dist.Run(p, T, f, bf);
+ *
+ * After the run only the own rows of the arrays are up to date. On the 
+ * ranks at the ends of a non-periodic grid, the rows out of the grid 
+ * are read through the boundary function of the arrays, as without 
+ * distribution.
+ *
+ * With Overlap(), each slab is cut along the outermost dimension into
+ * an inner trapezoid, whose dependencies stay within the own rows, and
+ * the two parallelograms between it and the halos. The halo exchange 
+ * is posted, the inner zoid runs while it is in flight, and the two 
+ * edge zoids run once the halos have arrived.
+ */
+template <int N_RANK>
+class Pochoir_Dist {
+    private:
+        struct dist_arr {
+            void * arr_;
+            char * (*rows_)(void *, int, int);
+            size_t (*row_bytes_)(void *);
+            int (*toggle_)(void *);
+        };
+        Pochoir_Transport & comm_;
+        int n_global_, lo_, n_;
+        bool periodic_, overlap_;
+        int slope_, depth_, dt_, halo_;
+        /* the kernel at step t reads the time planes t + shift[0] for the
+         * shift[0] of the shape, up to t + t_last_
+         */
+        int t_last_;
+        int up_, down_, halo_lo_, halo_hi_;
+        std::vector<dist_arr> arr_;
+        /* copies of the rows sent by an overlapped exchange */
+        std::vector<char> sbuf_;
+
+        template <typename T, int N_TOGGLE, typename BF>
+        static char * arr_rows(void * _arr, int _p, int _r) {
+            return (char *)static_cast<Pochoir_Array<T, N_RANK, N_TOGGLE, BF> *>(_arr)->rows(_p, _r);
+        }
+        template <typename T, int N_TOGGLE, typename BF>
+        static size_t arr_row_bytes(void * _arr) {
+            return static_cast<Pochoir_Array<T, N_RANK, N_TOGGLE, BF> *>(_arr)->row_size() * sizeof(T);
+        }
+        template <typename T, int N_TOGGLE, typename BF>
+        static int arr_toggle(void * _arr) {
+            return static_cast<Pochoir_Array<T, N_RANK, N_TOGGLE, BF> *>(_arr)->toggle();
+        }
+        void error(char const * _what) {
+            printf("Pochoir_Dist error on rank %d:\n", comm_.rank());
+            printf("%s\n", _what);
+            exit(1);
+        }
+        void post_exchange(int t, bool copy);
+        void start(Pochoir<N_RANK> & p, Algorithm<N_RANK> & algor, int timestep);
+        grid_info<N_RANK> slab_grid(Pochoir<N_RANK> & p, int lt);
+        bool inner_grid(grid_info<N_RANK> const & grid, int lt, grid_info<N_RANK> & inner);
+        template <typename W>
+        void run_slabs(Pochoir<N_RANK> & p, int timestep, W const & walk);
+    public:
+        /* dt = 0 picks the slab height so that a halo is a quarter of the 
+         * rows of a rank
+         */
+        template <size_t N_SIZE>
+        Pochoir_Dist(Pochoir_Transport & _comm, Pochoir_Shape<N_RANK> (& _shape)[N_SIZE], int _n, bool _periodic = false, int _dt = 0);
+        /* the global rows of the rank are [Own_Begin(), Own_End()) in the
+         * local arrays, and [Global_Begin(), Global_Begin() + Own_End() - 
+         * Own_Begin()) in the grid
+         */
+        int Local_Size(void) const { return halo_lo_ + n_ + halo_hi_; }
+        int Local_Begin(void) const { return lo_ - halo_lo_; }
+        int Own_Begin(void) const { return halo_lo_; }
+        int Own_End(void) const { return halo_lo_ + n_; }
+        int Global_Begin(void) const { return lo_; }
+        int Halo(void) const { return halo_; }
+        int Slab(void) const { return dt_; }
+        Pochoir_Transport & Transport(void) { return comm_; }
+        /* hide the halo exchange behind the inner zoid of each slab */
+        void Overlap(bool _overlap = true) { overlap_ = _overlap; }
+        /* the arrays to exchange, which are also registered with the 
+         * Pochoir object
+         */
+        template <typename T, int N_TOGGLE, typename BF>
+        void Register_Array(Pochoir_Array<T, N_RANK, N_TOGGLE, BF> & arr);
+        template <typename F, typename BF>
+        void Run(Pochoir<N_RANK> & p, int timestep, F const & f, BF const & bf);
+        template <typename F, typename BF>
+        void Run_Obase(Pochoir<N_RANK> & p, int timestep, F const & f, BF const & bf);
+};
+
+#define Pochoir_Dist_1D Pochoir_Dist<1>
+#define Pochoir_Dist_2D Pochoir_Dist<2>
+#define Pochoir_Dist_3D Pochoir_Dist<3>
+
+template <int N_RANK> template <size_t N_SIZE>
+Pochoir_Dist<N_RANK>::Pochoir_Dist(Pochoir_Transport & _comm, Pochoir_Shape<N_RANK> (& _shape)[N_SIZE], int _n, bool _periodic, int _dt) : comm_(_comm), n_global_(_n), periodic_(_periodic), overlap_(false) {
+    int const l_rank = comm_.rank(), l_size = comm_.size();
+    int l_min_t = _shape[0].shift[0], l_max_t = _shape[0].shift[0];
+
+    /* the rows of the rank */
+    n_ = n_global_ / l_size + (l_rank < n_global_ % l_size);
+    lo_ = l_rank * (n_global_ / l_size) + min(l_rank, n_global_ % l_size);
+
+    /* slope and depth along the outermost dimension, as Pochoir does */
+    for (size_t i = 0; i < N_SIZE; ++i) {
+        l_min_t = min(l_min_t, _shape[i].shift[0]);
+        l_max_t = max(l_max_t, _shape[i].shift[0]);
+    }
+    depth_ = l_max_t - l_min_t;
+    t_last_ = l_max_t - 1;
+    slope_ = 0;
+    for (size_t i = 0; i < N_SIZE; ++i) {
+        if (_shape[i].shift[0] < l_max_t)
+            slope_ = max(slope_, abs((int)ceil((float)_shape[i].shift[1]/(l_max_t - _shape[i].shift[0]))));
+    }
+
+    int const l_min_rows = n_global_ / l_size;
+    if (_dt > 0)
+        dt_ = _dt;
+    else if (slope_ > 0)
+        dt_ = max(1, l_min_rows / (4 * slope_) - (depth_ - 1));
+    else
+        dt_ = INT_MAX / 2;
+    up_ = (l_rank + 1 < l_size) ? l_rank + 1 : (periodic_ ? 0 : -1);
+    down_ = (l_rank > 0) ? l_rank - 1 : (periodic_ ? l_size - 1 : -1);
+    halo_ = (up_ >= 0 || down_ >= 0) ? slope_ * ((slope_ > 0) ? dt_ + depth_ - 1 : 0) : 0;
+    if (halo_ > l_min_rows)
+        error("the halo is wider than the rows of a rank, use fewer ranks or a lower slab");
+    halo_lo_ = (down_ >= 0) ? halo_ : 0;
+    halo_hi_ = (up_ >= 0) ? halo_ : 0;
+}
+
+template <int N_RANK> template <typename T, int N_TOGGLE, typename BF>
+void Pochoir_Dist<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK, N_TOGGLE, BF> & arr) {
+    dist_arr l_arr;
+    if (arr.size(N_RANK-1) != Local_Size())
+        error("the outermost dimension of an array is not Local_Size()");
+    l_arr.arr_ = &arr;
+    l_arr.rows_ = arr_rows<T, N_TOGGLE, BF>;
+    l_arr.row_bytes_ = arr_row_bytes<T, N_TOGGLE, BF>;
+    l_arr.toggle_ = arr_toggle<T, N_TOGGLE, BF>;
+    arr_.push_back(l_arr);
+}
+
+/* send the top rows of the rank up while the low halo comes from below,
+ * then the other way round, in the time planes t - depth + 1 .. t.
+ * The exchanges are posted to the transport, with copies of the rows
+ * sent if the caller goes on computing before comm_.wait().
+ */
+template <int N_RANK>
+void Pochoir_Dist<N_RANK>::post_exchange(int t, bool copy) {
+    if (halo_ == 0)
+        return;
+    size_t l_total = 0;
+    for (size_t k = 0; k < arr_.size(); ++k)
+        l_total += 2 * depth_ * halo_ * arr_[k].row_bytes_(arr_[k].arr_);
+    if (copy && sbuf_.size() < l_total)
+        sbuf_.resize(l_total);
+    char * l_sbuf = copy ? &sbuf_[0] : NULL;
+    for (size_t k = 0; k < arr_.size(); ++k) {
+        dist_arr const & l_arr = arr_[k];
+        size_t const l_bytes = halo_ * l_arr.row_bytes_(l_arr.arr_);
+        int const l_toggle = l_arr.toggle_(l_arr.arr_);
+        for (int l_t = t - depth_ + 1; l_t <= t; ++l_t) {
+            int const q = l_t % l_toggle;
+            char * l_up = l_arr.rows_(l_arr.arr_, q, halo_lo_ + n_ - halo_);
+            char * l_down = l_arr.rows_(l_arr.arr_, q, halo_lo_);
+            if (copy) {
+                memcpy(l_sbuf, l_up, l_bytes);
+                memcpy(l_sbuf + l_bytes, l_down, l_bytes);
+                l_up = l_sbuf; l_down = l_sbuf + l_bytes;
+                l_sbuf += 2 * l_bytes;
+            }
+            comm_.post(up_, l_up, l_bytes, down_, l_arr.rows_(l_arr.arr_, q, 0), l_bytes);
+            comm_.post(down_, l_down, l_bytes, up_, l_arr.rows_(l_arr.arr_, q, halo_lo_ + n_), l_bytes);
+        }
+    }
+    comm_.begin();
+}
+
+template <int N_RANK>
+void Pochoir_Dist<N_RANK>::start(Pochoir<N_RANK> & p, Algorithm<N_RANK> & algor, int timestep) {
+    p.timestep_ = timestep;
+    p.checkFlags();
+    p.dirtyFiles();
+    if (p.logic_grid_.x0[N_RANK-1] != 0 || p.logic_grid_.x1[N_RANK-1] != Local_Size())
+        error("the domain of the Pochoir object is not the Local_Size() rows");
+    algor.set_phys_grid(p.phys_grid_);
+    algor.set_thres(p.arr_type_size_);
+}
+
+/* the zoid of a slab of lt steps, it ends on the own rows */
+template <int N_RANK>
+grid_info<N_RANK> Pochoir_Dist<N_RANK>::slab_grid(Pochoir<N_RANK> & p, int lt) {
+    grid_info<N_RANK> l_grid = p.logic_grid_;
+    int const d = N_RANK-1;
+    if (halo_lo_ > 0) {
+        l_grid.x0[d] = halo_lo_ - slope_ * (lt - 1);
+        l_grid.dx0[d] = slope_;
+    }
+    if (halo_hi_ > 0) {
+        l_grid.x1[d] = halo_lo_ + n_ + slope_ * (lt - 1);
+        l_grid.dx1[d] = -slope_;
+    }
+    return l_grid;
+}
+
+/* the inner zoid of a slab starts depth * slope rows within the own 
+ * rows on each side with a halo, and leans inward by the slope, so 
+ * that it reads no halo row. False if it would vanish within the slab.
+ */
+template <int N_RANK>
+bool Pochoir_Dist<N_RANK>::inner_grid(grid_info<N_RANK> const & grid, int lt, grid_info<N_RANK> & inner) {
+    int const d = N_RANK-1;
+    inner = grid;
+    if (halo_lo_ > 0) {
+        inner.x0[d] = halo_lo_ + slope_ * depth_;
+        inner.dx0[d] = slope_;
+    }
+    if (halo_hi_ > 0) {
+        inner.x1[d] = halo_lo_ + n_ - slope_ * depth_;
+        inner.dx1[d] = -slope_;
+    }
+    return inner.x1[d] - inner.x0[d] > 0
+        && inner.x1[d] + inner.dx1[d] * (lt - 1) - (inner.x0[d] + inner.dx0[d] * (lt - 1)) > 0;
+}
+
+template <int N_RANK> template <typename W>
+void Pochoir_Dist<N_RANK>::run_slabs(Pochoir<N_RANK> & p, int timestep, W const & walk) {
+    Algorithm<N_RANK> algor(p.slope_);
+    int const d = N_RANK-1;
+    int const l_t1 = timestep + p.time_shift_;
+
+    start(p, algor, timestep);
+    for (int t = p.time_shift_; t < l_t1; t += dt_) {
+        int const lt = min(dt_, l_t1 - t);
+        grid_info<N_RANK> const l_grid = slab_grid(p, lt);
+        grid_info<N_RANK> l_inner;
+        if (!overlap_ || halo_ == 0 || !inner_grid(l_grid, lt, l_inner)) {
+            post_exchange(t + t_last_, false);
+            comm_.wait();
+            p.setGhost(algor);
+            pochoir_region([&]() { walk(algor, t, t + lt, l_grid); });
+            continue;
+        }
+        /* the ghost cells of the own rows are filled before the halo 
+         * rows start to change, those of the halo rows after
+         */
+        p.setGhost(algor);
+        post_exchange(t + t_last_, true);
+        pochoir_region([&]() { walk(algor, t, t + lt, l_inner); });
+        comm_.wait();
+        p.setGhost(algor);
+        grid_info<N_RANK> l_lo = l_grid, l_hi = l_grid;
+        l_lo.x1[d] = l_inner.x0[d]; l_lo.dx1[d] = l_inner.dx0[d];
+        l_hi.x0[d] = l_inner.x1[d]; l_hi.dx0[d] = l_inner.dx1[d];
+        pochoir_region([&]() {
+            pochoir_frame;
+            Algorithm<N_RANK> * l_algor = &algor;
+            W const * l_walk = &walk;
+            if (halo_lo_ > 0)
+                pochoir_spawn((*l_walk)(*l_algor, t, t + lt, l_lo));
+            if (halo_hi_ > 0)
+                (*l_walk)(*l_algor, t, t + lt, l_hi);
+            pochoir_sync;
+        });
+    }
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir_Dist<N_RANK>::Run(Pochoir<N_RANK> & p, int timestep, F const & f, BF const & bf) {
+    run_slabs(p, timestep, [&](Algorithm<N_RANK> & algor, int t0, int t1, grid_info<N_RANK> const & grid) {
+        algor.walk_bicut_boundary_p(t0, t1, grid, f, bf); });
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir_Dist<N_RANK>::Run_Obase(Pochoir<N_RANK> & p, int timestep, F const & f, BF const & bf) {
+    run_slabs(p, timestep, [&](Algorithm<N_RANK> & algor, int t0, int t1, grid_info<N_RANK> const & grid) {
+        algor.shorter_duo_sim_obase_bicut_p(t0, t1, grid, f, bf); });
+}
+
+#endif /* POCHOIR_DIST_H */
@@ -0,0 +1,703 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ ********************************************************************************/
+
+#ifndef POCHOIR_PARALLEL_H
+#define POCHOIR_PARALLEL_H
+
+/* The fork-join primitives the walkers are written in. A function which
+ * spawns declares 'pochoir_frame;' first, then uses
+ *
+ *      pochoir_spawn(walk(t0, t1, l_son_grid, f));
+ *      pochoir_sync;
+ *      pochoir_for(0, n, [&](int i) { ... });
+ *
+ * Like a Cilk function, a frame syncs its outstanding spawns when it goes
+ * out of scope, so the trapezoidal decomposition is scheduled the same way
+ * on every backend. A walk is started under pochoir_region(), which sets
+ * up the workers.
+ *
+ * The backend is selected at compile time by POCHOIR_BACKEND :
+ *   POCHOIR_BACKEND_CILK    : Cilk Plus (icc, or gcc 5-7 with -fcilkplus)
+ *   POCHOIR_BACKEND_OPENMP  : OpenMP tasks (-fopenmp)
+ *   POCHOIR_BACKEND_THREADS : a work-stealing pool over std::thread
+ *   POCHOIR_BACKEND_SERIAL  : no parallelism, for debugging
+ * By default it is Cilk if the compiler has it, otherwise OpenMP if it is
+ * enabled, otherwise the thread pool.
+ * The number of workers of the thread pool is the number of hardware
+ * threads, or POCHOIR_NWORKERS from the environment.
+ *
+ * The workers of the thread pool are split into one group per NUMA node
+ * (POCHOIR_NUMA_NODES from the environment overrides the count found in
+ * /sys), and bound to the cpus of their node. A thief steals within its 
+ * own group first, and 
+ *      pochoir_spawn_on(group, walk(t0, t1, l_son_grid, f));
+ * hands a zoid to a group. The other backends have a single group.
+ */
+#define POCHOIR_BACKEND_CILK 0
+#define POCHOIR_BACKEND_OPENMP 1
+#define POCHOIR_BACKEND_THREADS 2
+#define POCHOIR_BACKEND_SERIAL 3
+
+#ifndef POCHOIR_BACKEND
+#if defined(__cilk)
+#define POCHOIR_BACKEND POCHOIR_BACKEND_CILK
+#elif defined(_OPENMP)
+#define POCHOIR_BACKEND POCHOIR_BACKEND_OPENMP
+#else
+#define POCHOIR_BACKEND POCHOIR_BACKEND_THREADS
+#endif
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+
+/* set by the first pochoir_region() of the Cilk and OpenMP backends, 
+ * whose workers may be running from then on, see 
+ * pochoir_workers_started()
+ */
+inline bool & pochoir_region_entered(void) { 
+    static bool l_entered = false; 
+    return l_entered; 
+}
+
+#if POCHOIR_BACKEND == POCHOIR_BACKEND_CILK
+
+#include <cilk/cilk.h>
+#include <cilk/cilk_api.h>
+#include <cilk/holder.h>
+
+#define pochoir_frame
+#define pochoir_spawn(...) cilk_spawn __VA_ARGS__
+#define pochoir_sync cilk_sync
+
+template <typename F>
+static inline void pochoir_for(int lo, int hi, F const & f) {
+    cilk_for (int i = lo; i < hi; ++i)
+        f(i);
+}
+
+template <typename F>
+static inline void pochoir_region(F const & f) { pochoir_region_entered() = true; f(); }
+
+static inline int pochoir_get_nworkers(void) { return __cilkrts_get_nworkers(); }
+static inline bool pochoir_workers_started(void) { return pochoir_region_entered(); }
+static inline int pochoir_num_groups(void) { return 1; }
+static inline int pochoir_max_workers(void) { return __cilkrts_get_nworkers(); }
+
+static inline bool pochoir_set_nworkers(const char * nstr) {
+    return (0 == __cilkrts_set_param("nworkers", nstr));
+}
+
+/* a value private to each strand */
+template <typename T>
+class Pochoir_Holder {
+    private:
+        cilk::holder<T, cilk::holder_keep_last> v_;
+    public:
+        T & operator() (void) { return v_(); }
+};
+
+#else /* !POCHOIR_BACKEND_CILK */
+
+#include <cstring>
+#include <new>
+#include <atomic>
+#include <mutex>
+
+/* user code written with the Cilk keywords still compiles, and runs 
+ * serially
+ */
+#ifndef cilk_spawn
+#define cilk_spawn
+#define cilk_sync
+#define cilk_for for
+#endif
+
+static inline int pochoir_get_worker_id(void);
+static inline int pochoir_max_workers(void);
+
+/* the number of holders which have sized their slots, the worker count
+ * can not change while there is one
+ */
+inline std::atomic<int> & pochoir_sized_holders(void) {
+    static std::atomic<int> l_n(0);
+    return l_n;
+}
+
+inline std::mutex & pochoir_holder_lock(void) {
+    static std::mutex l_lock;
+    return l_lock;
+}
+
+/* a value private to each worker, each slot on its own cache line.
+ * The slots are sized from the worker count at the first use rather 
+ * than at construction, so that an array may be declared before 
+ * set_worker_count(); from then on the worker count is pinned.
+ */
+template <typename T>
+class Pochoir_Holder {
+    private:
+        struct slot { T v; char pad_[64]; };
+        std::atomic<slot *> slots_;
+        int num_slots_;
+        slot * size_slots(void);
+    public:
+        Pochoir_Holder(void) : slots_(NULL), num_slots_(0) { }
+        Pochoir_Holder(Pochoir_Holder<T> const & h) : slots_(NULL), num_slots_(0) { }
+        Pochoir_Holder<T> & operator= (Pochoir_Holder<T> const & h) { return *this; }
+        ~Pochoir_Holder(void);
+        T & operator() (void) {
+            slot * l_slots = slots_.load(std::memory_order_acquire);
+            if (l_slots == NULL)
+                l_slots = size_slots();
+            int const l_id = pochoir_get_worker_id();
+            return l_slots[l_id % num_slots_].v;
+        }
+};
+
+#if POCHOIR_BACKEND == POCHOIR_BACKEND_OPENMP
+
+#include <omp.h>
+
+#define pochoir_frame Pochoir_Frame l_pochoir_frame
+#define pochoir_spawn(...) _Pragma("omp task") { __VA_ARGS__; }
+#define pochoir_sync _Pragma("omp taskwait")
+
+template <typename F>
+static inline void pochoir_for(int lo, int hi, F const & f) {
+    _Pragma("omp taskloop")
+    for (int i = lo; i < hi; ++i)
+        f(i);
+}
+
+/* waits for the tasks spawned by the function when it returns */
+struct Pochoir_Frame {
+    ~Pochoir_Frame(void) {
+        _Pragma("omp taskwait")
+    }
+};
+
+template <typename F>
+static inline void pochoir_region(F const & f) {
+    if (omp_in_parallel()) {
+        f();
+        return;
+    }
+    pochoir_region_entered() = true;
+    _Pragma("omp parallel")
+    {
+        _Pragma("omp single")
+        f();
+    }
+}
+
+static inline int pochoir_get_worker_id(void) { return omp_get_thread_num(); }
+static inline bool pochoir_workers_started(void) { return pochoir_region_entered(); }
+static inline int pochoir_num_groups(void) { return 1; }
+static inline int pochoir_get_nworkers(void) { return omp_get_max_threads(); }
+static inline int pochoir_max_workers(void) { return omp_get_max_threads(); }
+
+static inline bool pochoir_set_nworkers(const char * nstr) {
+    int const l_n = atoi(nstr);
+    if (l_n <= 0 || pochoir_sized_holders() > 0)
+        return false;
+    omp_set_num_threads(l_n);
+    return true;
+}
+
+#elif POCHOIR_BACKEND == POCHOIR_BACKEND_THREADS
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <functional>
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+class Pochoir_Frame;
+
+/* Each worker pushes and pops the tasks it spawns at the back of its own
+ * deque, and steals from the front of the others' when it runs dry, so a
+ * thief takes the oldest, i.e. largest, zoid of the victim.  A worker
+ * waiting at a sync keeps running tasks instead of blocking.
+ * Worker w is in group w * ngroups / nworkers, and tries the victims of
+ * its own group before the others.
+ */
+class Pochoir_Pool {
+    private:
+        struct task {
+            std::function<void (void)> fn_;
+            Pochoir_Frame * frame_;
+        };
+        struct deque {
+            std::mutex m_;
+            std::deque<task *> q_;
+            char pad_[64];
+        };
+        int nworkers_;
+        deque * deques_;
+        int ngroups_;
+        int * group_first_; /* the first worker of each group, and nworkers_ */
+        std::atomic<unsigned int> * group_next_;
+        bool bind_;
+        std::vector<std::thread> threads_;
+        std::atomic<int> active_;
+        std::atomic<bool> stop_;
+        std::mutex sleep_m_;
+        std::condition_variable sleep_cv_;
+
+        static int & worker_id(void) {
+            static thread_local int l_id = -1;
+            return l_id;
+        }
+        static int & requested(void) {
+            static int l_n = 0;
+            return l_n;
+        }
+        static std::atomic<bool> & started(void) {
+            static std::atomic<bool> l_started(false);
+            return l_started;
+        }
+        static int default_nworkers(void) {
+            int l_n = requested();
+            char const * l_env = getenv("POCHOIR_NWORKERS");
+            if (l_n <= 0 && l_env != NULL)
+                l_n = atoi(l_env);
+            if (l_n <= 0)
+                l_n = std::thread::hardware_concurrency();
+            return (l_n <= 0) ? 1 : l_n;
+        }
+        /* the cpus of a NUMA node, from /sys, in a 'cpulist' format like
+         * "0-7,16-23", NULL if there is no such node
+         */
+        static char * node_cpulist(int _node, char * _buf, int _size) {
+            char l_name[64];
+            sprintf(l_name, "/sys/devices/system/node/node%d/cpulist", _node);
+            FILE * l_f = fopen(l_name, "r");
+            if (l_f == NULL)
+                return NULL;
+            char * l_ret = fgets(_buf, _size, l_f);
+            fclose(l_f);
+            return l_ret;
+        }
+        static int numa_nodes(void) {
+            char l_buf[1024];
+            int l_n = 0;
+            while (node_cpulist(l_n, l_buf, sizeof(l_buf)) != NULL)
+                ++l_n;
+            return (l_n <= 0) ? 1 : l_n;
+        }
+        static void bind_node(int _node);
+
+        Pochoir_Pool(int _n);
+        void worker_loop(int _id);
+        task * pop(int _id);
+        task * steal(int _id);
+        inline void execute(task * _t);
+    public:
+        ~Pochoir_Pool(void);
+        static Pochoir_Pool & instance(void);
+        static int id(void) { return worker_id(); }
+        static bool running(void) { return started(); }
+        /* the number of workers the pool has, or will have once started */
+        static int max_workers(void) { 
+            return started() ? instance().nworkers() : default_nworkers(); 
+        }
+        static bool set_nworkers(int _n) {
+            if (started() || _n <= 0 || pochoir_sized_holders() > 0)
+                return false;
+            requested() = _n;
+            return true;
+        }
+        int nworkers(void) const { return nworkers_; }
+        int ngroups(void) const { return ngroups_; }
+        int group(int _id) const { return (int)(((long long)_id * ngroups_) / nworkers_); }
+        /* true if the calling thread runs inside a region of the pool */
+        bool in_region(void) const { return worker_id() >= 0 && active_ > 0; }
+        template <typename F>
+        void region(F const & f);
+        void push(std::function<void (void)> const & fn, Pochoir_Frame * frame);
+        void push_group(int group, std::function<void (void)> const & fn, Pochoir_Frame * frame);
+        /* run one task from the own deque or a stolen one */
+        bool run_one(void);
+};
+
+/* counts the spawns of a function which are not done yet */
+class Pochoir_Frame {
+    private:
+        std::atomic<int> pending_;
+    public:
+        Pochoir_Frame(void) : pending_(0) { }
+        ~Pochoir_Frame(void) { sync(); }
+        template <typename F>
+        inline void spawn(F const & f) {
+            Pochoir_Pool & l_pool = Pochoir_Pool::instance();
+            if (l_pool.nworkers() <= 1 || !l_pool.in_region()) {
+                f();
+                return;
+            }
+            ++pending_;
+            l_pool.push(f, this);
+        }
+        /* spawn onto a worker of the group */
+        template <typename F>
+        inline void spawn_on(int _group, F const & f) {
+            Pochoir_Pool & l_pool = Pochoir_Pool::instance();
+            if (l_pool.nworkers() <= 1 || !l_pool.in_region()) {
+                f();
+                return;
+            }
+            ++pending_;
+            l_pool.push_group(_group, f, this);
+        }
+        inline void done(void) { --pending_; }
+        inline void sync(void) {
+            while (pending_.load() > 0) {
+                if (!Pochoir_Pool::instance().run_one())
+                    std::this_thread::yield();
+            }
+        }
+};
+
+inline Pochoir_Pool::Pochoir_Pool(int _n) : nworkers_(_n), active_(0), stop_(false) {
+    char const * l_env = getenv("POCHOIR_NUMA_NODES");
+    int const l_nodes = numa_nodes();
+    deques_ = new deque[nworkers_];
+    ngroups_ = (l_env != NULL && atoi(l_env) > 0) ? atoi(l_env) : l_nodes;
+    if (ngroups_ > nworkers_)
+        ngroups_ = nworkers_;
+    /* bind only to the nodes which do exist */
+    bind_ = (ngroups_ > 1 && ngroups_ == l_nodes);
+    group_first_ = new int[ngroups_+1];
+    group_next_ = new std::atomic<unsigned int>[ngroups_];
+    for (int g = 0; g < ngroups_; ++g) {
+        group_first_[g] = (int)(((long long)g * nworkers_ + ngroups_ - 1) / ngroups_);
+        group_next_[g] = 0;
+    }
+    group_first_[ngroups_] = nworkers_;
+    for (int i = 1; i < nworkers_; ++i)
+        threads_.push_back(std::thread(&Pochoir_Pool::worker_loop, this, i));
+}
+
+inline Pochoir_Pool::~Pochoir_Pool(void) {
+    {
+        std::lock_guard<std::mutex> l_lock(sleep_m_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (size_t i = 0; i < threads_.size(); ++i)
+        threads_[i].join();
+    delete [] deques_;
+    delete [] group_first_;
+    delete [] group_next_;
+}
+
+inline void Pochoir_Pool::bind_node(int _node) {
+#if defined(__linux__) && defined(CPU_SET)
+    char l_buf[1024];
+    if (node_cpulist(_node, l_buf, sizeof(l_buf)) == NULL)
+        return;
+    cpu_set_t l_set;
+    CPU_ZERO(&l_set);
+    char * l_p = l_buf;
+    while (*l_p >= '0' && *l_p <= '9') {
+        int l_lo = (int)strtol(l_p, &l_p, 10), l_hi = l_lo;
+        if (*l_p == '-')
+            l_hi = (int)strtol(l_p + 1, &l_p, 10);
+        for (int c = l_lo; c <= l_hi && c < CPU_SETSIZE; ++c)
+            CPU_SET(c, &l_set);
+        if (*l_p == ',')
+            ++l_p;
+    }
+    sched_setaffinity(0, sizeof(l_set), &l_set);
+#endif
+}
+
+inline Pochoir_Pool & Pochoir_Pool::instance(void) {
+    static Pochoir_Pool * l_pool = NULL;
+    static std::once_flag l_once;
+    std::call_once(l_once, [] {
+        int const l_n = default_nworkers();
+        started() = true;
+        static Pochoir_Pool l_instance(l_n);
+        l_pool = &l_instance;
+    });
+    return *l_pool;
+}
+
+inline void Pochoir_Pool::worker_loop(int _id) {
+    worker_id() = _id;
+    if (bind_)
+        bind_node(group(_id));
+    while (!stop_) {
+        if (active_ > 0) {
+            if (!run_one())
+                std::this_thread::yield();
+        } else {
+            std::unique_lock<std::mutex> l_lock(sleep_m_);
+            sleep_cv_.wait(l_lock, [this] { return active_ > 0 || stop_; });
+        }
+    }
+}
+
+template <typename F>
+inline void Pochoir_Pool::region(F const & f) {
+    int const l_old_id = worker_id();
+    if (l_old_id >= 0 && active_ > 0) {
+        /* nested region */
+        f();
+        return;
+    }
+    worker_id() = 0;
+    {
+        std::lock_guard<std::mutex> l_lock(sleep_m_);
+        ++active_;
+    }
+    sleep_cv_.notify_all();
+    f();
+    --active_;
+    worker_id() = l_old_id;
+}
+
+inline void Pochoir_Pool::push(std::function<void (void)> const & fn, Pochoir_Frame * frame) {
+    task * l_task = new task;
+    l_task->fn_ = fn;
+    l_task->frame_ = frame;
+    deque & l_deque = deques_[worker_id()];
+    std::lock_guard<std::mutex> l_lock(l_deque.m_);
+    l_deque.q_.push_back(l_task);
+}
+
+/* a task for another group goes to its workers in turn, a task for the
+ * own group stays on the own deque
+ */
+inline void Pochoir_Pool::push_group(int _group, std::function<void (void)> const & fn, Pochoir_Frame * frame) {
+    int const l_group = ((_group % ngroups_) + ngroups_) % ngroups_;
+    int const l_id = worker_id();
+    if (group(l_id) == l_group) {
+        push(fn, frame);
+        return;
+    }
+    task * l_task = new task;
+    l_task->fn_ = fn;
+    l_task->frame_ = frame;
+    int const l_size = group_first_[l_group+1] - group_first_[l_group];
+    int const l_victim = group_first_[l_group] + (int)(group_next_[l_group]++ % l_size);
+    deque & l_deque = deques_[l_victim];
+    std::lock_guard<std::mutex> l_lock(l_deque.m_);
+    l_deque.q_.push_back(l_task);
+}
+
+inline Pochoir_Pool::task * Pochoir_Pool::pop(int _id) {
+    deque & l_deque = deques_[_id];
+    std::lock_guard<std::mutex> l_lock(l_deque.m_);
+    if (l_deque.q_.empty())
+        return NULL;
+    task * l_task = l_deque.q_.back();
+    l_deque.q_.pop_back();
+    return l_task;
+}
+
+inline Pochoir_Pool::task * Pochoir_Pool::steal(int _id) {
+    static thread_local unsigned int l_seed = 0;
+    l_seed = l_seed * 1103515245u + 12345u + _id;
+    int const l_group = group(_id);
+    /* the own group first, then all the workers */
+    for (int l_pass = 0; l_pass < 2; ++l_pass) {
+        int const l_lo = (l_pass == 0) ? group_first_[l_group] : 0;
+        int const l_size = (l_pass == 0) ? group_first_[l_group+1] - l_lo : nworkers_;
+        if (l_pass == 0 && ngroups_ == 1)
+            continue;
+        int const l_first = (int)((l_seed >> 16) % l_size);
+        for (int k = 0; k < l_size; ++k) {
+            int const l_victim = l_lo + (l_first + k) % l_size;
+            if (l_victim == _id)
+                continue;
+            deque & l_deque = deques_[l_victim];
+            std::unique_lock<std::mutex> l_lock(l_deque.m_, std::try_to_lock);
+            if (!l_lock.owns_lock() || l_deque.q_.empty())
+                continue;
+            task * l_task = l_deque.q_.front();
+            l_deque.q_.pop_front();
+            return l_task;
+        }
+    }
+    return NULL;
+}
+
+inline void Pochoir_Pool::execute(task * _t) {
+    _t->fn_();
+    _t->frame_->done();
+    delete _t;
+}
+
+inline bool Pochoir_Pool::run_one(void) {
+    int const l_id = worker_id();
+    if (l_id < 0)
+        return false;
+    task * l_task = pop(l_id);
+    if (l_task == NULL)
+        l_task = steal(l_id);
+    if (l_task == NULL)
+        return false;
+    execute(l_task);
+    return true;
+}
+
+/* the arguments of a spawned call are evaluated at the spawn, as in Cilk */
+#define pochoir_frame Pochoir_Frame l_pochoir_frame
+#define pochoir_spawn(...) l_pochoir_frame.spawn([=]() { __VA_ARGS__; })
+#define pochoir_spawn_on(group, ...) l_pochoir_frame.spawn_on(group, [=]() { __VA_ARGS__; })
+#define pochoir_sync l_pochoir_frame.sync()
+
+template <typename F>
+static inline void pochoir_region(F const & f) { Pochoir_Pool::instance().region(f); }
+
+/* [lo, hi) is cut into a few chunks per worker, one task each, rather 
+ * than one task per iteration
+ */
+template <typename F>
+static inline void pochoir_for(int lo, int hi, F const & f) {
+    pochoir_region([&]() {
+        pochoir_frame;
+        int const l_n = 4 * Pochoir_Pool::instance().nworkers();
+        int const l_chunks = (hi - lo < l_n) ? hi - lo : l_n;
+        for (int c = 0; c < l_chunks; ++c) {
+            int const l_lo = lo + (int)(((long long)c * (hi - lo)) / l_chunks);
+            int const l_hi = lo + (int)(((long long)(c + 1) * (hi - lo)) / l_chunks);
+            pochoir_spawn(for (int i = l_lo; i < l_hi; ++i) f(i));
+        }
+        pochoir_sync;
+    });
+}
+
+static inline int pochoir_get_worker_id(void) {
+    int const l_id = Pochoir_Pool::id();
+    return (l_id < 0) ? 0 : l_id;
+}
+static inline int pochoir_get_nworkers(void) { return Pochoir_Pool::instance().nworkers(); }
+static inline bool pochoir_workers_started(void) { return Pochoir_Pool::running(); }
+static inline int pochoir_num_groups(void) { return Pochoir_Pool::instance().ngroups(); }
+static inline int pochoir_max_workers(void) { return Pochoir_Pool::max_workers(); }
+
+static inline bool pochoir_set_nworkers(const char * nstr) {
+    return Pochoir_Pool::set_nworkers(atoi(nstr));
+}
+
+#else /* POCHOIR_BACKEND_SERIAL */
+
+#define pochoir_frame
+#define pochoir_spawn(...) __VA_ARGS__
+#define pochoir_sync
+
+template <typename F>
+static inline void pochoir_region(F const & f) { f(); }
+
+template <typename F>
+static inline void pochoir_for(int lo, int hi, F const & f) {
+    for (int i = lo; i < hi; ++i)
+        f(i);
+}
+
+static inline int pochoir_get_worker_id(void) { return 0; }
+static inline int pochoir_num_groups(void) { return 1; }
+static inline int pochoir_get_nworkers(void) { return 1; }
+static inline bool pochoir_workers_started(void) { return false; }
+static inline int pochoir_max_workers(void) { return 1; }
+static inline bool pochoir_set_nworkers(const char * nstr) { return false; }
+
+#endif
+
+template <typename T>
+typename Pochoir_Holder<T>::slot * Pochoir_Holder<T>::size_slots(void) {
+    std::lock_guard<std::mutex> l_guard(pochoir_holder_lock());
+    slot * l_slots = slots_.load(std::memory_order_relaxed);
+    if (l_slots == NULL) {
+        int const l_n = pochoir_max_workers();
+        num_slots_ = (l_n < 1) ? 1 : l_n;
+        l_slots = new slot[num_slots_];
+        ++pochoir_sized_holders();
+        slots_.store(l_slots, std::memory_order_release);
+    }
+    return l_slots;
+}
+
+template <typename T>
+Pochoir_Holder<T>::~Pochoir_Holder(void) {
+    slot * l_slots = slots_.load(std::memory_order_relaxed);
+    if (l_slots != NULL) {
+        delete [] l_slots;
+        --pochoir_sized_holders();
+    }
+}
+
+#endif /* POCHOIR_BACKEND_CILK */
+
+/* without groups of workers, a spawn onto a group is a plain spawn */
+#ifndef pochoir_spawn_on
+#define pochoir_spawn_on(group, ...) pochoir_spawn(__VA_ARGS__)
+#endif
+
+template <typename F>
+static inline void pochoir_split_for(int lo, int hi, F const & f) {
+    pochoir_frame;
+    while (hi - lo > 1) {
+        int const l_mid = lo + (hi - lo) / 2;
+        pochoir_spawn(pochoir_split_for(l_mid, hi, f));
+        hi = l_mid;
+    }
+    if (lo < hi)
+        f(lo);
+}
+
+/* f(i) for i in [lo, hi) in parallel, by recursive halving, from
+ * outside a walk as well
+ */
+template <typename F>
+static inline void pochoir_parallel_for(int lo, int hi, F const & f) {
+    pochoir_region([&]() { pochoir_split_for(lo, hi, f); });
+}
+
+/* as pochoir_parallel_for(), but [lo, hi) is cut into one contiguous 
+ * range per group of workers, g-th range to the g-th group
+ */
+template <typename F>
+static inline void pochoir_group_for(int lo, int hi, F const & f) {
+    pochoir_region([&]() {
+        pochoir_frame;
+        int const l_groups = pochoir_num_groups();
+        for (int g = 0; g < l_groups; ++g) {
+            int const l_lo = lo + (int)(((long long)g * (hi - lo)) / l_groups);
+            int const l_hi = lo + (int)(((long long)(g + 1) * (hi - lo)) / l_groups);
+            pochoir_spawn_on(g, pochoir_split_for(l_lo, l_hi, f));
+        }
+    });
+}
+
+#endif /* POCHOIR_PARALLEL_H */
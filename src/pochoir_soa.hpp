@@ -0,0 +1,658 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ ********************************************************************************/
+
+
+#ifndef POCHOIR_SOA_H
+#define POCHOIR_SOA_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "pochoir_common.hpp"
+#include "pochoir_array.hpp"
+#include "pochoir_parallel.hpp"
+
+/* Structure-of-arrays storage for a struct element type : every field 
+ * of the struct lives in its own plane of toggle_ * total_size_ elements, 
+ * so that a kernel reading one field of the neighbors walks that plane 
+ * with unit stride.  The element is still reached as a(t, i, j).field, 
+ * operator() and friends return a ref_type proxy whose members are 
+ * references into the planes.
+ *
+ * The field layout of a struct T is declared once by 
+ * Pochoir_SoA_Type(T, FIELDS), where FIELDS(F) expands F(type, name) 
+ * for every field of T, e.g.
+ *
+ *      #define Cell_Fields(F) F(double, _C) F(double, _N) F(unsigned int, _FLAGS)
+ *      Pochoir_SoA_Type(Cell, Cell_Fields)
+ *
+ * All fields must be plain old data, and the macro must be used at
+ * global scope.  The names pochoir_*_ are taken by the proxy itself.
+ */
+template <typename T>
+struct Pochoir_SoA_Traits;
+
+struct Pochoir_SoA_Ref_Base { };
+
+#define Pochoir_SoA_Enum(type, name) pochoir_idx##name,
+#define Pochoir_SoA_Size(type, name) sizeof(type),
+#define Pochoir_SoA_Member(type, name) type & name;
+#define Pochoir_SoA_Init_Plane(type, name) , name(((type *)pochoir_plane_[pochoir_idx##name])[pochoir_index_])
+#define Pochoir_SoA_Init_Value(type, name) , name(pochoir_v_.name)
+#define Pochoir_SoA_Load(type, name) pochoir_l_v_.name = name;
+#define Pochoir_SoA_Store(type, name) name = pochoir_v_.name;
+
+#define Pochoir_SoA_Type(T, FIELDS) \
+template <> \
+struct Pochoir_SoA_Traits<T> { \
+    enum { FIELDS(Pochoir_SoA_Enum) n_fields }; \
+    static size_t field_size(int pochoir_f_) { \
+        static size_t const l_size[] = { FIELDS(Pochoir_SoA_Size) 0 }; \
+        return l_size[pochoir_f_]; \
+    } \
+    struct ref_type : Pochoir_SoA_Ref_Base { \
+        FIELDS(Pochoir_SoA_Member) \
+        ref_type(char * const * pochoir_plane_, int pochoir_index_) : Pochoir_SoA_Ref_Base() FIELDS(Pochoir_SoA_Init_Plane) { } \
+        ref_type(T & pochoir_v_) : Pochoir_SoA_Ref_Base() FIELDS(Pochoir_SoA_Init_Value) { } \
+        operator T() const { T pochoir_l_v_; FIELDS(Pochoir_SoA_Load) return pochoir_l_v_; } \
+        ref_type & operator= (T const & pochoir_v_) { FIELDS(Pochoir_SoA_Store) return *this; } \
+        ref_type & operator= (ref_type const & pochoir_v_) { FIELDS(Pochoir_SoA_Store) return *this; } \
+    }; \
+};
+
+template <typename T, int N_RANK, typename BF = Pochoir_Bdry_Fn_Ptr>
+class Pochoir_SoA_Array {
+    public:
+        typedef Pochoir_SoA_Traits<T> traits;
+        typedef typename traits::ref_type ref_type;
+        typedef typename Pochoir_BValue<Pochoir_SoA_Array<T, N_RANK, BF>, T, N_RANK>::type BValue;
+	private:
+        enum { n_fields = traits::n_fields };
+        char * planes_[n_fields]; /* beginning of each field plane */
+        char * buffer_;
+        size_t bytes_;
+        int * ref_; /* # of views sharing buffer_ */
+		typedef int size_info[N_RANK];
+		size_info logic_size_; 
+		size_info logic_start_, logic_end_; 
+		size_info phys_size_; 
+		size_info stride_; 
+        bool allocMemFlag_;
+        Pochoir_Alloc alloc_;
+		int total_size_;
+        int slope_[N_RANK], toggle_, toggle_mask_, live_toggle_;
+        BValue bv_;
+        /* the boundary functor BF of the array type, or bv_ */
+        typedef Pochoir_Bdry_Call<BF, BValue> BCall;
+        Pochoir_Holder<T> ret_v;
+
+        void init(int const * _size) {
+            /* _size[] is in the order of the constructor arguments, 
+             * the outermost dimension first
+             */
+            for (int i = 0; i < N_RANK; ++i) {
+                logic_size_[i] = phys_size_[i] = _size[N_RANK-1-i];
+                logic_start_[i] = 0; logic_end_[i] = phys_size_[i];
+                slope_[i] = 0;
+            }
+            stride_[0] = 1;
+            for (int i = 1; i < N_RANK; ++i)
+                stride_[i] = stride_[i-1] * phys_size_[i-1];
+            total_size_ = stride_[N_RANK-1] * phys_size_[N_RANK-1];
+            toggle_ = 0; toggle_mask_ = -1;
+            buffer_ = NULL; bytes_ = 0; ref_ = NULL;
+            bv_ = NULL;
+            allocMemFlag_ = false;
+            alloc_ = Pochoir_Alloc_Default;
+            live_toggle_ = 0;
+        }
+
+        /* _idx[0] is the time, followed by the spatial indices from the 
+         * outermost dimension to the unit-stride one
+         */
+        inline int index(int const * _idx) const {
+            int l_idx = ((toggle_mask_ >= 0) ? (_idx[0] & toggle_mask_) : (_idx[0] % toggle_)) * total_size_;
+            for (int i = 0; i < N_RANK; ++i)
+                l_idx += _idx[N_RANK-i] * stride_[i];
+            return l_idx;
+        }
+
+        inline bool check_boundary(int const * _idx) const {
+            bool touch_boundary = false;
+            for (int i = 0; i < N_RANK; ++i) {
+                touch_boundary = touch_boundary || (_idx[N_RANK-i] < logic_start_[i])
+                                 || (_idx[N_RANK-i] >= logic_end_[i]);
+            }
+            return touch_boundary;
+        }
+
+        inline void check_alloc(void) const {
+            if (!allocMemFlag_) {
+                printf("Pochoir array access error:\n");
+                printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
+                exit(1);
+            }
+        }
+
+	public:
+        /* the spatial dimensions are row-majored as in Pochoir_Array */
+        explicit Pochoir_SoA_Array (int sz0) {
+            int const l_size[] = { sz0 };
+            init(l_size);
+        }
+
+        explicit Pochoir_SoA_Array (int sz1, int sz0) {
+            int const l_size[] = { sz1, sz0 };
+            init(l_size);
+        }
+
+        explicit Pochoir_SoA_Array (int sz2, int sz1, int sz0) {
+            int const l_size[] = { sz2, sz1, sz0 };
+            init(l_size);
+        }
+
+        explicit Pochoir_SoA_Array (int sz3, int sz2, int sz1, int sz0) {
+            int const l_size[] = { sz3, sz2, sz1, sz0 };
+            init(l_size);
+        }
+
+        explicit Pochoir_SoA_Array (int sz4, int sz3, int sz2, int sz1, int sz0) {
+            int const l_size[] = { sz4, sz3, sz2, sz1, sz0 };
+            init(l_size);
+        }
+
+        explicit Pochoir_SoA_Array (int sz5, int sz4, int sz3, int sz2, int sz1, int sz0) {
+            int const l_size[] = { sz5, sz4, sz3, sz2, sz1, sz0 };
+            init(l_size);
+        }
+
+        explicit Pochoir_SoA_Array (int sz6, int sz5, int sz4, int sz3, int sz2, int sz1, int sz0) {
+            int const l_size[] = { sz6, sz5, sz4, sz3, sz2, sz1, sz0 };
+            init(l_size);
+        }
+
+        explicit Pochoir_SoA_Array (int sz7, int sz6, int sz5, int sz4, int sz3, int sz2, int sz1, int sz0) {
+            int const l_size[] = { sz7, sz6, sz5, sz4, sz3, sz2, sz1, sz0 };
+            init(l_size);
+        }
+
+        /* copy constructor -- create another view of the same array */
+        Pochoir_SoA_Array (Pochoir_SoA_Array<T, N_RANK, BF> const & orig) {
+            *this = orig;
+        }
+
+        Pochoir_SoA_Array<T, N_RANK, BF> & operator= (Pochoir_SoA_Array<T, N_RANK, BF> const & orig) {
+            if (this == &orig)
+                return *this;
+            for (int i = 0; i < N_RANK; ++i) {
+                logic_size_[i] = orig.logic_size_[i];
+                logic_start_[i] = orig.logic_start_[i];
+                logic_end_[i] = orig.logic_end_[i];
+                phys_size_[i] = orig.phys_size_[i];
+                stride_[i] = orig.stride_[i];
+                slope_[i] = orig.slope_[i];
+            }
+            for (int f = 0; f < n_fields; ++f)
+                planes_[f] = orig.planes_[f];
+            buffer_ = orig.buffer_; bytes_ = orig.bytes_; ref_ = orig.ref_;
+            if (ref_ != NULL)
+                ++(*ref_);
+            total_size_ = orig.total_size_; toggle_ = orig.toggle_;
+            toggle_mask_ = orig.toggle_mask_;
+            bv_ = orig.bv_;
+            allocMemFlag_ = orig.allocMemFlag_;
+            alloc_ = orig.alloc_;
+            live_toggle_ = orig.live_toggle_;
+            return *this;
+        }
+
+        /* free the planes with the last view */
+        ~Pochoir_SoA_Array() {
+            if (ref_ != NULL && --(*ref_) == 0) {
+                pochoir_free_mem(buffer_, bytes_, alloc_);
+                delete ref_;
+            }
+        }
+
+        void Register_Boundary(BValue _bv) { bv_ = _bv; }
+        void unRegister_Boundary(void) { bv_ = NULL; }
+        inline bool user_bdry(void) const { return BCall::functor || bv_ != NULL; }
+
+        /* same as Pochoir_Array::Register_Alloc() */
+        void Register_Alloc(Pochoir_Alloc const & _alloc) {
+            if (allocMemFlag_) {
+                printf("Pochoir_SoA_Array : Register_Alloc() after the memory is allocated!\n");
+                exit(1);
+            }
+            alloc_ = _alloc;
+        }
+
+        /* same as Pochoir_Array::Register_Liveness() */
+        void Register_Liveness(Pochoir_Shape<N_RANK> const * shape, int shape_size, int _home) {
+            int const l_toggle = live_toggle<N_RANK>(shape, shape_size, _home);
+            if (l_toggle == 0) {
+                printf("Pochoir_SoA_Array : Register_Liveness() with a time shift later than the home %d!\n", _home);
+                exit(1);
+            }
+            /* an array shared by several stencils is registered again */
+            if (allocMemFlag_ && l_toggle != toggle_) {
+                printf("Pochoir_SoA_Array : Register_Liveness() after the memory is allocated!\n");
+                exit(1);
+            }
+            live_toggle_ = l_toggle;
+        }
+
+        template <size_t N_SIZE>
+        void Register_Liveness(Pochoir_Shape<N_RANK> (& shape)[N_SIZE], int _home) {
+            Register_Liveness(shape, N_SIZE, _home);
+        }
+
+        void Register_Domain(grid_info<N_RANK> initial_grid) {
+            for (int i = 0; i < N_RANK; ++i) {
+                logic_start_[i] = initial_grid.x0[i];
+                logic_end_[i] = initial_grid.x1[i];
+                logic_size_[i] = initial_grid.x1[i] - initial_grid.x0[i];
+            }
+        }
+
+        /* called from Pochoir::Register_Array, only the slope_[] and 
+         * toggle_ are taken out of the shape as in Pochoir_Array
+         */
+        void Register_Shape(Pochoir_Shape<N_RANK> * shape, int shape_size) {
+            int l_min_time_shift = 0, l_max_time_shift = 0;
+            for (int r = 0; r < N_RANK; ++r) 
+                slope_[r] = 0;
+            for (int i = 0; i < shape_size; ++i) {
+                l_min_time_shift = min(l_min_time_shift, shape[i].shift[0]);
+                l_max_time_shift = max(l_max_time_shift, shape[i].shift[0]);
+            }
+            set_toggle((live_toggle_ > 0) ? live_toggle_ : l_max_time_shift - l_min_time_shift + 1);
+            for (int i = 0; i < shape_size; ++i) {
+                for (int r = 0; r < N_RANK; ++r) {
+                    slope_[r] = max(slope_[r], abs((int)ceil((float)shape[i].shift[N_RANK-r]/(l_max_time_shift - shape[i].shift[0]))));
+                }
+            }
+            alloc_mem();
+        }
+
+        template <size_t N_SIZE>
+        void Register_Shape(Pochoir_Shape<N_RANK> (& shape)[N_SIZE]) {
+            Register_Shape(shape, N_SIZE);
+        }
+
+        /* one buffer holds all field planes, each plane starts on a
+         * cache line
+         */
+        void alloc_mem(void) {
+            if (allocMemFlag_)
+                return;
+            size_t l_offset[n_fields];
+            size_t const l_len = (size_t)toggle_ * total_size_;
+            bytes_ = 0;
+            for (int f = 0; f < n_fields; ++f) {
+                l_offset[f] = bytes_;
+                bytes_ += (l_len * traits::field_size(f) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+            }
+            if (alloc_.huge_page)
+                bytes_ = (bytes_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            buffer_ = static_cast<char *>(pochoir_alloc_mem(bytes_, alloc_));
+            ref_ = new int(1);
+            for (int f = 0; f < n_fields; ++f)
+                planes_[f] = buffer_ + l_offset[f];
+            if (alloc_.first_touch) {
+                first_touch();
+            } else {
+                memset(buffer_, 0, bytes_);
+            }
+            allocMemFlag_ = true;
+        }
+
+        /* zero the planes in slabs of the outermost spatial dimension,
+         * see Pochoir_Array::first_touch()
+         */
+        void first_touch(void) {
+            int const l_slabs = phys_size_[N_RANK-1];
+            int const l_slab_size = stride_[N_RANK-1];
+            int const l_toggle = toggle_, l_total_size = total_size_;
+            char * const * l_planes = planes_;
+            pochoir_group_for(0, l_slabs, [&](int i) {
+                for (int f = 0; f < n_fields; ++f) {
+                    size_t const l_size = traits::field_size(f);
+                    for (int t = 0; t < l_toggle; ++t) {
+                        size_t const l_begin = (size_t)t * l_total_size + (size_t)i * l_slab_size;
+                        memset(l_planes[f] + l_begin * l_size, 0, l_slab_size * l_size);
+                    }
+                }
+            });
+        }
+
+		int phys_size(int _dim) const { return phys_size_[_dim]; }
+		int logic_size(int _dim) const { return logic_size_[_dim]; }
+		int size(int _dim) const { return phys_size_[_dim]; }
+		int slope(int _dim) const { return slope_[_dim]; }
+		int toggle() const { return toggle_; }
+		int total_size() const { return total_size_; }
+		int stride (int _dim) const { return stride_[_dim]; }
+        void set_slope(int _slope[N_RANK]) { 
+            for (int i = 0; i < N_RANK; ++i) 
+                slope_[i] = _slope[i]; 
+        }
+        /* a power-of-two toggle_ selects the plane by a mask, 
+         * as in Pochoir_Array 
+         */
+        void set_toggle(int _toggle) { 
+            toggle_ = _toggle; 
+            toggle_mask_ = ((_toggle & (_toggle - 1)) == 0) ? _toggle - 1 : -1;
+        }
+        /* the whole buffer, for the autotuner in pochoir.hpp */
+        char * data() { return buffer_; }
+        size_t bytes() const { return bytes_; }
+        char * plane(int _field) { return planes_[_field]; }
+        /* the proxy of flat index 0 : the address of each of its fields
+         * is the beginning of that field plane, the split pointer kernels
+         * generated by the Pochoir compiler use this to set up the 
+         * per-field pointers
+         */
+        inline ref_type plane_base(void) { return ref_type(planes_, 0); }
+
+        /* - operator() checks the boundary and calls the boundary function;
+         * - boundary() is the same without the registration check;
+         * - interior() is for the region where no boundary check is needed;
+         * - get() is for boundary functions, which must stay inside the array.
+         */
+		inline ref_type operator() (int _idx1, int _idx0) {
+            int const l_idx[] = { _idx1, _idx0 };
+            check_alloc();
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type operator() (int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx2, _idx1, _idx0 };
+            check_alloc();
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type operator() (int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx3, _idx2, _idx1, _idx0 };
+            check_alloc();
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type operator() (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx4, _idx3, _idx2, _idx1, _idx0 };
+            check_alloc();
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type operator() (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            check_alloc();
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type operator() (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            check_alloc();
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type operator() (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            check_alloc();
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type operator() (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            check_alloc();
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type boundary (int _idx1, int _idx0) {
+            int const l_idx[] = { _idx1, _idx0 };
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type boundary (int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type boundary (int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type boundary (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type boundary (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type boundary (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type boundary (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type boundary (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx) && user_bdry()) {
+                ret_v() = BCall::fn(bv_)(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                return ref_type(ret_v());
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type interior (int _idx1, int _idx0) {
+            int const l_idx[] = { _idx1, _idx0 };
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type interior (int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx2, _idx1, _idx0 };
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type interior (int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx3, _idx2, _idx1, _idx0 };
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type interior (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx4, _idx3, _idx2, _idx1, _idx0 };
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type interior (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type interior (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type interior (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline ref_type interior (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline T get (int _idx1, int _idx0) {
+            int const l_idx[] = { _idx1, _idx0 };
+            if (check_boundary(l_idx)) {
+                printf("Pochoir illegal access by boundary function error:\n");
+                printf("Out-of-range access by boundary function at index (%d, %d)\n", _idx1, _idx0);
+                exit(1);
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline T get (int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx)) {
+                printf("Pochoir illegal access by boundary function error:\n");
+                printf("Out-of-range access by boundary function at index (%d, %d, %d)\n", _idx2, _idx1, _idx0);
+                exit(1);
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline T get (int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx)) {
+                printf("Pochoir illegal access by boundary function error:\n");
+                printf("Out-of-range access by boundary function at index (%d, %d, %d, %d)\n", _idx3, _idx2, _idx1, _idx0);
+                exit(1);
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline T get (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx)) {
+                printf("Pochoir illegal access by boundary function error:\n");
+                printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d)\n", _idx4, _idx3, _idx2, _idx1, _idx0);
+                exit(1);
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline T get (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx)) {
+                printf("Pochoir illegal access by boundary function error:\n");
+                printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d)\n", _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                exit(1);
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline T get (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx)) {
+                printf("Pochoir illegal access by boundary function error:\n");
+                printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d, %d)\n", _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                exit(1);
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline T get (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx)) {
+                printf("Pochoir illegal access by boundary function error:\n");
+                printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d, %d, %d)\n", _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                exit(1);
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+
+		inline T get (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+            int const l_idx[] = { _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0 };
+            if (check_boundary(l_idx)) {
+                printf("Pochoir illegal access by boundary function error:\n");
+                printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d, %d, %d, %d)\n", _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                exit(1);
+            }
+            return ref_type(planes_, index(l_idx));
+		}
+};
+
+#endif // POCHOIR_SOA_H
@@ -0,0 +1,349 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ ********************************************************************************/
+
+#ifndef POCHOIR_TRANSPORT_H
+#define POCHOIR_TRANSPORT_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "pochoir_parallel.hpp"
+
+/* The transport of Pochoir_Dist (pochoir_dist.hpp) between the ranks of
+ * a distributed run. A backend only has to move a buffer to a neighbor
+ * while receiving one from the other neighbor, and may be built on MPI 
+ * or anything else by deriving from Pochoir_Transport.
+ * Exchanges may also be posted, started by begin() and completed by 
+ * wait(), so that the caller computes meanwhile. By default they all run
+ * in wait(), a backend overrides begin() / wait() to move them in the
+ * background.
+ */
+class Pochoir_Transport {
+    protected:
+        struct request {
+            int to_, from_;
+            void const * sbuf_;
+            void * rbuf_;
+            size_t sbytes_, rbytes_;
+        };
+        std::vector<request> pending_;
+    public:
+        virtual ~Pochoir_Transport(void) { }
+        virtual int rank(void) const = 0;
+        virtual int size(void) const = 0;
+        /* send _sbytes of _sbuf to rank _to while receiving _rbytes into
+         * _rbuf from rank _from, either rank may be -1 for none
+         */
+        virtual void exchange(int _to, void const * _sbuf, size_t _sbytes, int _from, void * _rbuf, size_t _rbytes) = 0;
+        /* queue an exchange, the buffers must stay untouched until wait() */
+        void post(int _to, void const * _sbuf, size_t _sbytes, int _from, void * _rbuf, size_t _rbytes) {
+            request l_req;
+            l_req.to_ = _to; l_req.from_ = _from;
+            l_req.sbuf_ = _sbuf; l_req.rbuf_ = _rbuf;
+            l_req.sbytes_ = _sbytes; l_req.rbytes_ = _rbytes;
+            pending_.push_back(l_req);
+        }
+        virtual void begin(void) { }
+        virtual void wait(void) {
+            for (size_t k = 0; k < pending_.size(); ++k)
+                exchange(pending_[k].to_, pending_[k].sbuf_, pending_[k].sbytes_, pending_[k].from_, pending_[k].rbuf_, pending_[k].rbytes_);
+            pending_.clear();
+        }
+};
+
+/* Ranks connected by TCP sockets, on one or several hosts.
+ * Pochoir_Socket_Transport(n) forks the calling process into n ranks on
+ * this host, the caller being rank 0, which is the way to test on one 
+ * machine. The workers of a backend don't survive a fork, so it has to 
+ * be constructed before any run has started them (first thing in main()
+ * is safe), each rank then starts its own; it quits otherwise. 
+ * Pochoir_Socket_Transport() joins a run whose ranks are 
+ * started apart, from POCHOIR_RANK, POCHOIR_NRANKS, POCHOIR_PORT 
+ * (rank r listens on port POCHOIR_PORT + r) and POCHOIR_HOSTS (the host
+ * of each rank, separated by commas, 127.0.0.1 by default).
+ * Rank r connects to every lower rank, and accepts the higher ones.
+ */
+class Pochoir_Socket_Transport : public Pochoir_Transport {
+    private:
+        int rank_, size_;
+        std::vector<int> fd_;
+        std::vector<pid_t> child_;
+        /* moves the posted exchanges between begin() and wait() */
+        std::thread progress_;
+
+        static void error(char const * _what) {
+            printf("Pochoir transport error:\n");
+            printf("%s : %s\n", _what, strerror(errno));
+            exit(1);
+        }
+        static int listen_on(int _port) {
+            int const l_fd = socket(AF_INET, SOCK_STREAM, 0);
+            int l_one = 1;
+            struct sockaddr_in l_addr;
+            if (l_fd < 0)
+                error("socket()");
+            setsockopt(l_fd, SOL_SOCKET, SO_REUSEADDR, &l_one, sizeof(l_one));
+            memset(&l_addr, 0, sizeof(l_addr));
+            l_addr.sin_family = AF_INET;
+            l_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+            l_addr.sin_port = htons(_port);
+            if (bind(l_fd, (struct sockaddr *)&l_addr, sizeof(l_addr)) < 0)
+                error("bind()");
+            if (listen(l_fd, 64) < 0)
+                error("listen()");
+            return l_fd;
+        }
+        static int port_of(int _fd) {
+            struct sockaddr_in l_addr;
+            socklen_t l_len = sizeof(l_addr);
+            getsockname(_fd, (struct sockaddr *)&l_addr, &l_len);
+            return ntohs(l_addr.sin_port);
+        }
+        static void write_all(int _fd, void const * _buf, size_t _bytes);
+        static void read_all(int _fd, void * _buf, size_t _bytes);
+        void connect_all(int _listen_fd, std::vector<std::string> const & _hosts, std::vector<int> const & _ports);
+    public:
+        explicit Pochoir_Socket_Transport(int _n);
+        Pochoir_Socket_Transport(void);
+        ~Pochoir_Socket_Transport(void);
+        int rank(void) const { return rank_; }
+        int size(void) const { return size_; }
+        void exchange(int _to, void const * _sbuf, size_t _sbytes, int _from, void * _rbuf, size_t _rbytes);
+        void begin(void) {
+            if (pending_.empty())
+                return;
+            progress_ = std::thread([this]() { Pochoir_Transport::wait(); });
+        }
+        void wait(void) {
+            if (progress_.joinable())
+                progress_.join();
+            else
+                Pochoir_Transport::wait();
+        }
+};
+
+inline void Pochoir_Socket_Transport::write_all(int _fd, void const * _buf, size_t _bytes) {
+    char const * l_p = (char const *)_buf;
+    while (_bytes > 0) {
+        ssize_t const l_n = write(_fd, l_p, _bytes);
+        if (l_n < 0 && errno == EINTR)
+            continue;
+        if (l_n <= 0)
+            error("write()");
+        l_p += l_n; _bytes -= l_n;
+    }
+}
+
+inline void Pochoir_Socket_Transport::read_all(int _fd, void * _buf, size_t _bytes) {
+    char * l_p = (char *)_buf;
+    while (_bytes > 0) {
+        ssize_t const l_n = read(_fd, l_p, _bytes);
+        if (l_n < 0 && errno == EINTR)
+            continue;
+        if (l_n <= 0)
+            error("read()");
+        l_p += l_n; _bytes -= l_n;
+    }
+}
+
+inline void Pochoir_Socket_Transport::connect_all(int _listen_fd, std::vector<std::string> const & _hosts, std::vector<int> const & _ports) {
+    int l_one = 1;
+    fd_.assign(size_, -1);
+    for (int j = 0; j < rank_; ++j) {
+        struct sockaddr_in l_addr;
+        memset(&l_addr, 0, sizeof(l_addr));
+        l_addr.sin_family = AF_INET;
+        l_addr.sin_port = htons(_ports[j]);
+        inet_pton(AF_INET, _hosts[j].c_str(), &l_addr.sin_addr);
+        /* rank j may not listen yet */
+        for (int l_try = 0; ; ++l_try) {
+            int const l_fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (connect(l_fd, (struct sockaddr *)&l_addr, sizeof(l_addr)) == 0) {
+                fd_[j] = l_fd;
+                break;
+            }
+            close(l_fd);
+            if (l_try == 3000)
+                error("connect()");
+            usleep(10000);
+        }
+        write_all(fd_[j], &rank_, sizeof(rank_));
+    }
+    for (int j = rank_ + 1; j < size_; ++j) {
+        int const l_fd = accept(_listen_fd, NULL, NULL);
+        int l_rank = -1;
+        if (l_fd < 0)
+            error("accept()");
+        read_all(l_fd, &l_rank, sizeof(l_rank));
+        if (l_rank <= rank_ || l_rank >= size_ || fd_[l_rank] >= 0) {
+            printf("Pochoir transport error:\n");
+            printf("unexpected rank %d connecting to rank %d\n", l_rank, rank_);
+            exit(1);
+        }
+        fd_[l_rank] = l_fd;
+    }
+    for (int j = 0; j < size_; ++j) {
+        if (fd_[j] >= 0) {
+            setsockopt(fd_[j], IPPROTO_TCP, TCP_NODELAY, &l_one, sizeof(l_one));
+            fcntl(fd_[j], F_SETFL, fcntl(fd_[j], F_GETFL) | O_NONBLOCK);
+        }
+    }
+}
+
+inline Pochoir_Socket_Transport::Pochoir_Socket_Transport(int _n) : rank_(0), size_(_n) {
+    std::vector<int> l_listen(_n), l_ports(_n);
+    std::vector<std::string> l_hosts(_n, "127.0.0.1");
+    if (pochoir_workers_started()) {
+        printf("Pochoir transport error:\n");
+        printf("Pochoir_Socket_Transport(%d) forks the ranks, construct it before any run!\n", _n);
+        exit(1);
+    }
+    /* every rank listens before any of them connects */
+    for (int r = 0; r < _n; ++r) {
+        l_listen[r] = listen_on(0);
+        l_ports[r] = port_of(l_listen[r]);
+    }
+    fflush(stdout);
+    for (int r = 1; r < _n; ++r) {
+        pid_t const l_pid = fork();
+        if (l_pid < 0)
+            error("fork()");
+        if (l_pid == 0) {
+            rank_ = r;
+            child_.clear();
+            break;
+        }
+        child_.push_back(l_pid);
+    }
+    for (int r = 0; r < _n; ++r) {
+        if (r != rank_)
+            close(l_listen[r]);
+    }
+    connect_all(l_listen[rank_], l_hosts, l_ports);
+    close(l_listen[rank_]);
+}
+
+inline Pochoir_Socket_Transport::Pochoir_Socket_Transport(void) {
+    char const * l_rank = getenv("POCHOIR_RANK");
+    char const * l_size = getenv("POCHOIR_NRANKS");
+    char const * l_port = getenv("POCHOIR_PORT");
+    char const * l_hosts = getenv("POCHOIR_HOSTS");
+    rank_ = (l_rank != NULL) ? atoi(l_rank) : 0;
+    size_ = (l_size != NULL) ? atoi(l_size) : 1;
+    int const l_base = (l_port != NULL) ? atoi(l_port) : 17000;
+    if (size_ <= 0 || rank_ < 0 || rank_ >= size_) {
+        printf("Pochoir transport error:\n");
+        printf("POCHOIR_RANK = %d is not within POCHOIR_NRANKS = %d\n", rank_, size_);
+        exit(1);
+    }
+    std::vector<int> l_ports(size_);
+    std::vector<std::string> l_host(size_, "127.0.0.1");
+    for (int r = 0; r < size_; ++r)
+        l_ports[r] = l_base + r;
+    for (int r = 0; l_hosts != NULL && *l_hosts != '\0' && r < size_; ++r) {
+        char const * l_end = strchr(l_hosts, ',');
+        l_host[r] = (l_end != NULL) ? std::string(l_hosts, l_end - l_hosts) : std::string(l_hosts);
+        l_hosts = (l_end != NULL) ? l_end + 1 : "";
+    }
+    int const l_listen = (rank_ + 1 < size_) ? listen_on(l_ports[rank_]) : -1;
+    connect_all(l_listen, l_host, l_ports);
+    if (l_listen >= 0)
+        close(l_listen);
+}
+
+/* the ranks forked by the constructor exit with their process, rank 0
+ * waits for them
+ */
+inline Pochoir_Socket_Transport::~Pochoir_Socket_Transport(void) {
+    wait();
+    for (int j = 0; j < size_; ++j) {
+        if (fd_[j] >= 0)
+            close(fd_[j]);
+    }
+    for (size_t k = 0; k < child_.size(); ++k)
+        waitpid(child_[k], NULL, 0);
+}
+
+/* both directions progress together, so that two ranks sending to each
+ * other can't block on full socket buffers
+ */
+inline void Pochoir_Socket_Transport::exchange(int _to, void const * _sbuf, size_t _sbytes, int _from, void * _rbuf, size_t _rbytes) {
+    if (_to == rank_ && _from == rank_) {
+        memcpy(_rbuf, _sbuf, (_sbytes < _rbytes) ? _sbytes : _rbytes);
+        return;
+    }
+    char const * l_s = (char const *)_sbuf;
+    char * l_r = (char *)_rbuf;
+    if (_to < 0) _sbytes = 0;
+    if (_from < 0) _rbytes = 0;
+    while (_sbytes > 0 || _rbytes > 0) {
+        struct pollfd l_poll[2];
+        int l_n = 0;
+        if (_sbytes > 0) {
+            l_poll[l_n].fd = fd_[_to]; l_poll[l_n].events = POLLOUT; ++l_n;
+        }
+        if (_rbytes > 0) {
+            l_poll[l_n].fd = fd_[_from]; l_poll[l_n].events = POLLIN; ++l_n;
+        }
+        if (poll(l_poll, l_n, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            error("poll()");
+        }
+        for (int k = 0; k < l_n; ++k) {
+            if (l_poll[k].revents == 0)
+                continue;
+            if (l_poll[k].events == POLLOUT) {
+                ssize_t const l_w = write(l_poll[k].fd, l_s, _sbytes);
+                if (l_w < 0 && errno != EAGAIN && errno != EINTR)
+                    error("write()");
+                if (l_w > 0) {
+                    l_s += l_w; _sbytes -= l_w;
+                }
+            } else {
+                ssize_t const l_got = read(l_poll[k].fd, l_r, _rbytes);
+                if (l_got == 0 || (l_got < 0 && errno != EAGAIN && errno != EINTR))
+                    error("read()");
+                if (l_got > 0) {
+                    l_r += l_got; _rbytes -= l_got;
+                }
+            }
+        }
+    }
+}
+
+#endif /* POCHOIR_TRANSPORT_H */
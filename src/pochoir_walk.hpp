@@ -29,10 +29,13 @@
 #include <cstdio>
 #include <cassert>
 #include <iostream>
-#include <cilk/cilk.h>
-#include <cilk/cilk_api.h>
-#include <cilk/reducer_opadd.h>
+#include <atomic>
+#include <vector>
 #include "pochoir_common.hpp"
+#include "pochoir_parallel.hpp"
+#if STAT
+#include <cilk/reducer_opadd.h>
+#endif
 
 using namespace std;
 
@@ -52,7 +55,7 @@ struct meta_grid_boundary <8, BF>{
         for (int k = grid.x0[5]; k < grid.x1[5]; ++k) {
             int new_k = pmod_lu(k, initial_grid.x0[5], initial_grid.x1[5]);
             for (int l = grid.x0[4]; l < grid.x1[4]; ++l) {
-                int new_l = pmod_lu(l, initial_gird.x0[4], initial_grid.x1[4]);
+                int new_l = pmod_lu(l, initial_grid.x0[4], initial_grid.x1[4]);
         for (int m = grid.x0[3]; m < grid.x1[3]; ++m) {
             int new_m = pmod_lu(m, initial_grid.x0[3], initial_grid.x1[3]);
             for (int n = grid.x0[2]; n < grid.x1[2]; ++n) {
@@ -83,7 +86,7 @@ struct meta_grid_boundary <7, BF>{
         for (int k = grid.x0[4]; k < grid.x1[4]; ++k) {
             int new_k = pmod_lu(k, initial_grid.x0[4], initial_grid.x1[4]);
             for (int l = grid.x0[3]; l < grid.x1[3]; ++l) {
-                int new_l = pmod_lu(l, initial_gird.x0[3], initial_grid.x1[3]);
+                int new_l = pmod_lu(l, initial_grid.x0[3], initial_grid.x1[3]);
         for (int m = grid.x0[2]; m < grid.x1[2]; ++m) {
             int new_m = pmod_lu(m, initial_grid.x0[2], initial_grid.x1[2]);
             for (int n = grid.x0[1]; n < grid.x1[1]; ++n) {
@@ -112,7 +115,7 @@ struct meta_grid_boundary <6, BF>{
         for (int k = grid.x0[3]; k < grid.x1[3]; ++k) {
             int new_k = pmod_lu(k, initial_grid.x0[3], initial_grid.x1[3]);
             for (int l = grid.x0[2]; l < grid.x1[2]; ++l) {
-                int new_l = pmod_lu(l, initial_gird.x0[2], initial_grid.x1[2]);
+                int new_l = pmod_lu(l, initial_grid.x0[2], initial_grid.x1[2]);
         for (int m = grid.x0[1]; m < grid.x1[1]; ++m) {
             int new_m = pmod_lu(m, initial_grid.x0[1], initial_grid.x1[1]);
             for (int n = grid.x0[0]; n < grid.x1[0]; ++n) {
@@ -138,7 +141,7 @@ struct meta_grid_boundary <5, BF>{
         for (int k = grid.x0[2]; k < grid.x1[2]; ++k) {
             int new_k = pmod_lu(k, initial_grid.x0[2], initial_grid.x1[2]);
             for (int l = grid.x0[1]; l < grid.x1[1]; ++l) {
-                int new_l = pmod_lu(l, initial_gird.x0[1], initial_grid.x1[1]);
+                int new_l = pmod_lu(l, initial_grid.x0[1], initial_grid.x1[1]);
         for (int m = grid.x0[0]; m < grid.x1[0]; ++m) {
             int new_m = pmod_lu(m, initial_grid.x0[0], initial_grid.x1[0]);
                 if (inRun) {
@@ -162,7 +165,7 @@ struct meta_grid_boundary <4, BF>{
         for (int k = grid.x0[1]; k < grid.x1[1]; ++k) {
             int new_k = pmod_lu(k, initial_grid.x0[1], initial_grid.x1[1]);
             for (int l = grid.x0[0]; l < grid.x1[0]; ++l) {
-                int new_l = pmod_lu(l, initial_gird.x0[0], initial_grid.x1[0]);
+                int new_l = pmod_lu(l, initial_grid.x0[0], initial_grid.x1[0]);
                 if (inRun) {
                     home_cell_[4] = new_l; home_cell_[3] = new_k;
                     home_cell_[2] = new_j; home_cell_[1] = new_i;
@@ -343,7 +346,7 @@ struct meta_grid_interior <1, F>{
 static inline void set_worker_count(const char * nstr) 
 {
 #if 1
-    if (0 != __cilkrts_set_param("nworkers", nstr)) {
+    if (!pochoir_set_nworkers(nstr)) {
         printf("Failed to set worker count\n");
     } else {
         printf("Successfully set worker count to %s\n", nstr);
@@ -361,6 +364,70 @@ struct power<1> {
     enum {value = 5};
 }; 
 
+template <int N_RANK>
+struct power3 {
+    enum { value = 3 * power3<N_RANK-1>::value };
+};
+
+template <>
+struct power3<0> {
+    enum {value = 1};
+};
+
+/* bytes of the registered arrays a wavefront slab should stay within */
+#define WAVE_BUDGET (32 * 1024)
+/* # of slabs a base-case zoid should hold along the outermost dimension */
+#define WAVE_SLABS 4
+
+/* Pochoir_Wavefront runs the base-case zoids of an obase kernel 'f' as a
+ * skewed sweep along the outermost dimension : the zoid is cut into slabs
+ * of 'rows' rows (0 picks them so that a slab of 'cell_bytes' per point
+ * fits in WAVE_BUDGET bytes), and a slab runs all the time steps of the
+ * zoid before the next one starts, so its rows are updated t1 - t0 times
+ * while they stay in cache. The cuts lean back by 'lean' per time step,
+ * which keeps the points a slab reads in itself or the slabs before it,
+ * and the time planes it reads from being overwritten by them.
+ * A 'lean' of 0 just calls 'f' on the whole zoid.
+ */
+template <int N_RANK, typename F>
+struct Pochoir_Wavefront {
+    F const & f_;
+    int rows_, lean_;
+    size_t cell_bytes_;
+    Pochoir_Wavefront(F const & f, int rows, int lean, size_t cell_bytes) : f_(f), rows_(rows), lean_(lean), cell_bytes_(cell_bytes) {}
+    inline void operator() (int t0, int t1, grid_info<N_RANK> const & grid) const {
+        int const i = N_RANK - 1, lt = t1 - t0;
+        /* any cut in [l_lo, l_hi] at t0 leaves every slab a non-negative
+         * width up to t1
+         */
+        int const l_lo = grid.x0[i] + (grid.dx0[i] + lean_) * lt;
+        int const l_hi = min(grid.x1[i], grid.x1[i] + (grid.dx1[i] + lean_) * lt);
+        if (lean_ <= 0 || lt < 2 || l_lo > l_hi) {
+            f_(t0, t1, grid);
+            return;
+        }
+        int l_rows = rows_;
+        if (l_rows <= 0) {
+            size_t l_row_bytes = cell_bytes_;
+            for (int j = 0; j < i; ++j)
+                l_row_bytes *= max(grid.x1[j] - grid.x0[j], grid.x1[j] + grid.dx1[j] * lt - grid.x0[j] - grid.dx0[j] * lt);
+            l_rows = max((int)(WAVE_BUDGET / max(l_row_bytes, (size_t)1)), 1);
+        }
+        grid_info<N_RANK> l_grid = grid;
+        l_grid.x1[i] = l_lo; l_grid.dx1[i] = -lean_;
+        f_(t0, t1, l_grid);
+        for (int a = l_lo; ; a += l_rows) {
+            bool const l_last = (a + l_rows >= l_hi);
+            l_grid.x0[i] = a; l_grid.dx0[i] = -lean_;
+            l_grid.x1[i] = l_last ? grid.x1[i] : a + l_rows;
+            l_grid.dx1[i] = l_last ? grid.dx1[i] : -lean_;
+            f_(t0, t1, l_grid);
+            if (l_last)
+                break;
+        }
+    }
+};
+
 template <int N_RANK>
 struct Algorithm {
 	private:
@@ -385,12 +452,98 @@ struct Algorithm {
 
         int ALGOR_QUEUE_SIZE;
 
+        /* a hyperspace cut as a dag : dimension i is cut into n_pieces[i] 
+         * (1 or 3) pieces, each either of the first (dep 0) or of the 
+         * second (dep 1) dependency level, and a sub-zoid is a choice of
+         * one piece per dimension, numbered in base 3. A dep 1 piece 
+         * depends on all the dep 0 pieces of the same dimension, so 
+         * pred[k] counts the sub-zoids which differ from k in one such
+         * dimension and are not done yet
+         */
+        typedef struct {
+            int t0, t1;
+            int n_pieces[N_RANK], n_first[N_RANK];
+            int x0[N_RANK][3], dx0[N_RANK][3], x1[N_RANK][3], dx1[N_RANK][3];
+            bool dep[N_RANK][3];
+            std::atomic<int> pred[power3<N_RANK>::value];
+        } hyper_dag;
+
+        /* pipelined time slabs : dimension 'dim' of the grid is cut into
+         * n_strips strips, and every slab of dt time steps into an upright
+         * trapezoid per strip (kind 0) and an inverted triangle on the 
+         * right of each strip (kind 1). Node (s * 2 + kind) * n_strips + j 
+         * is spawned once its pred[] count of predecessors drops to zero,
+         * onto the group of workers of strip j out of n_groups
+         */
+        typedef struct {
+            int t0, t1, dt, dim, n_slabs, n_strips, n_groups;
+            bool ring;
+            grid_info<N_RANK> grid;
+            int const * bound;
+            std::atomic<int> * pred;
+        } pipe_dag;
+
+        /* a recorded walk, see make_plan() : a leaf is a base-case zoid, 
+         * mask being the dimensions in which it touches the boundary, 
+         * the children of a series node run one after the other and 
+         * those of a parallel node concurrently
+         */
+        typedef enum {PLAN_LEAF, PLAN_SERIES, PLAN_PARALLEL} plan_kind;
+        typedef struct {
+            plan_kind kind;
+            int t0, t1;
+            grid_info<N_RANK> grid;
+            int mask;
+            int first, num; /* children are plan_child_[first .. first+num) */
+        } plan_node;
+        std::vector<plan_node> plan_;
+        std::vector<int> plan_child_;
+        int plan_root_;
+        /* the walk the plan was made for, see save_plan() */
+        int plan_t0_, plan_t1_;
+        grid_info<N_RANK> plan_grid_;
+        inline int plan_add(plan_kind kind, int num, int const child[]);
+        inline int plan_walk(int t0, int t1, grid_info<N_RANK> const grid, int mask, bool boundary);
+        inline int plan_hyper(int t0, int t1, grid_info<N_RANK> const grid, bool boundary);
+        inline void plan_space_cut(int level, int d, int t0, int t1, grid_info<N_RANK> const grid, bool boundary, std::vector<int> dep[]);
+
+        /* the plan flattened into a schedule : one descriptor per leaf of 
+         * the cut tree, and a join descriptor (mask -1, nothing to run) at 
+         * the end of each parallel node. The successors of descriptor k are
+         * flat_succ_[flat_[k].first .. flat_[k].first + flat_[k].num), it 
+         * runs once its flat_pred_[k] count drops to zero
+         */
+        typedef struct {
+            int t0, t1;
+            grid_info<N_RANK> grid;
+            int mask;
+            int first, num, num_pred;
+        } flat_node;
+        std::vector<flat_node> flat_;
+        std::vector<int> flat_succ_;
+        std::atomic<int> * flat_pred_;
+        inline int flat_add(int t0, int t1, grid_info<N_RANK> const & grid, int mask);
+        inline int flatten(int n, int pred, std::vector<int> & edge);
+        inline void flat_link(std::vector<int> const & edge);
+
         /* we can use toggled circular queue! */
         grid_info<N_RANK> phys_grid_;
         int phys_length_[N_RANK];
         int slope_[N_RANK];
         int ulb_boundary[N_RANK], uub_boundary[N_RANK], lub_boundary[N_RANK];
         bool boundarySet, physGridSet, slopeSet;
+    public:
+        /* write the halo images of the cells a time step over a grid of a
+         * ghost-zone array has computed
+         */
+        typedef void (*ghost_fn)(void * arr, int t, grid_info<N_RANK> const & grid);
+    private:
+        /* arrays with a ghost zone, boundary zoids then run the interior
+         * kernel and write the halo images of the cells they computed
+         */
+        int num_ghost_;
+        void * const * ghost_arr_;
+        ghost_fn const * ghost_fn_;
 	public:
 #if STAT
     /* sim_count_cut will be accessed outside Algorithm object */
@@ -414,6 +567,12 @@ struct Algorithm {
         boundarySet = false;
         physGridSet = false;
         slopeSet = true;
+        num_ghost_ = 0;
+        ghost_arr_ = NULL;
+        ghost_fn_ = NULL;
+        plan_root_ = -1;
+        plan_t0_ = plan_t1_ = 0;
+        flat_pred_ = NULL;
         /* ALGOR_QUEUE_SIZE = 3^N_RANK */
         // ALGOR_QUEUE_SIZE = power<N_RANK>::value;
 #define ALGOR_QUEUE_SIZE (power<N_RANK>::value)
@@ -422,11 +581,12 @@ struct Algorithm {
 //            sim_count_cut[i] = 0;
 //        }
 #else
-        N_CORES = __cilkrts_get_nworkers();
+        N_CORES = pochoir_max_workers();
 #endif
 //        cout << " N_CORES = " << N_CORES << endl;
 
     }
+    ~Algorithm () { delete [] flat_pred_; }
 
     /* README!!!: set_phys_grid()/set_stride() must be called before call to 
      * - walk_adaptive 
@@ -460,6 +620,36 @@ struct Algorithm {
         printf("dx_thres[%d] = %d\n", 0, dx_recursive_[0]);
 #endif
     }
+    /* set the thresholds explicitly, e.g. from the autotuner in pochoir.hpp */
+    inline void set_thres(int _dt, int const _dx[]) {
+        dt_recursive_ = _dt;
+        for (int i = 0; i < N_RANK; ++i)
+            dx_recursive_[i] = _dx[i];
+    }
+    /* register the ghost-zone arrays of the Pochoir object, with a halo
+     * of _width[i] cells along dimension i. A zoid which computes cells 
+     * within that width of the domain edge writes their halo images, so 
+     * it has to be a boundary zoid, however far its slopes keep it off
+     * the edge
+     */
+    inline void set_ghost(int _n, void * const * _arr, ghost_fn const * _fn, int const * _width) {
+        num_ghost_ = _n;
+        ghost_arr_ = _arr;
+        ghost_fn_ = _fn;
+        for (int i = 0; i < N_RANK && _n > 0; ++i) {
+            int const l_band = max(slope_[i], _width[i]);
+            ulb_boundary[i] = phys_grid_.x1[i] - l_band;
+            uub_boundary[i] = phys_grid_.x1[i] + l_band;
+            lub_boundary[i] = phys_grid_.x0[i] + l_band;
+        }
+    }
+    inline bool ghost(void) const { return num_ghost_ > 0; }
+    inline void push_ghost(int t, grid_info<N_RANK> const & grid) {
+        for (int k = 0; k < num_ghost_; ++k)
+            ghost_fn_[k](ghost_arr_[k], t, grid);
+    }
+    inline int dt_thres(void) const { return dt_recursive_; }
+    inline int dx_thres(int i) const { return dx_recursive_[i]; }
     inline void push_queue(int dep, int level, int t0, int t1, grid_info<N_RANK> const & grid);
     inline queue_info & top_queue(int dep);
     inline void pop_queue(int dep);
@@ -474,7 +664,41 @@ struct Algorithm {
     template <typename F>
     inline void shorter_duo_sim_obase_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f);
     template <typename F>
+    inline void hyper_dag_node(hyper_dag * dag, int k, F const & f);
+    template <typename F>
     inline void shorter_duo_sim_obase_bicut(int t0, int t1, grid_info<N_RANK> const grid, F const & f);
+    template <typename G>
+    inline void pipeline_time(int t0, int t1, grid_info<N_RANK> const & grid, bool wrap, int dt, int depth, int groups, G const & g);
+    template <typename G>
+    inline void pipe_dag_node(pipe_dag * dag, int n, G const & g);
+    template <typename G, typename H>
+    inline void stream_time(int t0, int t1, grid_info<N_RANK> const & grid, bool wrap, int rows, int depth, G const & g, H const & h);
+
+    /* record the cut tree of walk_bicut_boundary_p() (boundary = true) or
+     * of walk_bicut() once, or with obase set the one of 
+     * shorter_duo_sim_obase_bicut_p() / shorter_duo_sim_obase_bicut(), 
+     * then replay it, calling leaf(t0, t1, grid, mask) on every base-case
+     * zoid. With flat set, the tree is turned into a flat schedule, which
+     * can also be saved and loaded back
+     */
+    inline void make_plan(int t0, int t1, grid_info<N_RANK> const & grid, bool boundary, bool obase, bool flat);
+    inline bool planned(void) const { return plan_root_ >= 0 || !flat_.empty(); }
+    inline void flatten_plan(void);
+    void save_plan(FILE * fp) const;
+    bool load_plan(FILE * fp, int t0, int t1, grid_info<N_RANK> const & grid);
+    template <typename L>
+    inline void replay_plan(L const & leaf) { 
+        if (!flat_.empty())
+            replay_flat(leaf);
+        else
+            replay_plan(plan_root_, leaf); 
+    }
+    template <typename L>
+    inline void replay_plan(int n, L const & leaf);
+    template <typename L>
+    inline void replay_flat(L const & leaf);
+    template <typename L>
+    inline void flat_node_run(int k, L const & leaf);
 
     template <typename F, typename BF>
     inline void shorter_duo_sim_obase_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf);
@@ -519,6 +743,16 @@ struct Algorithm {
 	inline void base_case_kernel_interior(int t0, int t1, grid_info<N_RANK> const grid, F const & f);
     template <typename BF> 
 	inline void base_case_kernel_boundary(int t0, int t1, grid_info<N_RANK> const grid, BF const & bf);
+    template <typename F, typename BF> 
+	inline void base_case_kernel_classified(int t0, int t1, grid_info<N_RANK> const grid, int mask, F const & f, BF const & bf);
+    template <typename F, typename BF> 
+	inline void base_case_obase_classified(int t0, int t1, grid_info<N_RANK> const grid, int mask, F const & f, BF const & bf);
+    template <typename G, typename BF> 
+	inline void classified_steps(int t0, int t1, grid_info<N_RANK> const grid, int mask, G const & g, BF const & bf);
+    template <typename F> 
+	inline void base_case_kernel_ghost(int t0, int t1, grid_info<N_RANK> const grid, F const & f);
+    template <typename F> 
+	inline void base_case_obase_ghost(int t0, int t1, grid_info<N_RANK> const grid, F const & f);
     template <typename F> 
 	inline void walk_serial(int t0, int t1, grid_info<N_RANK> const grid, F const & f);
 
@@ -538,6 +772,8 @@ struct Algorithm {
     inline void walk_ncores_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf);
     template <typename F, typename BF> 
     inline void walk_bicut_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf);
+    template <typename F, typename BF> 
+    inline void walk_bicut_boundary_m(int t0, int t1, grid_info<N_RANK> const grid, int mask, F const & f, BF const & bf);
     template <typename BF> 
     inline void obase_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, BF const & bf);
     template <typename BF> 
@@ -626,6 +862,187 @@ inline void Algorithm<N_RANK>::base_case_kernel_boundary(int t0, int t1, grid_in
 	}
 }
 
+/* # of pieces base_case_kernel_classified() cuts a dimension into. Along
+ * a period of the domain the pieces alternate between one inside run and
+ * one boundary run (the upper band merged with the lower band after it),
+ * whose lengths add up to the domain. A time step of a zoid is no wider 
+ * than the domain, or it would update a cell twice, so it holds at most
+ * the end of a run, a whole run of the other kind and the start of the
+ * next one : 3 pieces. A wider step still runs, with 'bf' throughout.
+ */
+#define BDRY_PIECES 3
+
+/* a boundary zoid touching the boundary in the dimensions of 'mask' : 
+ * each time step is split, per dimension of 'mask', into the cells whose
+ * stencil stays inside the domain and the bands within slope_ of the 
+ * edges (a band at the upper edge is merged with the wrapped-around band
+ * at the lower edge). The boxes that lie inside in every dimension run 
+ * the interior kernel 'f', so 'bf' only runs on the faces, edges and 
+ * corners of the shell
+ */
+template <int N_RANK> template <typename F, typename BF>
+inline void Algorithm<N_RANK>::base_case_kernel_classified(int t0, int t1, grid_info<N_RANK> const grid, int mask, F const & f, BF const & bf) {
+    classified_steps(t0, t1, grid, mask, [&](int t, grid_info<N_RANK> const & box) {
+        meta_grid_interior<N_RANK, F>::single_step(t, box, phys_grid_, f); }, bf);
+}
+
+/* same as base_case_kernel_classified(), but for an obase kernel, which 
+ * runs the inside boxes one time step at a time
+ */
+template <int N_RANK> template <typename F, typename BF>
+inline void Algorithm<N_RANK>::base_case_obase_classified(int t0, int t1, grid_info<N_RANK> const grid, int mask, F const & f, BF const & bf) {
+    classified_steps(t0, t1, grid, mask, [&](int t, grid_info<N_RANK> const & box) {
+        f(t, t+1, box); }, bf);
+}
+
+template <int N_RANK> template <typename G, typename BF>
+inline void Algorithm<N_RANK>::classified_steps(int t0, int t1, grid_info<N_RANK> const grid, int mask, G const & g, BF const & bf) {
+	grid_info<N_RANK> l_grid = grid;
+	for (int t = t0; t < t1; ++t) {
+        int l_lo[N_RANK][BDRY_PIECES], l_hi[N_RANK][BDRY_PIECES], l_pieces[N_RANK];
+        bool l_inside[N_RANK][BDRY_PIECES], l_empty = false, l_wide = false;
+        home_cell_[0] = t;
+        for (int i = 0; i < N_RANK; ++i) {
+            int const l_x0 = l_grid.x0[i], l_x1 = l_grid.x1[i];
+            l_empty = l_empty || (l_x0 >= l_x1);
+            if (!(mask & (1 << i))) {
+                l_lo[i][0] = l_x0; l_hi[i][0] = l_x1; 
+                l_inside[i][0] = true; l_pieces[i] = 1;
+                continue;
+            }
+            int n = 0;
+            for (int x = l_x0; x < l_x1; ) {
+                int const w = pmod_lu(x, phys_grid_.x0[i], phys_grid_.x1[i]);
+                int const l_base = x - w;
+                int l_end;
+                bool l_in;
+                if (w < lub_boundary[i]) {
+                    l_end = l_base + lub_boundary[i]; l_in = false;
+                } else if (w < ulb_boundary[i]) {
+                    l_end = l_base + ulb_boundary[i]; l_in = true;
+                } else {
+                    l_end = l_base + phys_grid_.x1[i] + slope_[i]; l_in = false;
+                }
+                l_end = min(l_end, l_x1);
+                if (!l_in && n > 0 && !l_inside[i][n-1]) {
+                    /* two adjacent bands, 'bf' wraps the indices anyway */
+                    l_hi[i][n-1] = l_end;
+                } else if (n == BDRY_PIECES) {
+                    /* a step wider than the bound above, 'bf' runs it */
+                    l_wide = true;
+                    break;
+                } else {
+                    /* 'f' takes the indices inside the domain */
+                    l_lo[i][n] = l_in ? w : x;
+                    l_hi[i][n] = l_in ? w + (l_end - x) : l_end;
+                    l_inside[i][n] = l_in;
+                    ++n;
+                }
+                x = l_end;
+            }
+            if (l_wide)
+                break;
+            l_pieces[i] = n;
+        }
+        if (l_wide)
+            meta_grid_boundary<N_RANK, BF>::single_step(t, l_grid, phys_grid_, bf);
+        int l_piece[N_RANK];
+        for (int i = 0; i < N_RANK; ++i)
+            l_piece[i] = 0;
+        while (!l_empty && !l_wide) {
+            grid_info<N_RANK> l_box;
+            bool l_in = true;
+            for (int i = 0; i < N_RANK; ++i) {
+                l_box.x0[i] = l_lo[i][l_piece[i]]; 
+                l_box.x1[i] = l_hi[i][l_piece[i]];
+                l_box.dx0[i] = l_box.dx1[i] = 0;
+                l_in = l_in && l_inside[i][l_piece[i]];
+            }
+            if (l_in)
+                g(t, l_box);
+            else
+                meta_grid_boundary<N_RANK, BF>::single_step(t, l_box, phys_grid_, bf);
+            int i = 0;
+            while (i < N_RANK && ++l_piece[i] == l_pieces[i]) {
+                l_piece[i] = 0; ++i;
+            }
+            if (i == N_RANK)
+                break;
+        }
+
+		/* because the shape is trapezoid! */
+		for (int i = 0; i < N_RANK; ++i) {
+			l_grid.x0[i] += l_grid.dx0[i]; l_grid.x1[i] += l_grid.dx1[i];
+		}
+	}
+}
+
+/* a boundary zoid over ghost-zone arrays : each time step runs the 
+ * interior kernel with the indices wrapped around the domain as for 'BF',
+ * then writes the halo images of the cells it computed
+ */
+template <int N_RANK> template <typename F>
+inline void Algorithm<N_RANK>::base_case_kernel_ghost(int t0, int t1, grid_info<N_RANK> const grid, F const & f) {
+	grid_info<N_RANK> l_grid = grid;
+	for (int t = t0; t < t1; ++t) {
+        home_cell_[0] = t;
+		meta_grid_boundary<N_RANK, F>::single_step(t, l_grid, phys_grid_, f);
+        push_ghost(t, l_grid);
+
+		for (int i = 0; i < N_RANK; ++i) {
+			l_grid.x0[i] += l_grid.dx0[i]; l_grid.x1[i] += l_grid.dx1[i];
+		}
+	}
+}
+
+/* same as base_case_kernel_ghost(), but for an obase kernel, which is
+ * called on the pieces of each time step that don't wrap around
+ */
+template <int N_RANK> template <typename F>
+inline void Algorithm<N_RANK>::base_case_obase_ghost(int t0, int t1, grid_info<N_RANK> const grid, F const & f) {
+	grid_info<N_RANK> l_grid = grid;
+	for (int t = t0; t < t1; ++t) {
+        int l_lo[N_RANK][2], l_hi[N_RANK][2], l_pieces[N_RANK];
+        bool l_empty = false;
+        for (int i = 0; i < N_RANK; ++i) {
+            int const l_x0 = l_grid.x0[i], l_x1 = l_grid.x1[i];
+            int const l_end = phys_grid_.x1[i];
+            l_empty = l_empty || (l_x0 >= l_x1);
+            l_pieces[i] = 1;
+            if (l_x1 <= l_end) {
+                l_lo[i][0] = l_x0; l_hi[i][0] = l_x1;
+            } else if (l_x0 >= l_end) {
+                l_lo[i][0] = l_x0 - phys_length_[i]; l_hi[i][0] = l_x1 - phys_length_[i];
+            } else {
+                l_lo[i][0] = l_x0; l_hi[i][0] = l_end;
+                l_lo[i][1] = phys_grid_.x0[i]; l_hi[i][1] = l_x1 - phys_length_[i];
+                l_pieces[i] = 2;
+            }
+        }
+        for (int c = 0; c < (1 << N_RANK) && !l_empty; ++c) {
+            grid_info<N_RANK> l_piece_grid;
+            bool l_valid = true;
+            for (int i = 0; i < N_RANK && l_valid; ++i) {
+                int const l_piece = (c >> i) & 1;
+                l_valid = (l_piece < l_pieces[i]);
+                if (l_valid) {
+                    l_piece_grid.x0[i] = l_lo[i][l_piece]; 
+                    l_piece_grid.x1[i] = l_hi[i][l_piece];
+                    l_piece_grid.dx0[i] = l_piece_grid.dx1[i] = 0;
+                }
+            }
+            if (l_valid)
+                f(t, t+1, l_piece_grid);
+        }
+        if (!l_empty)
+            push_ghost(t, l_grid);
+
+		for (int i = 0; i < N_RANK; ++i) {
+			l_grid.x0[i] += l_grid.dx0[i]; l_grid.x1[i] += l_grid.dx1[i];
+		}
+	}
+}
+
 #if DEBUG 
 template <int N_RANK>
 void Algorithm<N_RANK>::print_grid(FILE *fp, int t0, int t1, grid_info<N_RANK> const & grid)
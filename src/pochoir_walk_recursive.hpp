@@ -161,6 +161,7 @@ inline void Algorithm<N_RANK>::walk_serial(int t0, int t1, grid_info<N_RANK> con
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::walk_bicut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    pochoir_frame;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -184,33 +185,33 @@ inline void Algorithm<N_RANK>::walk_bicut(int t0, int t1, grid_info<N_RANK> cons
 			l_grid.dx0[i] = slope_[i];
 			l_grid.x1[i] = grid.x0[i] + sep;
 			l_grid.dx1[i] = -slope_[i];
-			cilk_spawn walk_bicut(t0, t1, l_grid, f);
+			pochoir_spawn(walk_bicut(t0, t1, l_grid, f));
 
 			l_grid.x0[i] = grid.x0[i] + sep;
 			l_grid.dx0[i] = slope_[i];
 			l_grid.x1[i] = grid.x1[i];
 			l_grid.dx1[i] = -slope_[i];
-			cilk_spawn walk_bicut(t0, t1, l_grid, f);
+			pochoir_spawn(walk_bicut(t0, t1, l_grid, f));
 #if DEBUG
 //			print_sync(stdout);
 #endif
-			cilk_sync;
+			pochoir_sync;
 			if (grid.dx0[i] != slope_[i]) {
 				l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
 				l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-				cilk_spawn walk_bicut(t0, t1, l_grid, f);
+				pochoir_spawn(walk_bicut(t0, t1, l_grid, f));
 			}
 
 			l_grid.x0[i] = grid.x0[i] + sep;
 			l_grid.dx0[i] = -slope_[i];
 			l_grid.x1[i] = grid.x0[i] + sep;
 			l_grid.dx1[i] = slope_[i];
-			cilk_spawn walk_bicut(t0, t1, l_grid, f);
+			pochoir_spawn(walk_bicut(t0, t1, l_grid, f));
 
 			if (grid.dx1[i] != -slope_[i]) {
 				l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
 				l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-				cilk_spawn walk_bicut(t0, t1, l_grid, f);
+				pochoir_spawn(walk_bicut(t0, t1, l_grid, f));
 			}
 #if DEBUG
 			printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -275,141 +276,136 @@ do { \
 /* ************************************************************************************** */
 /* following are the procedures for obase with duality , always cutting based on shorter bar
  */
+/* run the sub-zoid k of a hyperspace cut, then spawn the sub-zoids that
+ * this one was the last predecessor of
+ */
 template <int N_RANK> template <typename F>
-inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
+inline void Algorithm<N_RANK>::hyper_dag_node(hyper_dag * dag, int k, F const & f)
 {
-    queue_info *l_father;
-    queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
-    int queue_head_[2], queue_tail_[2], queue_len_[2];
-
-    for (int i = 0; i < 2; ++i) {
-        queue_head_[i] = queue_tail_[i] = queue_len_[i] = 0;
+    pochoir_frame;
+    grid_info<N_RANK> l_son_grid;
+    int l_piece[N_RANK];
+
+    for (int i = 0, l_k = k; i < N_RANK; ++i, l_k /= 3) {
+        const int p = l_k % 3;
+        l_piece[i] = p;
+        l_son_grid.x0[i] = dag->x0[i][p];
+        l_son_grid.dx0[i] = dag->dx0[i][p];
+        l_son_grid.x1[i] = dag->x1[i][p];
+        l_son_grid.dx1[i] = dag->dx1[i][p];
     }
+    shorter_duo_sim_obase_bicut(dag->t0, dag->t1, l_son_grid, f);
+
+    for (int i = 0, l_unit = 1; i < N_RANK; ++i, l_unit *= 3) {
+        if (dag->dep[i][l_piece[i]])
+            continue;
+        for (int q = 0; q < dag->n_pieces[i]; ++q) {
+            if (!dag->dep[i][q])
+                continue;
+            const int l_succ = k + (q - l_piece[i]) * l_unit;
+            if (--dag->pred[l_succ] == 0)
+                pochoir_spawn(hyper_dag_node(dag, l_succ, f));
+        }
+    }
+}
 
-    /* set up the initial grid */
-    push_queue(0, N_RANK-1, t0, t1, grid);
-    for (int curr_dep = 0; curr_dep < N_RANK+1; ++curr_dep) {
-        const int curr_dep_pointer = (curr_dep & 0x1);
-        while (queue_len_[curr_dep_pointer] > 0) {
-            top_queue(curr_dep_pointer, l_father);
-            if (l_father->level < 0) {
-                /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    shorter_duo_sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0)
-                    shorter_duo_sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-                else
-                    cilk_spawn shorter_duo_sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-#endif
-            } else {
-                /* performing a space cut on dimension 'level' */
-                pop_queue(curr_dep_pointer);
-                const grid_info<N_RANK> l_father_grid = l_father->grid;
-                const int t0 = l_father->t0, t1 = l_father->t1;
-                const int lt = (t1 - t0);
-                const int level = l_father->level;
-                const int thres = slope_[level] * lt;
-                const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
-                const int tb = (l_father_grid.x1[level] + l_father_grid.dx1[level] * lt - l_father_grid.x0[level] - l_father_grid.dx0[level] * lt);
-                const bool cut_lb = (lb < tb);
-                const bool can_cut = cut_lb ? (lb >= 2 * thres && lb > dx_recursive_[level]) : (tb >= 2 * thres && lb > dx_recursive_[level]);
-                if (!can_cut) {
-                    /* if we can't cut into this dimension, just directly push 
-                     * it into the circular queue 
-                     */
-                    push_queue(curr_dep_pointer, level-1, t0, t1, l_father_grid);
-                } else {
-                    /* can_cut! */
-                    if (cut_lb) {
-                        const int mid = (lb/2);
-                        grid_info<N_RANK> l_son_grid = l_father_grid;
-                        const int l_start = (l_father_grid.x0[level]);
-                        const int l_end = (l_father_grid.x1[level]);
-
-                        /* push the middle triangular minizoid (gray) into 
-                         * circular queue of (curr_dep) 
-                         */
-                        l_son_grid.x0[level] = l_start + mid - thres;
-                        l_son_grid.dx0[level] = slope_[level];
-                        l_son_grid.x1[level] = l_start + mid + thres;
-                        l_son_grid.dx1[level] = -slope_[level];
-                        push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
-
-                        /* cilk_sync */
-                        const int next_dep_pointer = (curr_dep + 1) & 0x1;
-                        /* push the left big trapezoid (black)
-                         * into circular queue of (curr_dep + 1)
-                         */
-                        l_son_grid.x0[level] = l_start;
-                        l_son_grid.dx0[level] = l_father_grid.dx0[level];
-                        l_son_grid.x1[level] = l_start + mid - thres;
-                        l_son_grid.dx1[level] = slope_[level];
-                        push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
-
-                        /* push the right big trapezoid (black)
-                         * into circular queue of (curr_dep + 1)
-                         */
-                        l_son_grid.x0[level] = l_start + mid + thres;
-                        l_son_grid.dx0[level] = -slope_[level];
-                        l_son_grid.x1[level] = l_end;
-                        l_son_grid.dx1[level] = l_father_grid.dx1[level];
-                        push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
-
-                    } /* end if (cut_lb) */
-                    else {
-                        /* cut_tb */
-                        const int mid = (tb/2);
-                        grid_info<N_RANK> l_son_grid = l_father_grid;
-                        const int l_start = (l_father_grid.x0[level]);
-                        const int l_end = (l_father_grid.x1[level]);
-                        const int ul_start = (l_father_grid.x0[level] + l_father_grid.dx0[level] * lt);
-
-                        /* push left black sub-grid into circular queue of (curr_dep) */
-                        l_son_grid.x0[level] = l_start;
-                        l_son_grid.dx0[level] = l_father_grid.dx0[level];
-                        l_son_grid.x1[level] = ul_start + mid;
-                        l_son_grid.dx1[level] = -slope_[level];
-                        push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
+/* Every dimension which can be cut is cut into three pieces at once, the
+ * sub-zoids then run as a dag : each one is spawned as soon as its own 
+ * neighbors of the first dependency level are done, instead of waiting
+ * for the whole level at a sync
+ */
+template <int N_RANK> template <typename F>
+inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
+{
+    pochoir_frame;
+    hyper_dag l_dag;
+    const int lt = (t1 - t0);
+
+    l_dag.t0 = t0; l_dag.t1 = t1;
+    for (int level = N_RANK-1; level >= 0; --level) {
+        const int thres = slope_[level] * lt;
+        const int lb = (grid.x1[level] - grid.x0[level]);
+        const int tb = (grid.x1[level] + grid.dx1[level] * lt - grid.x0[level] - grid.dx0[level] * lt);
+        const bool cut_lb = (lb < tb);
+        const bool can_cut = cut_lb ? (lb >= 2 * thres && lb > dx_recursive_[level]) : (tb >= 2 * thres && lb > dx_recursive_[level]);
+        const int l_start = (grid.x0[level]);
+        const int l_end = (grid.x1[level]);
+        int * x0 = l_dag.x0[level], * dx0 = l_dag.dx0[level];
+        int * x1 = l_dag.x1[level], * dx1 = l_dag.dx1[level];
+        bool * dep = l_dag.dep[level];
+
+        if (!can_cut) {
+            /* the dimension stays whole, in the first level */
+            x0[0] = l_start; dx0[0] = grid.dx0[level];
+            x1[0] = l_end; dx1[0] = grid.dx1[level];
+            dep[0] = false;
+            l_dag.n_pieces[level] = 1;
+            l_dag.n_first[level] = 1;
+        } else if (cut_lb) {
+            const int mid = (lb/2);
+            /* the middle triangular minizoid (gray) first */
+            x0[0] = l_start + mid - thres; dx0[0] = slope_[level];
+            x1[0] = l_start + mid + thres; dx1[0] = -slope_[level];
+            dep[0] = false;
+            /* then the left and right big trapezoids (black) */
+            x0[1] = l_start; dx0[1] = grid.dx0[level];
+            x1[1] = l_start + mid - thres; dx1[1] = slope_[level];
+            dep[1] = true;
+            x0[2] = l_start + mid + thres; dx0[2] = -slope_[level];
+            x1[2] = l_end; dx1[2] = grid.dx1[level];
+            dep[2] = true;
+            l_dag.n_pieces[level] = 3;
+            l_dag.n_first[level] = 1;
+        } else {
+            /* cut_tb */
+            const int mid = (tb/2);
+            const int ul_start = (grid.x0[level] + grid.dx0[level] * lt);
+            /* the left and right black sub-grids first */
+            x0[0] = l_start; dx0[0] = grid.dx0[level];
+            x1[0] = ul_start + mid; dx1[0] = -slope_[level];
+            dep[0] = false;
+            x0[1] = ul_start + mid; dx0[1] = slope_[level];
+            x1[1] = l_end; dx1[1] = grid.dx1[level];
+            dep[1] = false;
+            /* then the middle gray triangular minizoid */
+            x0[2] = ul_start + mid; dx0[2] = -slope_[level];
+            x1[2] = ul_start + mid; dx1[2] = slope_[level];
+            dep[2] = true;
+            l_dag.n_pieces[level] = 3;
+            l_dag.n_first[level] = 2;
+        }
+    }
 
-                        /* push right black sub-grid into circular queue of (curr_dep) */
-                        l_son_grid.x0[level] = ul_start + mid;;
-                        l_son_grid.dx0[level] = slope_[level];
-                        l_son_grid.x1[level] = l_end;
-                        l_son_grid.dx1[level] = l_father_grid.dx1[level];
-                        push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
+    /* count the predecessors of every sub-zoid */
+    for (int k = 0; k < power3<N_RANK>::value; ++k) {
+        int l_pred = 0;
+        bool l_valid = true;
+        for (int i = 0, l_k = k; i < N_RANK; ++i, l_k /= 3) {
+            const int p = l_k % 3;
+            l_valid = l_valid && (p < l_dag.n_pieces[i]);
+            if (l_valid && l_dag.dep[i][p])
+                l_pred += l_dag.n_first[i];
+        }
+        l_dag.pred[k] = l_valid ? l_pred : -1;
+    }
 
-                        /* cilk_sync */
-                        const int next_dep_pointer = (curr_dep + 1) & 0x1;
-                        /* push the middle gray triangular minizoid into 
-                         * circular queue of (curr_dep + 1)
-                         */
-                        l_son_grid.x0[level] = ul_start + mid;
-                        l_son_grid.dx0[level] = -slope_[level];
-                        l_son_grid.x1[level] = ul_start + mid;
-                        l_son_grid.dx1[level] = slope_[level];
-                        push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
-                    } /* end else (cut_tb) */
-                } /* end if (can_cut) */
-            } /* end if (performing a space cut) */
-        } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
-        assert(queue_len_[curr_dep_pointer] == 0);
-    } /* end for (curr_dep < N_RANK+1) */
+    /* spawn the sub-zoids with no predecessor, the rest follows. The roots
+     * are listed first, a spawned root may already have brought the count
+     * of another sub-zoid down to zero
+     */
+    hyper_dag * const l_dag_ptr = &l_dag;
+    int l_root[power3<N_RANK>::value], l_num_root = 0;
+    for (int k = 0; k < power3<N_RANK>::value; ++k) {
+        if (l_dag.pred[k] == 0)
+            l_root[l_num_root++] = k;
+    }
+    for (int r = 0; r < l_num_root; ++r)
+        pochoir_spawn(hyper_dag_node(l_dag_ptr, l_root[r], f));
+    /* the nodes point into l_dag, wait for them before it goes out of 
+     * scope rather than rely on the order of destruction of l_dag and 
+     * the frame
+     */
+    pochoir_sync;
 }
 
 /* This is for boundary region space cut! , always cutting based on the shorter bar
@@ -417,6 +413,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    pochoir_frame;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -436,13 +433,13 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
 #if USE_CILK_FOR 
                 /* use cilk_for to spawn all the sub-grid */
 // #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
+                pochoir_for(0, queue_len_[curr_dep_pointer], [&](int j) {
                     int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
                     queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
                     /* assert all the sub-grid has done N_RANK spatial cuts */
                     assert(l_son->level == -1);
                     shorter_duo_sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
-                } /* end cilk_for */
+                }); /* end pochoir_for */
                 queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
                 queue_len_[curr_dep_pointer] = 0;
 #else
@@ -451,7 +448,9 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
                 if (queue_len_[curr_dep_pointer] == 0) {
                     shorter_duo_sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
                 } else {
-                    cilk_spawn shorter_duo_sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
+                    /* the queue entry may be reused before the spawn runs */
+                    queue_info const l_son = *l_father;
+                    pochoir_spawn(shorter_duo_sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf));
                 }
 #endif
             } else {
@@ -565,7 +564,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
 #if !USE_CILK_FOR
-        cilk_sync;
+        pochoir_sync;
 #endif
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
@@ -575,6 +574,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    pochoir_frame;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -594,13 +594,13 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
 #if USE_CILK_FOR 
                 /* use cilk_for to spawn all the sub-grid */
 // #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
+                pochoir_for(0, queue_len_[curr_dep_pointer], [&](int j) {
                     int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
                     queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
                     /* assert all the sub-grid has done N_RANK spatial cuts */
                     assert(l_son->level == -1);
                     duo_sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
-                } /* end cilk_for */
+                }); /* end pochoir_for */
                 queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
                 queue_len_[curr_dep_pointer] = 0;
 #else
@@ -608,8 +608,11 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
                 pop_queue(curr_dep_pointer);
                 if (queue_len_[curr_dep_pointer] == 0)
                     duo_sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-                else
-                    cilk_spawn duo_sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
+                else {
+                    /* the queue entry may be reused before the spawn runs */
+                    queue_info const l_son = *l_father;
+                    pochoir_spawn(duo_sim_obase_bicut(l_son.t0, l_son.t1, l_son.grid, f));
+                }
 #endif
             } else {
                 /* performing a space cut on dimension 'level' */
@@ -695,7 +698,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
 #if !USE_CILK_FOR
-        cilk_sync;
+        pochoir_sync;
 #endif
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
@@ -705,6 +708,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    pochoir_frame;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -724,13 +728,13 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
 #if USE_CILK_FOR 
                 /* use cilk_for to spawn all the sub-grid */
 // #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
+                pochoir_for(0, queue_len_[curr_dep_pointer], [&](int j) {
                     int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
                     queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
                     /* assert all the sub-grid has done N_RANK spatial cuts */
                     assert(l_son->level == -1);
                     duo_sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
-                } /* end cilk_for */
+                }); /* end pochoir_for */
                 queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
                 queue_len_[curr_dep_pointer] = 0;
 #else
@@ -739,7 +743,9 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
                 if (queue_len_[curr_dep_pointer] == 0) {
                     duo_sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
                 } else {
-                    cilk_spawn duo_sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
+                    /* the queue entry may be reused before the spawn runs */
+                    queue_info const l_son = *l_father;
+                    pochoir_spawn(duo_sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf));
                 }
 #endif
             } else {
@@ -864,7 +870,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
 #if !USE_CILK_FOR
-        cilk_sync;
+        pochoir_sync;
 #endif
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
@@ -873,6 +879,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    pochoir_frame;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -892,13 +899,13 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
 #if USE_CILK_FOR 
                 /* use cilk_for to spawn all the sub-grid */
 // #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
+                pochoir_for(0, queue_len_[curr_dep_pointer], [&](int j) {
                     int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
                     queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
                     /* assert all the sub-grid has done N_RANK spatial cuts */
                     assert(l_son->level == -1);
                     sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
-                } /* end cilk_for */
+                }); /* end pochoir_for */
                 queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
                 queue_len_[curr_dep_pointer] = 0;
 #else
@@ -906,8 +913,11 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
                 pop_queue(curr_dep_pointer);
                 if (queue_len_[curr_dep_pointer] == 0)
                     sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-                else
-                    cilk_spawn sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
+                else {
+                    /* the queue entry may be reused before the spawn runs */
+                    queue_info const l_son = *l_father;
+                    pochoir_spawn(sim_obase_bicut(l_son.t0, l_son.t1, l_son.grid, f));
+                }
 #endif
             } else {
                 /* performing a space cut on dimension 'level' */
@@ -977,7 +987,7 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
 #if !USE_CILK_FOR
-        cilk_sync;
+        pochoir_sync;
 #endif
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
@@ -987,6 +997,7 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    pochoir_frame;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -1006,13 +1017,13 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N
 #if USE_CILK_FOR 
                 /* use cilk_for to spawn all the sub-grid */
 // #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
+                pochoir_for(0, queue_len_[curr_dep_pointer], [&](int j) {
                     int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
                     queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
                     /* assert all the sub-grid has done N_RANK spatial cuts */
                     assert(l_son->level == -1);
                     sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
-                } /* end cilk_for */
+                }); /* end pochoir_for */
                 queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
                 queue_len_[curr_dep_pointer] = 0;
 #else
@@ -1021,7 +1032,9 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N
                 if (queue_len_[curr_dep_pointer] == 0) {
                     sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
                 } else {
-                    cilk_spawn sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
+                    /* the queue entry may be reused before the spawn runs */
+                    queue_info const l_son = *l_father;
+                    pochoir_spawn(sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf));
                 }
 #endif
             } else {
@@ -1103,7 +1116,7 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
 #if !USE_CILK_FOR
-        cilk_sync;
+        pochoir_sync;
 #endif
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
@@ -1354,7 +1367,9 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_bicut_p(int t0, int t1, gri
         ++boundary_region_count;
         boundary_points_count += l_total_points;
 #endif
-        if (call_boundary) {
+        if (call_boundary && ghost()) {
+            base_case_obase_ghost(t0, t1, l_father_grid, f);
+        } else if (call_boundary) {
             base_case_kernel_boundary(t0, t1, l_father_grid, bf);
         } else {
             f(t0, t1, l_father_grid);
@@ -1365,6 +1380,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_bicut_p(int t0, int t1, gri
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    pochoir_frame;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -1384,13 +1400,13 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
 #if USE_CILK_FOR 
                 /* use cilk_for to spawn all the sub-grid */
 // #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
+                pochoir_for(0, queue_len_[curr_dep_pointer], [&](int j) {
                     int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
                     queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
                     /* assert all the sub-grid has done N_RANK spatial cuts */
                     assert(l_son->level == -1);
                     stevenj_bicut(l_son->t0, l_son->t1, l_son->grid, f);
-                } /* end cilk_for */
+                }); /* end pochoir_for */
                 queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
                 queue_len_[curr_dep_pointer] = 0;
 #else
@@ -1398,8 +1414,11 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
                 pop_queue(curr_dep_pointer);
                 if (queue_len_[curr_dep_pointer] == 0)
                     stevenj_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-                else
-                    cilk_spawn stevenj_bicut(l_father->t0, l_father->t1, l_father->grid, f);
+                else {
+                    /* the queue entry may be reused before the spawn runs */
+                    queue_info const l_son = *l_father;
+                    pochoir_spawn(stevenj_bicut(l_son.t0, l_son.t1, l_son.grid, f));
+                }
 #endif
             } else {
                 /* performing a space cut on dimension 'level' */
@@ -1493,7 +1512,7 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
 #if !USE_CILK_FOR
-        cilk_sync;
+        pochoir_sync;
 #endif
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
@@ -1504,6 +1523,7 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    pochoir_frame;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -1523,13 +1543,13 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
 #if USE_CILK_FOR 
                 /* use cilk_for to spawn all the sub-grid */
 // #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
+                pochoir_for(0, queue_len_[curr_dep_pointer], [&](int j) {
                     int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
                     queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
                     /* assert all the sub-grid has done N_RANK spatial cuts */
                     assert(l_son->level == -1);
                     stevenj_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
-                } /* end cilk_for */
+                }); /* end pochoir_for */
                 queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
                 queue_len_[curr_dep_pointer] = 0;
 #else
@@ -1538,7 +1558,9 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
                 if (queue_len_[curr_dep_pointer] == 0) {
                     stevenj_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
                 } else {
-                    cilk_spawn stevenj_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
+                    /* the queue entry may be reused before the spawn runs */
+                    queue_info const l_son = *l_father;
+                    pochoir_spawn(stevenj_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf));
                 }
 #endif
             } else {
@@ -1652,7 +1674,7 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
 #if !USE_CILK_FOR
-        cilk_sync;
+        pochoir_sync;
 #endif
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
@@ -2045,6 +2067,7 @@ inline void Algorithm<N_RANK>::sim_obase_bicut_p(int t0, int t1, grid_info<N_RAN
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::walk_adaptive(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    pochoir_frame;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -2085,34 +2108,34 @@ inline void Algorithm<N_RANK>::walk_adaptive(int t0, int t1, grid_info<N_RANK> c
 					l_grid.dx0[i] = slope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * (j+1);
 					l_grid.dx1[i] = -slope_[i];
-					cilk_spawn walk_adaptive(t0, t1, l_grid, f);
+					pochoir_spawn(walk_adaptive(t0, t1, l_grid, f));
 				}
 	//			j_loc = r-1;
 				l_grid.x0[i] = grid.x0[i] + sep * (r-1);
 				l_grid.dx0[i] = slope_[i];
 				l_grid.x1[i] = grid.x1[i];
 				l_grid.dx1[i] = -slope_[i];
-				cilk_spawn walk_adaptive(t0, t1, l_grid, f);
+				pochoir_spawn(walk_adaptive(t0, t1, l_grid, f));
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync;
 				if (grid.dx0[i] != slope_[i]) {
 					l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
 					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-					cilk_spawn walk_adaptive(t0, t1, l_grid, f);
+					pochoir_spawn(walk_adaptive(t0, t1, l_grid, f));
 				}
 				for (int j = 1; j < r; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
 					l_grid.dx0[i] = -slope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * j;
 					l_grid.dx1[i] = slope_[i];
-					cilk_spawn walk_adaptive(t0, t1, l_grid, f);
+					pochoir_spawn(walk_adaptive(t0, t1, l_grid, f));
 				}
 				if (grid.dx1[i] != -slope_[i]) {
 					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
 					l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-					cilk_spawn walk_adaptive(t0, t1, l_grid, f);
+					pochoir_spawn(walk_adaptive(t0, t1, l_grid, f));
 				}
 #if 0
 				printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -2151,10 +2174,25 @@ static int count_boundary = 0;
 static int count_internal = 0;
 #endif
 
-/* walk_ncores_boundary_p() will be called for -split-shadow mode */
+/* walk_bicut_boundary_p() classifies the top-level region as touching the
+ * boundary in every dimension, walk_bicut_boundary_m() then narrows the 
+ * classification zoid by zoid
+ */
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    walk_bicut_boundary_m(t0, t1, grid, (1 << N_RANK) - 1, f, bf);
+}
+
+/* 'mask' has bit i set if the zoid may touch the boundary in dimension i.
+ * A zoid which is interior in dimension i stays so for all its sub-zoids,
+ * so only the dimensions still in 'mask' are checked again by 
+ * touch_boundary(), and the result is handed down the recursion
+ */
+template <int N_RANK> template <typename F, typename BF>
+inline void Algorithm<N_RANK>::walk_bicut_boundary_m(int t0, int t1, grid_info<N_RANK> const grid, int mask, F const & f, BF const & bf)
+{
+    pochoir_frame;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2163,14 +2201,16 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 	index_info lb, thres;
     grid_info<N_RANK> l_father_grid = grid, l_son_grid;
     bool l_touch_boundary[N_RANK];
+    int l_mask = 0;
     int l_dt_stop;
 
 	for (int i = 0; i < N_RANK; ++i) {
-        l_touch_boundary[i] = touch_boundary(i, lt, l_father_grid);
+        l_touch_boundary[i] = (mask & (1 << i)) && touch_boundary(i, lt, l_father_grid);
+        l_mask |= (l_touch_boundary[i] << i);
 		lb[i] = (l_father_grid.x1[i] - l_father_grid.x0[i]);
 		thres[i] = 2 * (2 * slope_[i] * lt);
-		call_boundary |= l_touch_boundary[i];
 	}	
+    call_boundary = (l_mask != 0);
 
 	for (int i = N_RANK-1; i >= 0; --i) {
 		can_cut = (l_touch_boundary[i]) ? (lb[i] >= thres[i] && lb[i] > dx_recursive_boundary_[i]) : (lb[i] >= thres[i] && lb[i] > dx_recursive_[i]);
@@ -2186,9 +2226,9 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 			l_son_grid.x1[i] = l_start + sep;
 			l_son_grid.dx1[i] = -slope_[i];
             if (call_boundary) {
-                cilk_spawn walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                pochoir_spawn(walk_bicut_boundary_m(t0, t1, l_son_grid, l_mask, f, bf));
             } else {
-                cilk_spawn walk_bicut(t0, t1, l_son_grid, f);
+                pochoir_spawn(walk_bicut(t0, t1, l_son_grid, f));
             }
 
 			l_son_grid.x0[i] = l_start + sep;
@@ -2196,23 +2236,23 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 			l_son_grid.x1[i] = l_end;
 			l_son_grid.dx1[i] = -slope_[i];
             if (call_boundary) {
-                walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                walk_bicut_boundary_m(t0, t1, l_son_grid, l_mask, f, bf);
             } else {
                 walk_bicut(t0, t1, l_son_grid, f);
             }
 #if DEBUG
 			print_sync(stdout);
 #endif
-			cilk_sync;
+			pochoir_sync;
 
 			l_son_grid.x0[i] = l_start + sep;
 			l_son_grid.dx0[i] = -slope_[i];
 			l_son_grid.x1[i] = l_start + sep;
 			l_son_grid.dx1[i] = slope_[i];
             if (call_boundary) {
-                cilk_spawn walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                pochoir_spawn(walk_bicut_boundary_m(t0, t1, l_son_grid, l_mask, f, bf));
             } else {
-                cilk_spawn walk_bicut(t0, t1, l_son_grid, f);
+                pochoir_spawn(walk_bicut(t0, t1, l_son_grid, f));
             }
 
 			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
@@ -2222,9 +2262,9 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 				l_son_grid.x1[i] = l_end;
 				l_son_grid.dx1[i] = slope_[i];
                 if (call_boundary) {
-                    cilk_spawn walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                    pochoir_spawn(walk_bicut_boundary_m(t0, t1, l_son_grid, l_mask, f, bf));
                 } else {
-                    cilk_spawn walk_bicut(t0, t1, l_son_grid, f);
+                    pochoir_spawn(walk_bicut(t0, t1, l_son_grid, f));
                 }
 			} else {
 				if (l_father_grid.dx0[i] != slope_[i]) {
@@ -2233,9 +2273,9 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 					l_son_grid.x1[i] = l_start; 
 					l_son_grid.dx1[i] = slope_[i];
                     if (call_boundary) {
-                        cilk_spawn walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(walk_bicut_boundary_m(t0, t1, l_son_grid, l_mask, f, bf));
                     } else {
-                        cilk_spawn walk_bicut(t0, t1, l_son_grid, f);
+                        pochoir_spawn(walk_bicut(t0, t1, l_son_grid, f));
                     }
 				}
 				if (l_father_grid.dx1[i] != -slope_[i]) {
@@ -2244,9 +2284,9 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 					l_son_grid.x1[i] = l_end; 
 					l_son_grid.dx1[i] = l_father_grid.dx1[i];
                     if (call_boundary) {
-                        cilk_spawn walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(walk_bicut_boundary_m(t0, t1, l_son_grid, l_mask, f, bf));
                     } else {
-                        cilk_spawn walk_bicut(t0, t1, l_son_grid, f);
+                        pochoir_spawn(walk_bicut(t0, t1, l_son_grid, f));
                     }
 				}
 			}
@@ -2261,7 +2301,7 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 		int halflt = lt / 2;
 		l_son_grid = l_father_grid;
         if (call_boundary) {
-            walk_bicut_boundary_p(t0, t0+halflt, l_son_grid, f, bf);
+            walk_bicut_boundary_m(t0, t0+halflt, l_son_grid, l_mask, f, bf);
         } else {
             walk_bicut(t0, t0+halflt, l_son_grid, f);
         }
@@ -2275,7 +2315,7 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 			l_son_grid.dx1[i] = l_father_grid.dx1[i];
 		}
         if (call_boundary) { 
-            walk_bicut_boundary_p(t0+halflt, t1, l_son_grid, f, bf);
+            walk_bicut_boundary_m(t0+halflt, t1, l_son_grid, l_mask, f, bf);
         } else {
             walk_bicut(t0+halflt, t1, l_son_grid, f);
         }
@@ -2291,7 +2331,10 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
         printf("call Boundary! ");
         print_grid(stdout, t0, t1, l_father_grid);
 #endif
-		base_case_kernel_boundary(t0, t1, l_father_grid, bf);
+        if (ghost())
+            base_case_kernel_ghost(t0, t1, l_father_grid, f);
+        else
+            base_case_kernel_classified(t0, t1, l_father_grid, l_mask, f, bf);
     } else {
 #if DEBUG
         printf("call Interior! ");
@@ -2307,6 +2350,7 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    pochoir_frame;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2362,9 +2406,9 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 					l_son_grid.x1[i] = l_start + sep * (j+1);
 					l_son_grid.dx1[i] = -slope_[i];
                     if (call_boundary) {
-                        cilk_spawn walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf));
                     } else {
-                        cilk_spawn walk_adaptive(t0, t1, l_son_grid, f);
+                        pochoir_spawn(walk_adaptive(t0, t1, l_son_grid, f));
                     }
 				}
 				l_son_grid.x0[i] = l_start + sep * j;
@@ -2379,16 +2423,16 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync;
 				for (j = 1; j < r; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
 					l_son_grid.dx0[i] = -slope_[i];
 					l_son_grid.x1[i] = l_start + sep * j;
 					l_son_grid.dx1[i] = slope_[i];
                     if (call_boundary) {
-                        cilk_spawn walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf));
                     } else {
-                        cilk_spawn walk_adaptive(t0, t1, l_son_grid, f);
+                        pochoir_spawn(walk_adaptive(t0, t1, l_son_grid, f));
                     }
 				}
 				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
@@ -2398,9 +2442,9 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 					l_son_grid.x1[i] = l_end;
 					l_son_grid.dx1[i] = slope_[i];
                     if (call_boundary) {
-                        cilk_spawn walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf));
                     } else {
-                        cilk_spawn walk_adaptive(t0, t1, l_son_grid, f);
+                        pochoir_spawn(walk_adaptive(t0, t1, l_son_grid, f));
                     }
 				} else {
 					if (l_father_grid.dx0[i] != slope_[i]) {
@@ -2409,9 +2453,9 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 						l_son_grid.x1[i] = l_start; 
 						l_son_grid.dx1[i] = slope_[i];
                         if (call_boundary) {
-                            cilk_spawn walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);
+                            pochoir_spawn(walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf));
                         } else {
-                            cilk_spawn walk_adaptive(t0, t1, l_son_grid, f);
+                            pochoir_spawn(walk_adaptive(t0, t1, l_son_grid, f));
                         }
 					}
 					if (l_father_grid.dx1[i] != -slope_[i]) {
@@ -2420,9 +2464,9 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 						l_son_grid.x1[i] = l_end; 
 						l_son_grid.dx1[i] = l_father_grid.dx1[i];
                         if (call_boundary) {
-                            cilk_spawn walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);
+                            pochoir_spawn(walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf));
                         } else {
-                            cilk_spawn walk_adaptive(t0, t1, l_son_grid, f);
+                            pochoir_spawn(walk_adaptive(t0, t1, l_son_grid, f));
                         }
 					}
 				}
@@ -2462,6 +2506,7 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::obase_bicut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    pochoir_frame;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -2485,33 +2530,33 @@ inline void Algorithm<N_RANK>::obase_bicut(int t0, int t1, grid_info<N_RANK> con
 			l_grid.dx0[i] = slope_[i];
 			l_grid.x1[i] = grid.x0[i] + sep;
 			l_grid.dx1[i] = -slope_[i];
-			cilk_spawn obase_bicut(t0, t1, l_grid, f);
+			pochoir_spawn(obase_bicut(t0, t1, l_grid, f));
 
 			l_grid.x0[i] = grid.x0[i] + sep;
 			l_grid.dx0[i] = slope_[i];
 			l_grid.x1[i] = grid.x1[i];
 			l_grid.dx1[i] = -slope_[i];
-			cilk_spawn obase_bicut(t0, t1, l_grid, f);
+			pochoir_spawn(obase_bicut(t0, t1, l_grid, f));
 #if DEBUG
 //			print_sync(stdout);
 #endif
-			cilk_sync;
+			pochoir_sync;
 			if (grid.dx0[i] != slope_[i]) {
 				l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
 				l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-				cilk_spawn obase_bicut(t0, t1, l_grid, f);
+				pochoir_spawn(obase_bicut(t0, t1, l_grid, f));
 			}
 
 			l_grid.x0[i] = grid.x0[i] + sep;
 			l_grid.dx0[i] = -slope_[i];
 			l_grid.x1[i] = grid.x0[i] + sep;
 			l_grid.dx1[i] = slope_[i];
-			cilk_spawn obase_bicut(t0, t1, l_grid, f);
+			pochoir_spawn(obase_bicut(t0, t1, l_grid, f));
 
 			if (grid.dx1[i] != -slope_[i]) {
 				l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
 				l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-				cilk_spawn obase_bicut(t0, t1, l_grid, f);
+				pochoir_spawn(obase_bicut(t0, t1, l_grid, f));
 			}
 #if DEBUG
 			printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -2553,6 +2598,7 @@ inline void Algorithm<N_RANK>::obase_bicut(int t0, int t1, grid_info<N_RANK> con
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::obase_m(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    pochoir_frame;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -2594,34 +2640,34 @@ inline void Algorithm<N_RANK>::obase_m(int t0, int t1, grid_info<N_RANK> const g
 					l_grid.dx0[i] = slope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * (j+1);
 					l_grid.dx1[i] = -slope_[i];
-					cilk_spawn obase_m(t0, t1, l_grid, f);
+					pochoir_spawn(obase_m(t0, t1, l_grid, f));
 				}
 	//			j_loc = r-1;
 				l_grid.x0[i] = grid.x0[i] + sep * (r-1);
 				l_grid.dx0[i] = slope_[i];
 				l_grid.x1[i] = grid.x1[i];
 				l_grid.dx1[i] = -slope_[i];
-				cilk_spawn obase_m(t0, t1, l_grid, f);
+				pochoir_spawn(obase_m(t0, t1, l_grid, f));
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync;
 				if (grid.dx0[i] != slope_[i]) {
 					l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
 					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-					cilk_spawn obase_m(t0, t1, l_grid, f);
+					pochoir_spawn(obase_m(t0, t1, l_grid, f));
 				}
 				for (int j = 1; j < r; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
 					l_grid.dx0[i] = -slope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * j;
 					l_grid.dx1[i] = slope_[i];
-					cilk_spawn obase_m(t0, t1, l_grid, f);
+					pochoir_spawn(obase_m(t0, t1, l_grid, f));
 				}
 				if (grid.dx1[i] != -slope_[i]) {
 					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
 					l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-					cilk_spawn obase_m(t0, t1, l_grid, f);
+					pochoir_spawn(obase_m(t0, t1, l_grid, f));
 				}
 #if 0
 				printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -2659,6 +2705,7 @@ inline void Algorithm<N_RANK>::obase_m(int t0, int t1, grid_info<N_RANK> const g
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::obase_adaptive(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    pochoir_frame;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -2697,34 +2744,34 @@ inline void Algorithm<N_RANK>::obase_adaptive(int t0, int t1, grid_info<N_RANK>
 					l_grid.dx0[i] = slope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * (j+1);
 					l_grid.dx1[i] = -slope_[i];
-					cilk_spawn obase_adaptive(t0, t1, l_grid, f);
+					pochoir_spawn(obase_adaptive(t0, t1, l_grid, f));
 				}
 	//			j_loc = r-1;
 				l_grid.x0[i] = grid.x0[i] + sep * (r-1);
 				l_grid.dx0[i] = slope_[i];
 				l_grid.x1[i] = grid.x1[i];
 				l_grid.dx1[i] = -slope_[i];
-				cilk_spawn obase_adaptive(t0, t1, l_grid, f);
+				pochoir_spawn(obase_adaptive(t0, t1, l_grid, f));
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync;
 				if (grid.dx0[i] != slope_[i]) {
 					l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
 					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-					cilk_spawn obase_adaptive(t0, t1, l_grid, f);
+					pochoir_spawn(obase_adaptive(t0, t1, l_grid, f));
 				}
 				for (int j = 1; j < r; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
 					l_grid.dx0[i] = -slope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * j;
 					l_grid.dx1[i] = slope_[i];
-					cilk_spawn obase_adaptive(t0, t1, l_grid, f);
+					pochoir_spawn(obase_adaptive(t0, t1, l_grid, f));
 				}
 				if (grid.dx1[i] != -slope_[i]) {
 					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
 					l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-					cilk_spawn obase_adaptive(t0, t1, l_grid, f);
+					pochoir_spawn(obase_adaptive(t0, t1, l_grid, f));
 				}
 #if 0
 				printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -2762,6 +2809,7 @@ inline void Algorithm<N_RANK>::obase_adaptive(int t0, int t1, grid_info<N_RANK>
 template <int N_RANK> template <typename BF>
 inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, BF const & bf)
 {
+    pochoir_frame;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2791,7 +2839,7 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 			l_son_grid.dx0[i] = slope_[i];
 			l_son_grid.x1[i] = l_start + sep;
 			l_son_grid.dx1[i] = -slope_[i];
-            cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, bf);
+            pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, bf));
 
 			l_son_grid.x0[i] = l_start + sep * j;
 			l_son_grid.dx0[i] = slope_[i];
@@ -2801,33 +2849,33 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 #if DEBUG
 //			print_sync(stdout);
 #endif
-			cilk_sync;
+			pochoir_sync;
 			l_son_grid.x0[i] = l_start + sep;
 			l_son_grid.dx0[i] = -slope_[i];
 			l_son_grid.x1[i] = l_start + sep;
 			l_son_grid.dx1[i] = slope_[i];
-            cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, bf);
+            pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, bf));
 			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
         //        printf("merge triagles!\n");
 				l_son_grid.x0[i] = l_end;
 				l_son_grid.dx0[i] = -slope_[i];
 				l_son_grid.x1[i] = l_end;
 				l_son_grid.dx1[i] = slope_[i];
-                cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, bf);
+                pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, bf));
 			} else {
 				if (l_father_grid.dx0[i] != slope_[i]) {
 					l_son_grid.x0[i] = l_start; 
 					l_son_grid.dx0[i] = l_father_grid.dx0[i];
 					l_son_grid.x1[i] = l_start; 
 					l_son_grid.dx1[i] = slope_[i];
-                    cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, bf);
+                    pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, bf));
 				}
 				if (l_father_grid.dx1[i] != -slope_[i]) {
 					l_son_grid.x0[i] = l_end; 
 					l_son_grid.dx0[i] = -slope_[i];
 					l_son_grid.x1[i] = l_end; 
 					l_son_grid.dx1[i] = l_father_grid.dx1[i];
-                    cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, bf);
+                    pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, bf));
 				}
 			}
             return;
@@ -2858,6 +2906,7 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 template <int N_RANK> template <typename BF>
 inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, BF const & bf)
 {
+    pochoir_frame;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2897,7 +2946,7 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 					l_son_grid.dx0[i] = slope_[i];
 					l_son_grid.x1[i] = l_start + sep * (j+1);
 					l_son_grid.dx1[i] = -slope_[i];
-                    cilk_spawn obase_boundary_p(t0, t1, l_son_grid, bf);
+                    pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, bf));
 				}
 				l_son_grid.x0[i] = l_start + sep * j;
 				l_son_grid.dx0[i] = slope_[i];
@@ -2907,13 +2956,13 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync;
 				for (j = 1; j < r; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
 					l_son_grid.dx0[i] = -slope_[i];
 					l_son_grid.x1[i] = l_start + sep * j;
 					l_son_grid.dx1[i] = slope_[i];
-                    cilk_spawn obase_boundary_p(t0, t1, l_son_grid, bf);
+                    pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, bf));
 				}
 				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
             //        printf("merge triagles!\n");
@@ -2921,21 +2970,21 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 					l_son_grid.dx0[i] = -slope_[i];
 					l_son_grid.x1[i] = l_end;
 					l_son_grid.dx1[i] = slope_[i];
-                    cilk_spawn obase_boundary_p(t0, t1, l_son_grid, bf);
+                    pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, bf));
 				} else {
 					if (l_father_grid.dx0[i] != slope_[i]) {
 						l_son_grid.x0[i] = l_start; 
 						l_son_grid.dx0[i] = l_father_grid.dx0[i];
 						l_son_grid.x1[i] = l_start; 
 						l_son_grid.dx1[i] = slope_[i];
-                        cilk_spawn obase_boundary_p(t0, t1, l_son_grid, bf);
+                        pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, bf));
 					}
 					if (l_father_grid.dx1[i] != -slope_[i]) {
 						l_son_grid.x0[i] = l_end; 
 						l_son_grid.dx0[i] = -slope_[i];
 						l_son_grid.x1[i] = l_end; 
 						l_son_grid.dx1[i] = l_father_grid.dx1[i];
-                        cilk_spawn obase_boundary_p(t0, t1, l_son_grid, bf);
+                        pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, bf));
 					}
 				}
 				cut_yet = true;
@@ -2966,6 +3015,7 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    pochoir_frame;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2996,9 +3046,9 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 			l_son_grid.x1[i] = l_start + sep;
 			l_son_grid.dx1[i] = -slope_[i];
             if (call_boundary) {
-                cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf));
             } else {
-                cilk_spawn obase_bicut(t0, t1, l_son_grid, f);
+                pochoir_spawn(obase_bicut(t0, t1, l_son_grid, f));
             }
 
 			l_son_grid.x0[i] = l_start + sep;
@@ -3010,16 +3060,16 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
             } else {
                 obase_bicut(t0, t1, l_son_grid, f);
             }
-			cilk_sync;
+			pochoir_sync;
 
 			l_son_grid.x0[i] = l_start + sep;
 			l_son_grid.dx0[i] = -slope_[i];
 			l_son_grid.x1[i] = l_start + sep;
 			l_son_grid.dx1[i] = slope_[i];
             if (call_boundary) {
-                cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf));
             } else {
-                cilk_spawn obase_bicut(t0, t1, l_son_grid, f);
+                pochoir_spawn(obase_bicut(t0, t1, l_son_grid, f));
             }
 
 			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
@@ -3029,9 +3079,9 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 				l_son_grid.x1[i] = l_end;
 				l_son_grid.dx1[i] = slope_[i];
                 if (call_boundary) {
-                    cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                    pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf));
                 } else {
-                    cilk_spawn obase_bicut(t0, t1, l_son_grid, f);
+                    pochoir_spawn(obase_bicut(t0, t1, l_son_grid, f));
                 }
 			} else {
 				if (l_father_grid.dx0[i] != slope_[i]) {
@@ -3040,9 +3090,9 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 					l_son_grid.x1[i] = l_start; 
 					l_son_grid.dx1[i] = slope_[i];
                     if (call_boundary) {
-                        cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf));
                     } else {
-                        cilk_spawn obase_bicut(t0, t1, l_son_grid, f);
+                        pochoir_spawn(obase_bicut(t0, t1, l_son_grid, f));
                     }
 				}
 				if (l_father_grid.dx1[i] != -slope_[i]) {
@@ -3051,9 +3101,9 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 					l_son_grid.x1[i] = l_end; 
 					l_son_grid.dx1[i] = l_father_grid.dx1[i];
                     if (call_boundary) {
-                        cilk_spawn obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf));
                     } else {
-                        cilk_spawn obase_bicut(t0, t1, l_son_grid, f);
+                        pochoir_spawn(obase_bicut(t0, t1, l_son_grid, f));
                     }
 				}
 			}
@@ -3110,6 +3160,7 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    pochoir_frame;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -3166,9 +3217,9 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 					l_son_grid.x1[i] = l_start + sep * (j+1);
 					l_son_grid.dx1[i] = -slope_[i];
                     if (call_boundary) {
-                        cilk_spawn obase_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, f, bf));
                     } else {
-                        cilk_spawn obase_adaptive(t0, t1, l_son_grid, f);
+                        pochoir_spawn(obase_adaptive(t0, t1, l_son_grid, f));
                     }
 				}
 				l_son_grid.x0[i] = l_start + sep * j;
@@ -3183,16 +3234,16 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync;
 				for (j = 1; j < r; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
 					l_son_grid.dx0[i] = -slope_[i];
 					l_son_grid.x1[i] = l_start + sep * j;
 					l_son_grid.dx1[i] = slope_[i];
                     if (call_boundary) {
-                        cilk_spawn obase_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, f, bf));
                     } else {
-                        cilk_spawn obase_adaptive(t0, t1, l_son_grid, f);
+                        pochoir_spawn(obase_adaptive(t0, t1, l_son_grid, f));
                     }
 				}
 				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
@@ -3202,9 +3253,9 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 					l_son_grid.x1[i] = l_end;
 					l_son_grid.dx1[i] = slope_[i];
                     if (call_boundary) {
-                        cilk_spawn obase_boundary_p(t0, t1, l_son_grid, f, bf);
+                        pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, f, bf));
                     } else {
-                        cilk_spawn obase_adaptive(t0, t1, l_son_grid, f);
+                        pochoir_spawn(obase_adaptive(t0, t1, l_son_grid, f));
                     }
 				} else {
 					if (l_father_grid.dx0[i] != slope_[i]) {
@@ -3213,9 +3264,9 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 						l_son_grid.x1[i] = l_start; 
 						l_son_grid.dx1[i] = slope_[i];
                         if (call_boundary) {
-                            cilk_spawn obase_boundary_p(t0, t1, l_son_grid, f, bf);
+                            pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, f, bf));
                         } else {
-                            cilk_spawn obase_adaptive(t0, t1, l_son_grid, f);
+                            pochoir_spawn(obase_adaptive(t0, t1, l_son_grid, f));
                         }
 					}
 					if (l_father_grid.dx1[i] != -slope_[i]) {
@@ -3224,9 +3275,9 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 						l_son_grid.x1[i] = l_end; 
 						l_son_grid.dx1[i] = l_father_grid.dx1[i];
                         if (call_boundary) {
-                            cilk_spawn obase_boundary_p(t0, t1, l_son_grid, f, bf);
+                            pochoir_spawn(obase_boundary_p(t0, t1, l_son_grid, f, bf));
                         } else {
-                            cilk_spawn obase_adaptive(t0, t1, l_son_grid, f);
+                            pochoir_spawn(obase_adaptive(t0, t1, l_son_grid, f));
                         }
 					}
 				}
@@ -3263,4 +3314,719 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 }
 
 
+/* run the node n of a pipeline, then spawn the nodes that this one was
+ * the last predecessor of
+ */
+template <int N_RANK> template <typename G>
+inline void Algorithm<N_RANK>::pipe_dag_node(pipe_dag * dag, int n, G const & g)
+{
+    pochoir_frame;
+    const int K = dag->n_strips, d = dag->dim;
+    const int s = n / (2 * K), kind = (n / K) % 2, j = n % K;
+    const int l_t0 = dag->t0 + s * dag->dt;
+    const int l_t1 = min(l_t0 + dag->dt, dag->t1);
+    const int l_base = l_t0 - dag->t0;
+    grid_info<N_RANK> l_son_grid;
+
+    for (int i = 0; i < N_RANK; ++i) {
+        l_son_grid.x0[i] = dag->grid.x0[i] + dag->grid.dx0[i] * l_base;
+        l_son_grid.dx0[i] = dag->grid.dx0[i];
+        l_son_grid.x1[i] = dag->grid.x1[i] + dag->grid.dx1[i] * l_base;
+        l_son_grid.dx1[i] = dag->grid.dx1[i];
+    }
+    if (kind == 0) {
+        /* upright trapezoid of strip j, the outer edges of the grid 
+         * stay upright unless the strips close into a ring
+         */
+        l_son_grid.x0[d] = dag->bound[j];
+        l_son_grid.dx0[d] = (!dag->ring && j == 0) ? 0 : slope_[d];
+        l_son_grid.x1[d] = dag->bound[j+1];
+        l_son_grid.dx1[d] = (!dag->ring && j == K-1) ? 0 : -slope_[d];
+    } else {
+        /* inverted triangle between strip j and strip j+1 */
+        l_son_grid.x0[d] = dag->bound[j+1];
+        l_son_grid.dx0[d] = -slope_[d];
+        l_son_grid.x1[d] = dag->bound[j+1];
+        l_son_grid.dx1[d] = slope_[d];
+    }
+    g(l_t0, l_t1, l_son_grid);
+
+    /* a trapezoid feeds the triangles on its both sides in the same slab,
+     * a triangle feeds the trapezoids on its both sides in the next slab
+     */
+    int l_succ[2], l_num_succ = 0;
+    if (kind == 0) {
+        if (j > 0 || dag->ring)
+            l_succ[l_num_succ++] = (s * 2 + 1) * K + ((j == 0) ? K-1 : j-1);
+        if (j < K-1 || dag->ring)
+            l_succ[l_num_succ++] = (s * 2 + 1) * K + j;
+    } else if (s + 1 < dag->n_slabs) {
+        l_succ[l_num_succ++] = (s + 1) * 2 * K + j;
+        l_succ[l_num_succ++] = (s + 1) * 2 * K + ((j == K-1) ? 0 : j+1);
+    }
+    for (int k = 0; k < l_num_succ; ++k) {
+        if (--dag->pred[l_succ[k]] == 0)
+            pochoir_spawn_on(((l_succ[k] % K) * dag->n_groups) / K, pipe_dag_node(dag, l_succ[k], g));
+    }
+}
+
+/* Pipelined time slabs : the time steps [t0, t1) are cut into slabs of dt
+ * steps and the widest dimension of the grid into strips at least 
+ * 2 * slope * dt wide. An upright trapezoid of a strip only reads the 
+ * triangles on both sides of the strip in the slab below, so it starts
+ * as soon as those two are done, instead of after a sync on the whole 
+ * slab. g(t0, t1, grid) walks one zoid with the usual cutting. 'wrap' 
+ * closes the strips into a ring when the grid covers the whole physical
+ * grid, as for the boundary walkers. dt = 0 picks the slab height from
+ * the number of workers, and a slab is never lower than 'depth' steps, 
+ * the depth of the stencil in time.
+ * With groups > 1, the strips are cut along the outermost dimension, and
+ * the g-th of 'groups' contiguous runs of strips goes to the g-th group
+ * of workers, the one which first touched those pages of the arrays.
+ */
+template <int N_RANK> template <typename G>
+inline void Algorithm<N_RANK>::pipeline_time(int t0, int t1, grid_info<N_RANK> const & grid, bool wrap, int dt, int depth, int groups, G const & g)
+{
+    pochoir_frame;
+    const int lt = t1 - t0;
+    int d = 0;
+
+    for (int i = 1; i < N_RANK; ++i) {
+        if (grid.x1[i] - grid.x0[i] > grid.x1[d] - grid.x0[d])
+            d = i;
+    }
+    if (groups > 1)
+        d = N_RANK-1;
+    const int l_width = grid.x1[d] - grid.x0[d];
+    const int l_slope = slope_[d];
+    if (N_CORES <= 1 || lt <= 0 || l_slope == 0 
+        || grid.dx0[d] != 0 || grid.dx1[d] != 0) {
+        g(t0, t1, grid);
+        return;
+    }
+    /* by default about two strips per worker */
+    int l_dt = (dt > 0) ? dt : l_width / (2 * l_slope * 2 * N_CORES);
+    l_dt = min(max(l_dt, max(depth, 1)), lt);
+    int l_strips = l_width / (2 * l_slope * l_dt);
+    /* the same number of strips per group */
+    if (groups > 1 && l_strips >= groups)
+        l_strips -= l_strips % groups;
+    if (l_strips < 2) {
+        g(t0, t1, grid);
+        return;
+    }
+
+    pipe_dag l_dag;
+    const int l_slabs = (lt + l_dt - 1) / l_dt;
+    const int l_nodes = l_slabs * 2 * l_strips;
+    int * l_bound = new int[l_strips+1];
+    std::atomic<int> * l_pred = new std::atomic<int>[l_nodes];
+
+    l_dag.t0 = t0; l_dag.t1 = t1; l_dag.dt = l_dt; l_dag.dim = d;
+    l_dag.n_slabs = l_slabs; l_dag.n_strips = l_strips;
+    l_dag.n_groups = (groups > 1) ? groups : 1;
+    l_dag.ring = wrap && grid.x0[d] == phys_grid_.x0[d] && grid.x1[d] == phys_grid_.x1[d];
+    l_dag.grid = grid;
+    for (int j = 0; j <= l_strips; ++j)
+        l_bound[j] = grid.x0[d] + (int)(((long long)j * l_width) / l_strips);
+    l_dag.bound = l_bound;
+    l_dag.pred = l_pred;
+
+    /* count the predecessors of every node, a missing triangle gets -1 */
+    for (int s = 0; s < l_slabs; ++s) {
+        for (int j = 0; j < l_strips; ++j) {
+            int l_num = 0;
+            if (s > 0) 
+                l_num = (l_dag.ring) ? 2 : (j > 0) + (j < l_strips-1);
+            l_pred[(s * 2) * l_strips + j] = l_num;
+            l_pred[(s * 2 + 1) * l_strips + j] = (l_dag.ring || j < l_strips-1) ? 2 : -1;
+        }
+    }
+
+    /* the trapezoids of the first slab start, the rest follows */
+    pipe_dag * const l_dag_ptr = &l_dag;
+    for (int j = 0; j < l_strips; ++j)
+        pochoir_spawn_on((j * l_dag.n_groups) / l_strips, pipe_dag_node(l_dag_ptr, j, g));
+    pochoir_sync;
+    delete [] l_bound;
+    delete [] l_pred;
+}
+
+/* Out-of-core sweep : the time steps [t0, t1) are cut into slabs of dt
+ * steps and the outermost dimension, along which the rows of the arrays
+ * are contiguous, into strips, so that about three strips of 'rows' rows
+ * cover the memory budget. Within a slab the strips are visited in order,
+ * the upright trapezoid of strip j, then the inverted triangle between 
+ * strip j-1 and strip j, and the triangle closing the ring last. Only 
+ * two strips are being computed at any time, while the next one is 
+ * paged in : h(r0, r1, true) asks for the rows [r0, r1) ahead of time, 
+ * h(r0, r1, false) hands them back once they are done for the slab. 
+ * Each zoid is walked by g(t0, t1, grid) with the usual (parallel) 
+ * cutting, over dt steps at a time while its pages are resident. 
+ * 'wrap' and 'depth' are as for pipeline_time().
+ */
+template <int N_RANK> template <typename G, typename H>
+inline void Algorithm<N_RANK>::stream_time(int t0, int t1, grid_info<N_RANK> const & grid, bool wrap, int rows, int depth, G const & g, H const & h)
+{
+    const int d = N_RANK-1;
+    const int lt = t1 - t0;
+    const int l_width = grid.x1[d] - grid.x0[d];
+    const int l_slope = slope_[d];
+
+    if (lt <= 0 || grid.dx0[d] != 0 || grid.dx1[d] != 0) {
+        g(t0, t1, grid);
+        return;
+    }
+    /* the trapezoid of a strip must not close up within the slab */
+    int l_strip = max(rows / 3, 1);
+    int l_dt = (l_slope > 0) ? l_strip / (2 * l_slope) : lt;
+    l_dt = min(max(l_dt, max(depth, 1)), lt);
+    l_strip = max(l_strip, 2 * l_slope * l_dt);
+    const int l_strips = l_width / l_strip;
+    if (l_strips < 2) {
+        g(t0, t1, grid);
+        return;
+    }
+
+    const bool l_ring = wrap && grid.x0[d] == phys_grid_.x0[d] && grid.x1[d] == phys_grid_.x1[d];
+    std::vector<int> l_bound(l_strips+1);
+    for (int j = 0; j <= l_strips; ++j)
+        l_bound[j] = grid.x0[d] + (int)(((long long)j * l_width) / l_strips);
+
+    for (int l_t0 = t0; l_t0 < t1; l_t0 += l_dt) {
+        const int l_t1 = min(l_t0 + l_dt, t1);
+        const int l_base = l_t0 - t0;
+        grid_info<N_RANK> l_slab_grid;
+        for (int i = 0; i < N_RANK; ++i) {
+            l_slab_grid.x0[i] = grid.x0[i] + grid.dx0[i] * l_base;
+            l_slab_grid.dx0[i] = grid.dx0[i];
+            l_slab_grid.x1[i] = grid.x1[i] + grid.dx1[i] * l_base;
+            l_slab_grid.dx1[i] = grid.dx1[i];
+        }
+        h(l_bound[0], l_bound[1], true);
+        for (int j = 0; j < l_strips; ++j) {
+            if (j + 1 < l_strips)
+                h(l_bound[j+1], l_bound[j+2], true);
+            /* upright trapezoid of strip j, the outer edges of the grid
+             * stay upright unless the strips close into a ring
+             */
+            grid_info<N_RANK> l_son_grid = l_slab_grid;
+            l_son_grid.x0[d] = l_bound[j];
+            l_son_grid.dx0[d] = (!l_ring && j == 0) ? 0 : l_slope;
+            l_son_grid.x1[d] = l_bound[j+1];
+            l_son_grid.dx1[d] = (!l_ring && j == l_strips-1) ? 0 : -l_slope;
+            g(l_t0, l_t1, l_son_grid);
+            if (j == 0)
+                continue;
+            /* inverted triangle between strip j-1 and strip j */
+            if (l_slope > 0) {
+                l_son_grid.x0[d] = l_son_grid.x1[d] = l_bound[j];
+                l_son_grid.dx0[d] = -l_slope;
+                l_son_grid.dx1[d] = l_slope;
+                g(l_t0, l_t1, l_son_grid);
+            }
+            h(l_bound[j-1], l_bound[j], false);
+        }
+        if (l_ring && l_slope > 0) {
+            grid_info<N_RANK> l_son_grid = l_slab_grid;
+            h(l_bound[0], l_bound[1], true);
+            l_son_grid.x0[d] = l_son_grid.x1[d] = l_bound[l_strips];
+            l_son_grid.dx0[d] = -l_slope;
+            l_son_grid.dx1[d] = l_slope;
+            g(l_t0, l_t1, l_son_grid);
+            h(l_bound[0], l_bound[1], false);
+        }
+        h(l_bound[l_strips-1], l_bound[l_strips], false);
+    }
+}
+
+template <int N_RANK>
+inline int Algorithm<N_RANK>::plan_add(plan_kind kind, int num, int const child[])
+{
+    plan_node l_node;
+    l_node.kind = kind;
+    l_node.t0 = l_node.t1 = 0;
+    l_node.mask = 0;
+    l_node.first = plan_child_.size();
+    l_node.num = num;
+    for (int k = 0; k < num; ++k)
+        plan_child_.push_back(child[k]);
+    plan_.push_back(l_node);
+    return plan_.size() - 1;
+}
+
+/* the same cuts as walk_bicut_boundary_m() with boundary set, and as 
+ * walk_bicut() without, but only recorded
+ */
+template <int N_RANK>
+inline int Algorithm<N_RANK>::plan_walk(int t0, int t1, grid_info<N_RANK> const grid, int mask, bool boundary)
+{
+    const int lt = t1 - t0;
+    grid_info<N_RANK> l_father_grid = grid, l_son_grid;
+    bool l_touch_boundary[N_RANK];
+    int l_mask = 0;
+    int l_child[2], l_level[4];
+
+    for (int i = 0; i < N_RANK; ++i) {
+        l_touch_boundary[i] = boundary && (mask & (1 << i)) && touch_boundary(i, lt, l_father_grid);
+        l_mask |= (l_touch_boundary[i] << i);
+    }
+    const bool call_boundary = (l_mask != 0);
+
+    for (int i = N_RANK-1; i >= 0; --i) {
+        const int lb = l_father_grid.x1[i] - l_father_grid.x0[i];
+        const int thres = 2 * (2 * slope_[i] * lt);
+        const bool can_cut = (l_touch_boundary[i]) ? (lb >= thres && lb > dx_recursive_boundary_[i]) : (lb >= thres && lb > dx_recursive_[i]);
+        if (can_cut) {
+            const int sep = lb/2;
+            const int l_start = l_father_grid.x0[i];
+            const int l_end = l_father_grid.x1[i];
+            int l_num = 0;
+
+            l_son_grid = l_father_grid;
+            l_son_grid.x0[i] = l_start; l_son_grid.dx0[i] = slope_[i];
+            l_son_grid.x1[i] = l_start + sep; l_son_grid.dx1[i] = -slope_[i];
+            l_level[l_num++] = plan_walk(t0, t1, l_son_grid, l_mask, call_boundary);
+            l_son_grid.x0[i] = l_start + sep; l_son_grid.dx0[i] = slope_[i];
+            l_son_grid.x1[i] = l_end; l_son_grid.dx1[i] = -slope_[i];
+            l_level[l_num++] = plan_walk(t0, t1, l_son_grid, l_mask, call_boundary);
+            l_child[0] = plan_add(PLAN_PARALLEL, l_num, l_level);
+
+            l_num = 0;
+            l_son_grid.x0[i] = l_start + sep; l_son_grid.dx0[i] = -slope_[i];
+            l_son_grid.x1[i] = l_start + sep; l_son_grid.dx1[i] = slope_[i];
+            l_level[l_num++] = plan_walk(t0, t1, l_son_grid, l_mask, call_boundary);
+            if (boundary && l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
+                /* merge triangles */
+                l_son_grid.x0[i] = l_end; l_son_grid.dx0[i] = -slope_[i];
+                l_son_grid.x1[i] = l_end; l_son_grid.dx1[i] = slope_[i];
+                l_level[l_num++] = plan_walk(t0, t1, l_son_grid, l_mask, call_boundary);
+            } else {
+                if (l_father_grid.dx0[i] != slope_[i]) {
+                    l_son_grid.x0[i] = l_start; l_son_grid.dx0[i] = l_father_grid.dx0[i];
+                    l_son_grid.x1[i] = l_start; l_son_grid.dx1[i] = slope_[i];
+                    l_level[l_num++] = plan_walk(t0, t1, l_son_grid, l_mask, call_boundary);
+                }
+                if (l_father_grid.dx1[i] != -slope_[i]) {
+                    l_son_grid.x0[i] = l_end; l_son_grid.dx0[i] = -slope_[i];
+                    l_son_grid.x1[i] = l_end; l_son_grid.dx1[i] = l_father_grid.dx1[i];
+                    l_level[l_num++] = plan_walk(t0, t1, l_son_grid, l_mask, call_boundary);
+                }
+            }
+            l_child[1] = plan_add(PLAN_PARALLEL, l_num, l_level);
+            return plan_add(PLAN_SERIES, 2, l_child);
+        }
+    }
+
+    const int l_dt_stop = (call_boundary) ? dt_recursive_boundary_ : dt_recursive_;
+    if (lt > l_dt_stop) {
+        const int halflt = lt / 2;
+        l_child[0] = plan_walk(t0, t0+halflt, l_father_grid, l_mask, call_boundary);
+        for (int i = 0; i < N_RANK; ++i) {
+            l_son_grid.x0[i] = l_father_grid.x0[i] + l_father_grid.dx0[i] * halflt;
+            l_son_grid.dx0[i] = l_father_grid.dx0[i];
+            l_son_grid.x1[i] = l_father_grid.x1[i] + l_father_grid.dx1[i] * halflt;
+            l_son_grid.dx1[i] = l_father_grid.dx1[i];
+        }
+        l_child[1] = plan_walk(t0+halflt, t1, l_son_grid, l_mask, call_boundary);
+        return plan_add(PLAN_SERIES, 2, l_child);
+    }
+
+    /* base case */
+    const int l_leaf = plan_add(PLAN_LEAF, 0, l_child);
+    plan_[l_leaf].t0 = t0; plan_[l_leaf].t1 = t1;
+    plan_[l_leaf].grid = l_father_grid;
+    plan_[l_leaf].mask = l_mask;
+    return l_leaf;
+}
+
+/* the same cuts as shorter_duo_sim_obase_bicut_p() with boundary set, 
+ * and as shorter_duo_sim_obase_bicut() without, but only recorded. A 
+ * hyperspace cut becomes a series of its dependency levels, each level
+ * a parallel node of its sub-zoids
+ */
+template <int N_RANK>
+inline int Algorithm<N_RANK>::plan_hyper(int t0, int t1, grid_info<N_RANK> const grid, bool boundary)
+{
+    const int lt = t1 - t0;
+    grid_info<N_RANK> l_father_grid = grid, l_son_grid;
+    bool sim_can_cut = false;
+    int l_mask = 0;
+    int l_child[N_RANK+1];
+
+    for (int i = N_RANK-1; i >= 0; --i) {
+        const bool l_touch_boundary = boundary && touch_boundary(i, lt, l_father_grid);
+        const int lb = (grid.x1[i] - grid.x0[i]);
+        const int tb = (grid.x1[i] + grid.dx1[i] * lt - grid.x0[i] - grid.dx0[i] * lt);
+        const int thres = (slope_[i] * lt);
+        const bool cut_lb = (lb < tb);
+        if (l_touch_boundary)
+            sim_can_cut = sim_can_cut || (cut_lb ? (lb >= 2 * thres && lb > dx_recursive_boundary_[i]) : (tb >= 2 * thres && lb > dx_recursive_boundary_[i]));
+        else if (boundary)
+            sim_can_cut = sim_can_cut || (cut_lb ? (lb >= 2 * thres && lb > dx_recursive_[i]) : (tb > 2 * thres && lb > dx_recursive_[i]));
+        else
+            sim_can_cut = sim_can_cut || (cut_lb ? (lb >= 2 * thres && lb > dx_recursive_[i]) : (tb >= 2 * thres && lb > dx_recursive_[i]));
+        l_mask |= (l_touch_boundary << i);
+    }
+    const bool call_boundary = (l_mask != 0);
+
+    if (sim_can_cut) {
+        std::vector<int> l_dep[N_RANK+1];
+        int l_num = 0;
+        plan_space_cut(N_RANK-1, 0, t0, t1, l_father_grid, call_boundary, l_dep);
+        for (int d = 0; d < N_RANK+1; ++d) {
+            if (!l_dep[d].empty())
+                l_child[l_num++] = plan_add(PLAN_PARALLEL, l_dep[d].size(), l_dep[d].data());
+        }
+        return plan_add(PLAN_SERIES, l_num, l_child);
+    }
+
+    const int l_dt_stop = (call_boundary) ? dt_recursive_boundary_ : dt_recursive_;
+    if (lt > l_dt_stop) {
+        const int halflt = lt / 2;
+        l_child[0] = plan_hyper(t0, t0+halflt, l_father_grid, call_boundary);
+        for (int i = 0; i < N_RANK; ++i) {
+            l_son_grid.x0[i] = l_father_grid.x0[i] + l_father_grid.dx0[i] * halflt;
+            l_son_grid.dx0[i] = l_father_grid.dx0[i];
+            l_son_grid.x1[i] = l_father_grid.x1[i] + l_father_grid.dx1[i] * halflt;
+            l_son_grid.dx1[i] = l_father_grid.dx1[i];
+        }
+        l_child[1] = plan_hyper(t0+halflt, t1, l_son_grid, call_boundary);
+        return plan_add(PLAN_SERIES, 2, l_child);
+    }
+
+    /* base case */
+    const int l_leaf = plan_add(PLAN_LEAF, 0, l_child);
+    plan_[l_leaf].t0 = t0; plan_[l_leaf].t1 = t1;
+    plan_[l_leaf].grid = l_father_grid;
+    plan_[l_leaf].mask = l_mask;
+    return l_leaf;
+}
+
+/* cut dimensions 'level' down to 0 of a hyperspace cut as the circular
+ * queue of shorter_duo_sim_obase_space_cut_p() does, a sub-zoid which 
+ * waits for its neighbors in d of the dimensions ends up in dep[d]
+ */
+template <int N_RANK>
+inline void Algorithm<N_RANK>::plan_space_cut(int level, int d, int t0, int t1, grid_info<N_RANK> const grid, bool boundary, std::vector<int> dep[])
+{
+    if (level < 0) {
+        dep[d].push_back(plan_hyper(t0, t1, grid, boundary));
+        return;
+    }
+    grid_info<N_RANK> l_father_grid = grid;
+    const int lt = (t1 - t0);
+    const int thres = slope_[level] * lt;
+    const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
+    const int tb = (l_father_grid.x1[level] + l_father_grid.dx1[level] * lt - l_father_grid.x0[level] - l_father_grid.dx0[level] * lt);
+    const bool cut_lb = (lb < tb);
+    const bool l_touch_boundary = boundary && touch_boundary(level, lt, l_father_grid);
+    const bool can_cut = cut_lb ? (l_touch_boundary ? (lb >= 2 * thres && lb > dx_recursive_boundary_[level]) : (lb >= 2 * thres && lb > dx_recursive_[level])) : (l_touch_boundary ? (tb >= 2 * thres && lb > dx_recursive_boundary_[level]) : (tb >= 2 * thres && lb > dx_recursive_[level]));
+
+    if (!can_cut) {
+        plan_space_cut(level-1, d, t0, t1, l_father_grid, boundary, dep);
+        return;
+    }
+    grid_info<N_RANK> l_son_grid = l_father_grid;
+    const int l_start = (l_father_grid.x0[level]);
+    const int l_end = (l_father_grid.x1[level]);
+    if (cut_lb) {
+        const int mid = lb/2;
+        /* the middle gray minizoid, then the big black trapezoids */
+        l_son_grid.x0[level] = l_start + mid - thres; l_son_grid.dx0[level] = slope_[level];
+        l_son_grid.x1[level] = l_start + mid + thres; l_son_grid.dx1[level] = -slope_[level];
+        plan_space_cut(level-1, d, t0, t1, l_son_grid, boundary, dep);
+        l_son_grid.x0[level] = l_start; l_son_grid.dx0[level] = l_father_grid.dx0[level];
+        l_son_grid.x1[level] = l_start + mid - thres; l_son_grid.dx1[level] = slope_[level];
+        plan_space_cut(level-1, d+1, t0, t1, l_son_grid, boundary, dep);
+        l_son_grid.x0[level] = l_start + mid + thres; l_son_grid.dx0[level] = -slope_[level];
+        l_son_grid.x1[level] = l_end; l_son_grid.dx1[level] = l_father_grid.dx1[level];
+        plan_space_cut(level-1, d+1, t0, t1, l_son_grid, boundary, dep);
+        return;
+    }
+    const int mid = tb/2;
+    const int ul_start = (l_father_grid.x0[level] + l_father_grid.dx0[level] * lt);
+    if (boundary && lb == phys_length_[level] && l_father_grid.dx0[level] == 0 && l_father_grid.dx1[level] == 0) {
+        /* initial cut : the big black trapezoids merged */
+        l_son_grid.x0[level] = ul_start + mid; l_son_grid.dx0[level] = slope_[level];
+        l_son_grid.x1[level] = l_end + (ul_start - l_start) + mid; l_son_grid.dx1[level] = -slope_[level];
+        plan_space_cut(level-1, d, t0, t1, l_son_grid, boundary, dep);
+    } else {
+        l_son_grid.x0[level] = l_start; l_son_grid.dx0[level] = l_father_grid.dx0[level];
+        l_son_grid.x1[level] = ul_start + mid; l_son_grid.dx1[level] = -slope_[level];
+        plan_space_cut(level-1, d, t0, t1, l_son_grid, boundary, dep);
+        l_son_grid.x0[level] = ul_start + mid; l_son_grid.dx0[level] = slope_[level];
+        l_son_grid.x1[level] = l_end; l_son_grid.dx1[level] = l_father_grid.dx1[level];
+        plan_space_cut(level-1, d, t0, t1, l_son_grid, boundary, dep);
+    }
+    /* the middle gray minizoid */
+    l_son_grid.x0[level] = ul_start + mid; l_son_grid.dx0[level] = -slope_[level];
+    l_son_grid.x1[level] = ul_start + mid; l_son_grid.dx1[level] = slope_[level];
+    plan_space_cut(level-1, d+1, t0, t1, l_son_grid, boundary, dep);
+}
+
+/* The cut tree of a walk only depends on the grid, the slopes, the 
+ * thresholds and [t0, t1), so a Pochoir_Plan records it once and the 
+ * later runs only replay its leaves.
+ */
+template <int N_RANK>
+inline void Algorithm<N_RANK>::make_plan(int t0, int t1, grid_info<N_RANK> const & grid, bool boundary, bool obase, bool flat)
+{
+    plan_.clear();
+    plan_child_.clear();
+    flat_.clear();
+    flat_succ_.clear();
+    plan_t0_ = t0; plan_t1_ = t1;
+    plan_grid_ = grid;
+    if (obase)
+        plan_root_ = plan_hyper(t0, t1, grid, boundary);
+    else
+        plan_root_ = plan_walk(t0, t1, grid, (1 << N_RANK) - 1, boundary);
+    if (flat)
+        flatten_plan();
+}
+
+template <int N_RANK> template <typename L>
+inline void Algorithm<N_RANK>::replay_plan(int n, L const & leaf)
+{
+    pochoir_frame;
+    plan_node const & l_node = plan_[n];
+    int const * l_child = plan_child_.data() + l_node.first;
+
+    if (l_node.kind == PLAN_LEAF) {
+        leaf(l_node.t0, l_node.t1, l_node.grid, l_node.mask);
+    } else if (l_node.kind == PLAN_SERIES) {
+        for (int k = 0; k < l_node.num; ++k)
+            replay_plan(l_child[k], leaf);
+    } else {
+        for (int k = 0; k < l_node.num - 1; ++k)
+            pochoir_spawn(replay_plan(l_child[k], leaf));
+        replay_plan(l_child[l_node.num - 1], leaf);
+        pochoir_sync;
+    }
+}
+
+template <int N_RANK>
+inline int Algorithm<N_RANK>::flat_add(int t0, int t1, grid_info<N_RANK> const & grid, int mask)
+{
+    flat_node l_node;
+    l_node.t0 = t0; l_node.t1 = t1;
+    l_node.grid = grid;
+    l_node.mask = mask;
+    l_node.first = l_node.num = l_node.num_pred = 0;
+    flat_.push_back(l_node);
+    return flat_.size() - 1;
+}
+
+/* flatten the sub-tree n, all of whose first zoids depend on descriptor
+ * 'pred' (-1 for none), the edges are appended to edge[] in pairs, and 
+ * the descriptor which ends the sub-tree is returned
+ */
+template <int N_RANK>
+inline int Algorithm<N_RANK>::flatten(int n, int pred, std::vector<int> & edge)
+{
+    plan_node const l_node = plan_[n];
+    int const * l_child = plan_child_.data() + l_node.first;
+
+    if (l_node.kind == PLAN_LEAF) {
+        const int l_k = flat_add(l_node.t0, l_node.t1, l_node.grid, l_node.mask);
+        if (pred >= 0) {
+            edge.push_back(pred); edge.push_back(l_k);
+        }
+        return l_k;
+    }
+    if (l_node.kind == PLAN_SERIES || l_node.num == 1) {
+        int l_last = pred;
+        for (int k = 0; k < l_node.num; ++k)
+            l_last = flatten(l_child[k], l_last, edge);
+        return l_last;
+    }
+    std::vector<int> l_end(l_node.num);
+    for (int k = 0; k < l_node.num; ++k)
+        l_end[k] = flatten(l_child[k], pred, edge);
+    const int l_join = flat_add(0, 0, l_node.grid, -1);
+    for (int k = 0; k < l_node.num; ++k) {
+        edge.push_back(l_end[k]); edge.push_back(l_join);
+    }
+    return l_join;
+}
+
+/* lay out the successor lists and predecessor counts from the edges */
+template <int N_RANK>
+inline void Algorithm<N_RANK>::flat_link(std::vector<int> const & edge)
+{
+    const int l_n = flat_.size();
+    const int l_e = edge.size() / 2;
+
+    for (int k = 0; k < l_n; ++k)
+        flat_[k].num = flat_[k].num_pred = 0;
+    for (int e = 0; e < l_e; ++e) {
+        ++flat_[edge[2*e]].num;
+        ++flat_[edge[2*e+1]].num_pred;
+    }
+    for (int k = 0, l_first = 0; k < l_n; ++k) {
+        flat_[k].first = l_first;
+        l_first += flat_[k].num;
+        flat_[k].num = 0;
+    }
+    flat_succ_.resize(l_e);
+    for (int e = 0; e < l_e; ++e) {
+        flat_node & l_from = flat_[edge[2*e]];
+        flat_succ_[l_from.first + l_from.num++] = edge[2*e+1];
+    }
+    delete [] flat_pred_;
+    flat_pred_ = new std::atomic<int>[l_n > 0 ? l_n : 1];
+}
+
+template <int N_RANK>
+inline void Algorithm<N_RANK>::flatten_plan(void)
+{
+    std::vector<int> l_edge;
+
+    if (plan_root_ < 0)
+        return;
+    flat_.clear();
+    flatten(plan_root_, -1, l_edge);
+    flat_link(l_edge);
+    /* the tree is not needed any more */
+    plan_.clear();
+    plan_child_.clear();
+    plan_root_ = -1;
+}
+
+/* run descriptor k, then go on with one of the successors it released
+ * and spawn the others, so that a chain of zoids doesn't nest
+ */
+template <int N_RANK> template <typename L>
+inline void Algorithm<N_RANK>::flat_node_run(int k, L const & leaf)
+{
+    pochoir_frame;
+    while (k >= 0) {
+        flat_node const & l_node = flat_[k];
+        int const * l_succ = flat_succ_.data() + l_node.first;
+        int l_next = -1;
+
+        if (l_node.mask >= 0)
+            leaf(l_node.t0, l_node.t1, l_node.grid, l_node.mask);
+        for (int s = 0; s < l_node.num; ++s) {
+            if (--flat_pred_[l_succ[s]] != 0)
+                continue;
+            if (l_next < 0)
+                l_next = l_succ[s];
+            else
+                pochoir_spawn(flat_node_run(l_succ[s], leaf));
+        }
+        k = l_next;
+    }
+}
+
+template <int N_RANK> template <typename L>
+inline void Algorithm<N_RANK>::replay_flat(L const & leaf)
+{
+    pochoir_frame;
+    const int l_n = flat_.size();
+
+    for (int k = 0; k < l_n; ++k)
+        flat_pred_[k] = flat_[k].num_pred;
+    for (int k = 0; k < l_n; ++k) {
+        if (flat_[k].num_pred == 0)
+            pochoir_spawn(flat_node_run(k, leaf));
+    }
+}
+
+/* The flat schedule as text : a header of what the cuts depend on
+ *      pochoir_plan <N_RANK> <# of descriptors> <# of edges>
+ *      t0 t1 {x0 dx0 x1 dx1}[N_RANK]           (the walked grid)
+ *      {x0 x1}[N_RANK]                         (phys_grid_)
+ *      {slope dx_recursive dx_recursive_boundary}[N_RANK]
+ *      dt_recursive dt_recursive_boundary
+ * then one line per descriptor
+ *      t0 t1 mask {x0 dx0 x1 dx1}[N_RANK] <# of successors> successors...
+ */
+template <int N_RANK>
+void Algorithm<N_RANK>::save_plan(FILE * fp) const
+{
+    fprintf(fp, "pochoir_plan %d %d %d\n", N_RANK, (int)flat_.size(), (int)flat_succ_.size());
+    fprintf(fp, "%d %d", plan_t0_, plan_t1_);
+    for (int i = 0; i < N_RANK; ++i)
+        fprintf(fp, " %d %d %d %d", plan_grid_.x0[i], plan_grid_.dx0[i], plan_grid_.x1[i], plan_grid_.dx1[i]);
+    fprintf(fp, "\n");
+    for (int i = 0; i < N_RANK; ++i)
+        fprintf(fp, "%s%d %d", (i > 0) ? " " : "", phys_grid_.x0[i], phys_grid_.x1[i]);
+    fprintf(fp, "\n");
+    for (int i = 0; i < N_RANK; ++i)
+        fprintf(fp, "%s%d %d %d", (i > 0) ? " " : "", slope_[i], dx_recursive_[i], dx_recursive_boundary_[i]);
+    fprintf(fp, "\n%d %d\n", dt_recursive_, dt_recursive_boundary_);
+    for (int k = 0; k < (int)flat_.size(); ++k) {
+        flat_node const & l_node = flat_[k];
+        fprintf(fp, "%d %d %d", l_node.t0, l_node.t1, l_node.mask);
+        for (int i = 0; i < N_RANK; ++i)
+            fprintf(fp, " %d %d %d %d", l_node.grid.x0[i], l_node.grid.dx0[i], l_node.grid.x1[i], l_node.grid.dx1[i]);
+        fprintf(fp, " %d", l_node.num);
+        for (int s = 0; s < l_node.num; ++s)
+            fprintf(fp, " %d", flat_succ_[l_node.first + s]);
+        fprintf(fp, "\n");
+    }
+}
+
+/* a saved schedule is only taken for the same grid, domain, slopes and
+ * thresholds, which its cuts were made for
+ */
+template <int N_RANK>
+bool Algorithm<N_RANK>::load_plan(FILE * fp, int t0, int t1, grid_info<N_RANK> const & grid)
+{
+    int l_rank, l_n, l_e, l_t0, l_t1, l_v[4];
+    std::vector<int> l_edge;
+
+    if (fscanf(fp, " pochoir_plan %d %d %d", &l_rank, &l_n, &l_e) != 3 || l_rank != N_RANK || l_n < 0 || l_e < 0)
+        return false;
+    if (fscanf(fp, "%d %d", &l_t0, &l_t1) != 2 || l_t0 != t0 || l_t1 != t1)
+        return false;
+    for (int i = 0; i < N_RANK; ++i) {
+        if (fscanf(fp, "%d %d %d %d", &l_v[0], &l_v[1], &l_v[2], &l_v[3]) != 4
+         || l_v[0] != grid.x0[i] || l_v[1] != grid.dx0[i] || l_v[2] != grid.x1[i] || l_v[3] != grid.dx1[i])
+            return false;
+    }
+    for (int i = 0; i < N_RANK; ++i) {
+        if (fscanf(fp, "%d %d", &l_v[0], &l_v[1]) != 2 
+         || l_v[0] != phys_grid_.x0[i] || l_v[1] != phys_grid_.x1[i])
+            return false;
+    }
+    for (int i = 0; i < N_RANK; ++i) {
+        if (fscanf(fp, "%d %d %d", &l_v[0], &l_v[1], &l_v[2]) != 3 
+         || l_v[0] != slope_[i] || l_v[1] != dx_recursive_[i] || l_v[2] != dx_recursive_boundary_[i])
+            return false;
+    }
+    if (fscanf(fp, "%d %d", &l_v[0], &l_v[1]) != 2 || l_v[0] != dt_recursive_ || l_v[1] != dt_recursive_boundary_)
+        return false;
+    plan_t0_ = t0; plan_t1_ = t1;
+    plan_grid_ = grid;
+    plan_.clear();
+    plan_child_.clear();
+    plan_root_ = -1;
+    flat_.clear();
+    for (int k = 0; k < l_n; ++k) {
+        grid_info<N_RANK> l_grid;
+        int l_t0, l_t1, l_mask, l_num, l_succ;
+        if (fscanf(fp, "%d %d %d", &l_t0, &l_t1, &l_mask) != 3)
+            return false;
+        for (int i = 0; i < N_RANK; ++i) {
+            if (fscanf(fp, "%d %d %d %d", &l_grid.x0[i], &l_grid.dx0[i], &l_grid.x1[i], &l_grid.dx1[i]) != 4)
+                return false;
+        }
+        flat_add(l_t0, l_t1, l_grid, l_mask);
+        if (fscanf(fp, "%d", &l_num) != 1)
+            return false;
+        for (int s = 0; s < l_num; ++s) {
+            if (fscanf(fp, "%d", &l_succ) != 1 || l_succ < 0 || l_succ >= l_n)
+                return false;
+            l_edge.push_back(k); l_edge.push_back(l_succ);
+        }
+    }
+    if ((int)l_edge.size() != 2 * l_e)
+        return false;
+    flat_link(l_edge);
+    return true;
+}
+
 #endif /* POCHOIR_WALK_RECURSIVE_HPP */